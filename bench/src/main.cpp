@@ -0,0 +1,445 @@
+#include "scenes.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace Rasterizer;
+
+#if defined(RASTERIZER_SIMD_AVX2)
+static const char* c_simd_name = "AVX2";
+#elif defined(RASTERIZER_SIMD_SSE41)
+static const char* c_simd_name = "SSE4.1";
+#else
+static const char* c_simd_name = "None";
+#endif
+
+struct BenchOptions
+{
+    u32 width {1280};
+    u32 height {720};
+    u32 threads {0};
+    u32 frames {20};
+    u32 warmup_frames {3};
+    const char* scene_filter {nullptr};
+    const char* output_path {"bench_results.json"};
+    const char* baseline_path {nullptr};
+    f64 tolerance {0.10};
+};
+
+struct BenchResult
+{
+    std::string name;
+    std::string description;
+    u64 triangles;
+    // Fragments shaded per frame, 0 when the profiler counters are compiled out.
+    u64 pixels;
+    f64 average_ms;
+    f64 median_ms;
+    f64 min_ms;
+    // System allocations of the pipeline during the timed frames; 0 in the steady state.
+    u64 steady_state_allocations;
+    size_t arena_capacity;
+};
+
+static u64 FindCounter(const char* name)
+{
+    for (const ProfileCounterStats& counter : Profiler::GetCounterStats())
+    {
+        if (counter.name == name)
+        {
+            return counter.last;
+        }
+    }
+    return 0;
+}
+
+struct RecordContext
+{
+    const BenchScene* scene;
+    Pipeline* pipeline;
+    UniformBlock uniforms;
+    std::vector<CommandBuffer>* buffers;
+};
+
+// Records an equal share of the scene's draws into command buffer index.
+static void RecordCommandsJob(void* data, u32 index, u32)
+{
+    const RecordContext& context = *static_cast<const RecordContext*>(data);
+    const std::vector<Mesh>& meshes = context.scene->meshes;
+    const size_t count = context.buffers->size();
+    CommandBuffer& buffer = (*context.buffers)[index];
+    buffer.BindPipeline(*context.pipeline);
+    buffer.BindUniforms(context.uniforms);
+    for (size_t i = meshes.size() * index / count; i < meshes.size() * (index + 1) / count; ++i)
+    {
+        buffer.Draw(meshes[i]);
+    }
+}
+
+static bool RunScene(const BenchScene& scene, const BenchOptions& options,
+    const JobSystemPtr& jobs, RenderTarget& target, DepthTarget& depth,
+    MultisampleTarget& multisample_target, DepthTarget& multisample_depth, BenchResult& result)
+{
+    Pipeline pipeline(jobs);
+    result = {scene.name, scene.description, 0, 0, 0.0, 0.0, 0.0, 0, 0};
+    DepthTarget& scene_depth = scene.multisample ? multisample_depth : depth;
+    DepthTarget* depth_target = scene.use_depth ? &scene_depth : nullptr;
+    // Deferred scenes draw into the G-buffer and light it into the target.
+    const bool deferred = !scene.lights.empty();
+    UniquePtr<GBuffer> gbuffer = deferred ?
+        MakeUnique<GBuffer>(target.GetWidth(), target.GetHeight(), 2) : nullptr;
+    DeferredLighting lighting(jobs);
+    // The scenes are authored in clip space, so the projection is the identity.
+    LightingDesc lighting_desc;
+    lighting_desc.ambient = {0.05f, 0.05f, 0.05f};
+    bool configured = false;
+    if (deferred)
+    {
+        configured = pipeline.Configure(scene.vs, scene.fs, *gbuffer, depth_target, scene.state,
+            scene.inline_shader);
+    }
+    else if (scene.multisample)
+    {
+        configured = pipeline.Configure(scene.vs, scene.fs, std::vector<MultisampleTarget*> {
+            &multisample_target}, depth_target, scene.state, scene.inline_shader);
+    }
+    else
+    {
+        configured = pipeline.Configure(scene.vs, scene.fs, {&target}, depth_target,
+            scene.state, scene.inline_shader);
+    }
+    if (!configured)
+    {
+        return false;
+    }
+    const IncrementalDesc incremental;
+    if (scene.incremental)
+    {
+        pipeline.SetIncremental(&incremental);
+    }
+
+    UniformBuffer uniforms(sizeof(Mat4) + scene.extra_uniforms.size());
+    uniforms.Set(pipeline.GetUniformLayout().Find("MVP"), Mat4::Identity());
+    std::copy(scene.extra_uniforms.begin(), scene.extra_uniforms.end(),
+        static_cast<u8*>(uniforms.GetData()) + sizeof(Mat4));
+    for (const Mesh& mesh : scene.meshes)
+    {
+        result.triangles += mesh.GetTriangleCount();
+    }
+    // The last mesh of an incremental scene, translated every other frame.
+    UniformBuffer moving_uniforms = uniforms;
+    u32 frame_index = 0;
+
+    std::vector<CommandBuffer> command_buffers(scene.command_buffers);
+    std::vector<const CommandBuffer*> submission;
+    for (const CommandBuffer& buffer : command_buffers)
+    {
+        submission.push_back(&buffer);
+    }
+
+    auto render_frame = [&]()
+    {
+        // Incremental pipelines clear the tiles they redraw themselves.
+        if (!scene.incremental)
+        {
+            if (scene.multisample)
+            {
+                multisample_target.Clear(0xFF000000);
+            }
+            else if (!deferred)
+            {
+                target.Clear(0xFF000000);
+            }
+            if (scene.use_depth)
+            {
+                scene_depth.Clear();
+            }
+        }
+        // One block shared by every draw of the frame.
+        const UniformBlock block = pipeline.UploadUniforms(uniforms);
+        if (scene.incremental)
+        {
+            moving_uniforms.Set(pipeline.GetUniformLayout().Find("MVP"),
+                Mat4::Translation({frame_index++ % 2 ? 0.25f : 0.0f, 0.0f, 0.0f}));
+            const UniformBlock moving_block = pipeline.UploadUniforms(moving_uniforms);
+            for (size_t i = 0; i < scene.meshes.size(); ++i)
+            {
+                pipeline.DrawMesh(scene.meshes[i],
+                    i + 1 < scene.meshes.size() ? block : moving_block);
+            }
+        }
+        else if (command_buffers.empty())
+        {
+            for (const Mesh& mesh : scene.meshes)
+            {
+                pipeline.DrawMesh(mesh, block);
+            }
+        }
+        else
+        {
+            RecordContext context = {&scene, &pipeline, block, &command_buffers};
+            JobCounter recorded(static_cast<u32>(command_buffers.size()));
+            for (u32 i = 0; i < command_buffers.size(); ++i)
+            {
+                jobs->Run({&RecordCommandsJob, &context, i, "record commands", &recorded});
+            }
+            jobs->Wait(recorded);
+            SubmitCommandBuffers(submission);
+        }
+        if (deferred)
+        {
+            lighting.Shade(*gbuffer, scene_depth, lighting_desc, scene.lights, target,
+                &pipeline.GetCompletion());
+        }
+        pipeline.Flush();
+        lighting.Flush();
+        for (CommandBuffer& buffer : command_buffers)
+        {
+            buffer.Reset();
+        }
+    };
+
+    // The workload is deterministic, so one profiled frame gives the pixel count of all of
+    // them; the timed frames run with the profiler off to keep its overhead out. The first
+    // incremental frame draws everything, so profile the second.
+    if (scene.incremental)
+    {
+        render_frame();
+    }
+    Profiler::SetEnabled(true);
+    render_frame();
+    Profiler::SetEnabled(false);
+    Profiler::EndFrame();
+    result.pixels = FindCounter("fragments shaded");
+
+    for (u32 frame = 1; frame < options.warmup_frames; ++frame)
+    {
+        render_frame();
+    }
+
+    std::vector<f64> times;
+    times.reserve(options.frames);
+    const u64 allocations = pipeline.GetMemoryStats().system_allocations;
+    for (u32 frame = 0; frame < options.frames; ++frame)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        render_frame();
+        const auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<f64, std::milli>(end - begin).count());
+    }
+
+    const PipelineMemoryStats memory = pipeline.GetMemoryStats();
+    result.steady_state_allocations = memory.system_allocations - allocations;
+    result.arena_capacity = memory.arena_capacity;
+
+    std::sort(times.begin(), times.end());
+    for (f64 ms : times)
+    {
+        result.average_ms += ms;
+    }
+    result.average_ms /= static_cast<f64>(times.size());
+    result.median_ms = times[times.size() / 2];
+    result.min_ms = times.front();
+    return true;
+}
+
+// Millions of items per second at the median frame time.
+static f64 MillionsPerSecond(u64 count, f64 ms)
+{
+    return ms > 0.0 ? static_cast<f64>(count) / (ms * 1e3) : 0.0;
+}
+
+static bool WriteResults(const std::string& path, const BenchOptions& options, u32 threads,
+    const std::vector<BenchResult>& results)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        LOG_ERROR("Could not open '%s' for writing", path.c_str());
+        return false;
+    }
+
+    file << "{\n  \"simd\": \"" << c_simd_name << "\",\n  \"fs_packet_width\": "
+        << SHADER_SIMD_WIDTH << ",\n  \"threads\": " << threads << ",\n  \"width\": "
+        << options.width << ",\n  \"height\": " << options.height << ",\n  \"frames\": "
+        << options.frames << ",\n  \"scenes\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& result = results[i];
+        file << "    {\"name\": \"" << result.name << "\", \"description\": \""
+            << result.description << "\", \"triangles\": " << result.triangles
+            << ", \"pixels\": " << result.pixels
+            << ", \"ms_per_frame\": " << result.median_ms
+            << ", \"average_ms\": " << result.average_ms
+            << ", \"min_ms\": " << result.min_ms
+            << ", \"steady_state_allocations\": " << result.steady_state_allocations
+            << ", \"arena_bytes\": " << result.arena_capacity
+            << ", \"mtri_per_s\": " << MillionsPerSecond(result.triangles, result.median_ms)
+            << ", \"mpix_per_s\": ";
+        if (result.pixels)
+        {
+            file << MillionsPerSecond(result.pixels, result.median_ms);
+        }
+        else
+        {
+            file << "null";
+        }
+        file << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+/*
+ * Reads "ms_per_frame" of a scene from a results file written by WriteResults(). This is not
+ * a JSON parser; it relies on every scene object keeping its name before its timings.
+ */
+static bool FindBaselineTime(const std::string& json, const std::string& scene, f64& ms)
+{
+    const size_t name = json.find("\"name\": \"" + scene + "\"");
+    if (name == std::string::npos)
+    {
+        return false;
+    }
+    const char* c_key = "\"ms_per_frame\": ";
+    const size_t key = json.find(c_key, name);
+    const size_t object_end = json.find('}', name);
+    if (key == std::string::npos || key > object_end)
+    {
+        return false;
+    }
+    ms = std::strtod(json.c_str() + key + std::strlen(c_key), nullptr);
+    return ms > 0.0;
+}
+
+// Returns false if any scene got slower than the baseline by more than the tolerance.
+static bool CompareBaseline(const BenchOptions& options, const std::vector<BenchResult>& results)
+{
+    std::ifstream file(options.baseline_path);
+    if (!file)
+    {
+        LOG_ERROR("Could not open baseline '%s'", options.baseline_path);
+        return false;
+    }
+    std::stringstream json;
+    json << file.rdbuf();
+
+    bool passed = true;
+    for (const BenchResult& result : results)
+    {
+        f64 baseline_ms = 0.0;
+        if (!FindBaselineTime(json.str(), result.name, baseline_ms))
+        {
+            LOG_WARNING("%-24s not in the baseline", result.name.c_str());
+            continue;
+        }
+        const f64 change = result.median_ms / baseline_ms - 1.0;
+        if (change > options.tolerance)
+        {
+            LOG_ERROR("%-24s regressed %+.1f%% (%.3f ms, baseline %.3f ms)",
+                result.name.c_str(), change * 100.0, result.median_ms, baseline_ms);
+            passed = false;
+        }
+        else
+        {
+            LOG_INFO("%-24s %+.1f%% against the baseline", result.name.c_str(), change * 100.0);
+        }
+    }
+    return passed;
+}
+
+// Usage: rasterizer_bench [--threads <n, 0 = cores>] [--frames <n>] [--size <w> <h>]
+//                         [--scene <name>] [--output <results.json>]
+//                         [--baseline <results.json> [--tolerance <fraction, e.g. 0.1>]]
+// Exits with 1 when a scene regressed against the baseline.
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        auto next_u32 = [&]() { return static_cast<u32>(std::strtoul(argv[++i], nullptr, 10)); };
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            options.threads = next_u32();
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            options.frames = std::max(next_u32(), 1u);
+        }
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 2 < argc)
+        {
+            options.width = std::max(next_u32(), 1u);
+            options.height = std::max(next_u32(), 1u);
+        }
+        else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+        {
+            options.scene_filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            options.output_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            options.baseline_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+        {
+            options.tolerance = std::strtod(argv[++i], nullptr);
+        }
+        else
+        {
+            LOG_ERROR("Unknown argument '%s'", argv[i]);
+            return 2;
+        }
+    }
+
+#ifndef RASTERIZER_PROFILING
+    LOG_WARNING("Built without RASTERIZER_PROFILING, pixel rates are not reported");
+#endif
+
+    JobSystemPtr jobs = JobSystem::Create(options.threads);
+    RenderTarget target(options.width, options.height);
+    DepthTarget depth(options.width, options.height);
+    MultisampleTarget multisample_target(target);
+    DepthTarget multisample_depth(options.width, options.height, c_msaa_samples);
+
+    std::vector<BenchResult> results;
+    for (const BenchScene& scene : CreateBenchScenes())
+    {
+        if (options.scene_filter && scene.name != options.scene_filter)
+        {
+            continue;
+        }
+        BenchResult result;
+        if (!RunScene(scene, options, jobs, target, depth, multisample_target,
+            multisample_depth, result))
+        {
+            LOG_ERROR("Scene '%s' could not be configured", scene.name.c_str());
+            return 2;
+        }
+        if (result.steady_state_allocations)
+        {
+            LOG_WARNING("%-24s allocated %llu times after warming up", result.name.c_str(),
+                static_cast<unsigned long long>(result.steady_state_allocations));
+        }
+        results.push_back(result);
+        LOG_INFO("%-24s %8.3f ms/frame  %9.2f Mtri/s  %9.2f Mpix/s", result.name.c_str(),
+            result.median_ms, MillionsPerSecond(result.triangles, result.median_ms),
+            MillionsPerSecond(result.pixels, result.median_ms));
+    }
+
+    if (!WriteResults(options.output_path, options, jobs->GetWorkerCount(), results))
+    {
+        return 2;
+    }
+    if (options.baseline_path && !CompareBaseline(options, results))
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,803 @@
+#include "scenes.hpp"
+#include "shader_module.hpp"
+#include "basic_shader.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+namespace Rasterizer
+{
+
+    namespace
+    {
+
+        // Layers of the fill rate and overdraw scenes.
+        constexpr u32 c_fill_layers = 8;
+        // Cells of the small triangle grid, two triangles each: one million triangles.
+        constexpr u32 c_grid_columns = 1000;
+        constexpr u32 c_grid_rows = 500;
+        // Cells per side of the screen edge grids, which reach c_edge_grid_extent times past
+        // the target so about 15% of the visible triangles cross a screen edge.
+        constexpr u32 c_edge_grid_cells = 64;
+        constexpr f32 c_edge_grid_extent = 1.5f;
+        // Cells per side of the many draws grid, one draw each, recorded into
+        // c_draw_command_buffers command buffers in parallel.
+        constexpr u32 c_draw_grid_cells = 32;
+        constexpr u32 c_draw_command_buffers = 8;
+        // Texels per side of the textured triangle's texture; a power of two for wrapping.
+        constexpr u32 c_texture_size = 256;
+        // Texture repeats across the textured triangle's [0, 1] UV range.
+        constexpr f32 c_texture_repeat = 16.0f;
+        // Wave grids of the deferred scene, drawn back to front, and its lights per side of
+        // a grid in front of them: 256 lights.
+        constexpr u32 c_deferred_layers = 4;
+        constexpr u32 c_deferred_grid_columns = 128;
+        constexpr u32 c_deferred_grid_rows = 72;
+        constexpr u32 c_deferred_light_grid = 16;
+        constexpr f32 c_deferred_light_radius = 0.25f;
+
+        struct ColorVertex
+        {
+            Vec3 position;
+            Vec3 color;
+        };
+
+        struct TexturedVertex
+        {
+            Vec3 position;
+            Vec2 uv;
+        };
+
+        struct LitVertex
+        {
+            Vec3 position;
+            Vec3 normal;
+            Vec3 color;
+        };
+
+        template <typename Vertex>
+        Mesh CreateMesh(const std::vector<Vertex>& vertices, std::vector<u32> indices,
+            std::vector<VertexAttribute> attributes)
+        {
+            Mesh mesh;
+            mesh.vertices.layout.stride = sizeof(Vertex);
+            mesh.vertices.layout.attributes = std::move(attributes);
+            mesh.vertices.vertex_count = vertices.size();
+            mesh.vertices.data.resize(vertices.size() * sizeof(Vertex));
+            std::memcpy(mesh.vertices.data.data(), vertices.data(), mesh.vertices.data.size());
+            mesh.indices.indices = std::move(indices);
+            return mesh;
+        }
+
+        Mesh CreateColorMesh(const std::vector<ColorVertex>& vertices, std::vector<u32> indices)
+        {
+            return CreateMesh(vertices, std::move(indices), {
+                {"POSITION", Format::Vec3, offsetof(ColorVertex, position)},
+                {"COLOR", Format::Vec3, offsetof(ColorVertex, color)},
+            });
+        }
+
+        // Counter-clockwise quad over [x0, x1] x [y0, y1] at clip depth z.
+        Mesh CreateQuad(f32 x0, f32 y0, f32 x1, f32 y1, f32 z, const Vec3& color)
+        {
+            return CreateColorMesh({
+                {{x0, y0, z}, color},
+                {{x1, y0, z}, color},
+                {{x1, y1, z}, color},
+                {{x0, y1, z}, color},
+            }, {0, 1, 2, 0, 2, 3});
+        }
+
+        Mesh CreateFullscreenQuad(f32 z, const Vec3& color)
+        {
+            return CreateQuad(-1.0f, -1.0f, 1.0f, 1.0f, z, color);
+        }
+
+        // c_draw_grid_cells^2 quads tiling the target, one mesh each.
+        std::vector<Mesh> CreateQuadGrid()
+        {
+            std::vector<Mesh> meshes;
+            const f32 size = 2.0f / static_cast<f32>(c_draw_grid_cells);
+            for (u32 y = 0; y < c_draw_grid_cells; ++y)
+            {
+                for (u32 x = 0; x < c_draw_grid_cells; ++x)
+                {
+                    const f32 x0 = -1.0f + static_cast<f32>(x) * size;
+                    const f32 y0 = -1.0f + static_cast<f32>(y) * size;
+                    const Vec3 color = {static_cast<f32>(x) / c_draw_grid_cells,
+                        static_cast<f32>(y) / c_draw_grid_cells, 0.5f};
+                    meshes.push_back(CreateQuad(x0, y0, x0 + size, y0 + size, 0.5f, color));
+                }
+            }
+            return meshes;
+        }
+
+        Vec3 LayerColor(u32 layer)
+        {
+            const f32 t = static_cast<f32>(layer) / static_cast<f32>(c_fill_layers - 1);
+            return {t, 0.5f, 1.0f - t};
+        }
+
+        // Layered fullscreen quads from z = 0.9 towards z = 0.1, or the reverse order.
+        std::vector<Mesh> CreateLayerStack(bool front_to_back)
+        {
+            std::vector<Mesh> meshes;
+            for (u32 layer = 0; layer < c_fill_layers; ++layer)
+            {
+                const u32 depth_index = front_to_back ? c_fill_layers - 1 - layer : layer;
+                const f32 z = 0.9f - 0.8f * static_cast<f32>(depth_index) /
+                    static_cast<f32>(c_fill_layers - 1);
+                meshes.push_back(CreateFullscreenQuad(z, LayerColor(layer)));
+            }
+            return meshes;
+        }
+
+        // Indexed grid of columns x rows cells over [-extent, extent]^2 at clip depth z.
+        Mesh CreateTriangleGrid(u32 columns = c_grid_columns, u32 rows = c_grid_rows,
+            f32 extent = 1.0f, f32 z = 0.5f)
+        {
+            std::vector<ColorVertex> vertices;
+            vertices.reserve((columns + 1) * (rows + 1));
+            for (u32 y = 0; y <= rows; ++y)
+            {
+                for (u32 x = 0; x <= columns; ++x)
+                {
+                    const f32 u = static_cast<f32>(x) / static_cast<f32>(columns);
+                    const f32 v = static_cast<f32>(y) / static_cast<f32>(rows);
+                    vertices.push_back({{(u * 2.0f - 1.0f) * extent, (v * 2.0f - 1.0f) * extent,
+                        z}, {u, v, 0.5f}});
+                }
+            }
+
+            std::vector<u32> indices;
+            indices.reserve(columns * rows * 6);
+            for (u32 y = 0; y < rows; ++y)
+            {
+                for (u32 x = 0; x < columns; ++x)
+                {
+                    const u32 i0 = y * (columns + 1) + x;
+                    const u32 i1 = i0 + 1;
+                    const u32 i2 = i0 + columns + 2;
+                    const u32 i3 = i0 + columns + 1;
+                    indices.insert(indices.end(), {i0, i1, i2, i0, i2, i3});
+                }
+            }
+            return CreateColorMesh(vertices, std::move(indices));
+        }
+
+        // Indexed fullscreen grid at clip depth z_center, displaced in depth by a wave of the
+        // given amplitude, with normals facing the eye (towards smaller depths).
+        Mesh CreateWaveGrid(f32 z_center, f32 amplitude, f32 phase, const Vec3& color)
+        {
+            constexpr u32 columns = c_deferred_grid_columns;
+            constexpr u32 rows = c_deferred_grid_rows;
+            constexpr f32 frequency = 3.0f * c_pi;
+            std::vector<LitVertex> vertices;
+            vertices.reserve((columns + 1) * (rows + 1));
+            for (u32 y = 0; y <= rows; ++y)
+            {
+                for (u32 x = 0; x <= columns; ++x)
+                {
+                    const f32 u = static_cast<f32>(x) / static_cast<f32>(columns) * 2.0f - 1.0f;
+                    const f32 v = static_cast<f32>(y) / static_cast<f32>(rows) * 2.0f - 1.0f;
+                    const f32 wave_u = frequency * u + phase;
+                    const f32 wave_v = frequency * v;
+                    const f32 z = z_center + amplitude * std::sin(wave_u) * std::sin(wave_v);
+                    const Vec3 slope = {
+                        amplitude * frequency * std::cos(wave_u) * std::sin(wave_v),
+                        amplitude * frequency * std::sin(wave_u) * std::cos(wave_v), -1.0f};
+                    vertices.push_back({{u, v, z}, Normalize(slope), color});
+                }
+            }
+
+            std::vector<u32> indices;
+            indices.reserve(columns * rows * 6);
+            for (u32 y = 0; y < rows; ++y)
+            {
+                for (u32 x = 0; x < columns; ++x)
+                {
+                    const u32 i0 = y * (columns + 1) + x;
+                    const u32 i1 = i0 + 1;
+                    const u32 i2 = i0 + columns + 2;
+                    const u32 i3 = i0 + columns + 1;
+                    indices.insert(indices.end(), {i0, i1, i2, i0, i2, i3});
+                }
+            }
+            return CreateMesh(vertices, std::move(indices), {
+                {"POSITION", Format::Vec3, offsetof(LitVertex, position)},
+                {"NORMAL", Format::Vec3, offsetof(LitVertex, normal)},
+                {"COLOR", Format::Vec3, offsetof(LitVertex, color)},
+            });
+        }
+
+        // A grid of colored lights just in front of the wave grids.
+        std::vector<PointLight> CreateLightGrid()
+        {
+            std::vector<PointLight> lights;
+            const f32 spacing = 2.0f / static_cast<f32>(c_deferred_light_grid);
+            for (u32 y = 0; y < c_deferred_light_grid; ++y)
+            {
+                for (u32 x = 0; x < c_deferred_light_grid; ++x)
+                {
+                    const f32 hue = static_cast<f32>((x * 7 + y * 3) % 12) / 12.0f;
+                    const Vec3 color = {std::abs(hue * 6.0f - 3.0f) - 1.0f,
+                        2.0f - std::abs(hue * 6.0f - 2.0f), 2.0f - std::abs(hue * 6.0f - 4.0f)};
+                    lights.push_back({{-1.0f + (static_cast<f32>(x) + 0.5f) * spacing,
+                        -1.0f + (static_cast<f32>(y) + 0.5f) * spacing, 0.45f},
+                        c_deferred_light_radius, {std::clamp(color.x, 0.0f, 1.0f),
+                        std::clamp(color.y, 0.0f, 1.0f), std::clamp(color.z, 0.0f, 1.0f)}});
+                }
+            }
+            return lights;
+        }
+
+        // One triangle whose interior covers the whole target.
+        Mesh CreateLargeTriangle()
+        {
+            return CreateMesh(std::vector<TexturedVertex> {
+                {{-1.0f, -1.0f, 0.5f}, {0.0f, 0.0f}},
+                {{3.0f, -1.0f, 0.5f}, {2.0f, 0.0f}},
+                {{-1.0f, 3.0f, 0.5f}, {0.0f, 2.0f}},
+            }, {}, {
+                {"POSITION", Format::Vec3, offsetof(TexturedVertex, position)},
+                {"TEXCOORD", Format::Vec2, offsetof(TexturedVertex, uv)},
+            });
+        }
+
+        /*
+         * Textured shader pair of the large triangle scene. The texture is a BGRA8 array
+         * sampled with nearest filtering and wrapping, enough to put a dependent memory fetch
+         * per pixel into the measurement.
+         */
+        namespace Textured
+        {
+
+            struct Uniforms
+            {
+                Mat4 mvp;
+            };
+
+            struct VertexInput
+            {
+                Vec3 position;
+                Vec2 uv;
+            };
+
+            struct VertexOutput
+            {
+                Vec4 position;
+                Vec2 uv;
+            };
+
+            struct FragmentInput
+            {
+                Vec2 uv;
+            };
+
+            struct FragmentOutput
+            {
+                Vec4 color;
+            };
+
+            u32 s_texture[c_texture_size * c_texture_size];
+
+            const ShaderParam s_uniforms[] = {
+                {"MVP", Format::Mat4, offsetof(Uniforms, mvp)},
+            };
+
+            const ShaderParam s_vs_inputs[] = {
+                {"POSITION", Format::Vec3, offsetof(VertexInput, position)},
+                {"TEXCOORD", Format::Vec2, offsetof(VertexInput, uv)},
+            };
+
+            const ShaderParam s_vs_outputs[] = {
+                {"posClip", Format::Vec4, offsetof(VertexOutput, position)},
+                {"uv", Format::Vec2, offsetof(VertexOutput, uv)},
+            };
+
+            const ShaderParam s_fs_inputs[] = {
+                {"uv", Format::Vec2, offsetof(FragmentInput, uv)},
+            };
+
+            const ShaderParam s_fs_outputs[] = {
+                {"outColor0", Format::Vec4, offsetof(FragmentOutput, color)},
+            };
+
+            const ShaderReflection s_vs_reflection = {
+                s_vs_inputs, 2, sizeof(VertexInput),
+                s_vs_outputs, 2, sizeof(VertexOutput),
+                s_uniforms, 1, sizeof(Uniforms),
+            };
+
+            const ShaderReflection s_fs_reflection = {
+                s_fs_inputs, 1, sizeof(FragmentInput),
+                s_fs_outputs, 1, sizeof(FragmentOutput),
+                nullptr, 0, 0,
+            };
+
+            void FillTexture()
+            {
+                for (u32 y = 0; y < c_texture_size; ++y)
+                {
+                    for (u32 x = 0; x < c_texture_size; ++x)
+                    {
+                        const u32 checker = ((x >> 5) ^ (y >> 5)) & 1 ? 0xFF : 0x40;
+                        s_texture[y * c_texture_size + x] =
+                            0xFF000000 | (checker << 16) | ((x ^ y) & 0xFF) << 8 | checker;
+                    }
+                }
+            }
+
+            inline void Sample(f32 u, f32 v, f32* rgba, u32 stride)
+            {
+                const f32 scale = c_texture_size * c_texture_repeat;
+                const u32 x = static_cast<u32>(static_cast<i32>(u * scale)) & (c_texture_size - 1);
+                const u32 y = static_cast<u32>(static_cast<i32>(v * scale)) & (c_texture_size - 1);
+                const u32 texel = s_texture[y * c_texture_size + x];
+                rgba[0] = static_cast<f32>((texel >> 16) & 0xFF) * (1.0f / 255.0f);
+                rgba[stride] = static_cast<f32>((texel >> 8) & 0xFF) * (1.0f / 255.0f);
+                rgba[2 * stride] = static_cast<f32>(texel & 0xFF) * (1.0f / 255.0f);
+                rgba[3 * stride] = 1.0f;
+            }
+
+            void VS_Main(const void* vertex_input, void* vertex_output, const void* uniforms)
+            {
+                const VertexInput& in = *static_cast<const VertexInput*>(vertex_input);
+                const Uniforms& u = *static_cast<const Uniforms*>(uniforms);
+                VertexOutput& out = *static_cast<VertexOutput*>(vertex_output);
+
+                out.position = u.mvp * Vec4 {in.position.x, in.position.y, in.position.z, 1.0f};
+                out.uv = in.uv;
+            }
+
+            void FS_Main(const void* fragment_input, void* fragment_output, const void*)
+            {
+                const FragmentInput& in = *static_cast<const FragmentInput*>(fragment_input);
+                FragmentOutput& out = *static_cast<FragmentOutput*>(fragment_output);
+
+                Sample(in.uv.x, in.uv.y, &out.color.x, 1);
+            }
+
+            void FS_MainPacket(const f32* fragment_inputs, f32* fragment_outputs, u32,
+                const void*)
+            {
+                constexpr u32 lanes = SHADER_SIMD_WIDTH;
+                const f32* uv = fragment_inputs + offsetof(FragmentInput, uv) / sizeof(f32) * lanes;
+                f32* out = fragment_outputs + offsetof(FragmentOutput, color) / sizeof(f32) * lanes;
+
+                for (u32 lane = 0; lane < lanes; ++lane)
+                {
+                    Sample(uv[lane], uv[lanes + lane], out + lane, lanes);
+                }
+            }
+
+            const VertexShaderAPI s_vertex_api = {VS_Main, &s_vs_reflection, nullptr};
+            const FragmentShaderAPI s_fragment_api = {FS_Main, &s_fs_reflection, FS_MainPacket,
+                SHADER_SIMD_WIDTH};
+
+        } // namespace Textured
+
+        /*
+         * Fragment shader of the large triangle sampling a Texture copy of the Textured scene's
+         * texture through the engine's sampler: bilinear, with mips picked per quad.
+         */
+        namespace Sampled
+        {
+
+            struct Uniforms
+            {
+                Mat4 mvp;
+                TextureBinding texture;
+            };
+
+            UniquePtr<Texture> s_texture;
+
+            const ShaderParam s_uniforms[] = {
+                {"MVP", Format::Mat4, offsetof(Uniforms, mvp)},
+                {"Texture", Format::Texture, offsetof(Uniforms, texture)},
+            };
+
+            const ShaderReflection s_fs_reflection = {
+                Textured::s_fs_inputs, 1, sizeof(Textured::FragmentInput),
+                Textured::s_fs_outputs, 1, sizeof(Textured::FragmentOutput),
+                s_uniforms, 2, sizeof(Uniforms),
+            };
+
+            void CreateTexture()
+            {
+                s_texture = MakeUnique<Texture>(c_texture_size, c_texture_size,
+                    Textured::s_texture);
+            }
+
+            std::vector<u8> GetExtraUniforms()
+            {
+                const TextureBinding binding = s_texture->GetBinding();
+                std::vector<u8> bytes(sizeof(binding));
+                std::memcpy(bytes.data(), &binding, sizeof(binding));
+                return bytes;
+            }
+
+            void FS_Main(const void* fragment_input, void* fragment_output, const void* uniforms)
+            {
+                const auto& in = *static_cast<const Textured::FragmentInput*>(fragment_input);
+                auto& out = *static_cast<Textured::FragmentOutput*>(fragment_output);
+                const TextureBinding& texture = static_cast<const Uniforms*>(uniforms)->texture;
+
+                texture.api->Sample(texture.texture, in.uv.x * c_texture_repeat,
+                    in.uv.y * c_texture_repeat, 0.0f, &out.color.x);
+            }
+
+            void FS_MainPacket(const f32* fragment_inputs, f32* fragment_outputs, u32,
+                const void* uniforms)
+            {
+                constexpr u32 lanes = SHADER_SIMD_WIDTH;
+                const f32* uv = fragment_inputs +
+                    offsetof(Textured::FragmentInput, uv) / sizeof(f32) * lanes;
+                f32* out = fragment_outputs +
+                    offsetof(Textured::FragmentOutput, color) / sizeof(f32) * lanes;
+                const TextureBinding& texture = static_cast<const Uniforms*>(uniforms)->texture;
+
+                f32 uvs[2 * lanes];
+                for (u32 i = 0; i < 2 * lanes; ++i)
+                {
+                    uvs[i] = uv[i] * c_texture_repeat;
+                }
+                texture.api->SamplePacket(texture.texture, uvs, lanes, out);
+            }
+
+            const FragmentShaderAPI s_fragment_api = {FS_Main, &s_fs_reflection, FS_MainPacket,
+                SHADER_SIMD_WIDTH};
+
+        } // namespace Sampled
+
+        /*
+         * Shader pair with 16 varying floats on color meshes, for the interpolation cost of
+         * shaders with many varyings.
+         */
+        namespace Varyings
+        {
+
+            constexpr u32 c_vectors = 4;
+
+            struct Uniforms
+            {
+                Mat4 mvp;
+            };
+
+            struct VertexInput
+            {
+                Vec3 position;
+                Vec3 color;
+            };
+
+            struct VertexOutput
+            {
+                Vec4 position;
+                Vec4 values[c_vectors];
+            };
+
+            struct FragmentInput
+            {
+                Vec4 values[c_vectors];
+            };
+
+            struct FragmentOutput
+            {
+                Vec4 color;
+            };
+
+            const ShaderParam s_uniforms[] = {
+                {"MVP", Format::Mat4, offsetof(Uniforms, mvp)},
+            };
+
+            const ShaderParam s_vs_inputs[] = {
+                {"POSITION", Format::Vec3, offsetof(VertexInput, position)},
+                {"COLOR", Format::Vec3, offsetof(VertexInput, color)},
+            };
+
+            const ShaderParam s_vs_outputs[] = {
+                {"posClip", Format::Vec4, offsetof(VertexOutput, position)},
+                {"value0", Format::Vec4, offsetof(VertexOutput, values[0])},
+                {"value1", Format::Vec4, offsetof(VertexOutput, values[1])},
+                {"value2", Format::Vec4, offsetof(VertexOutput, values[2])},
+                {"value3", Format::Vec4, offsetof(VertexOutput, values[3])},
+            };
+
+            const ShaderParam s_fs_inputs[] = {
+                {"value0", Format::Vec4, offsetof(FragmentInput, values[0])},
+                {"value1", Format::Vec4, offsetof(FragmentInput, values[1])},
+                {"value2", Format::Vec4, offsetof(FragmentInput, values[2])},
+                {"value3", Format::Vec4, offsetof(FragmentInput, values[3])},
+            };
+
+            const ShaderParam s_fs_outputs[] = {
+                {"outColor0", Format::Vec4, offsetof(FragmentOutput, color)},
+            };
+
+            const ShaderReflection s_vs_reflection = {
+                s_vs_inputs, 2, sizeof(VertexInput),
+                s_vs_outputs, 1 + c_vectors, sizeof(VertexOutput),
+                s_uniforms, 1, sizeof(Uniforms),
+            };
+
+            const ShaderReflection s_fs_reflection = {
+                s_fs_inputs, c_vectors, sizeof(FragmentInput),
+                s_fs_outputs, 1, sizeof(FragmentOutput),
+                nullptr, 0, 0,
+            };
+
+            void VS_Main(const void* vertex_input, void* vertex_output, const void* uniforms)
+            {
+                const VertexInput& in = *static_cast<const VertexInput*>(vertex_input);
+                const Uniforms& u = *static_cast<const Uniforms*>(uniforms);
+                VertexOutput& out = *static_cast<VertexOutput*>(vertex_output);
+
+                out.position = u.mvp * Vec4 {in.position.x, in.position.y, in.position.z, 1.0f};
+                for (u32 i = 0; i < c_vectors; ++i)
+                {
+                    const f32 scale = 1.0f / static_cast<f32>(i + 1);
+                    out.values[i] = {in.color.x * scale, in.color.y * scale, in.color.z * scale,
+                        scale};
+                }
+            }
+
+            void FS_Main(const void* fragment_input, void* fragment_output, const void*)
+            {
+                const FragmentInput& in = *static_cast<const FragmentInput*>(fragment_input);
+                FragmentOutput& out = *static_cast<FragmentOutput*>(fragment_output);
+
+                out.color = {0.0f, 0.0f, 0.0f, 1.0f};
+                for (u32 i = 0; i < c_vectors; ++i)
+                {
+                    out.color.x += in.values[i].x * 0.5f;
+                    out.color.y += in.values[i].y * 0.5f;
+                    out.color.z += in.values[i].z * 0.5f;
+                }
+            }
+
+            void FS_MainPacket(const f32* fragment_inputs, f32* fragment_outputs, u32,
+                const void*)
+            {
+                constexpr u32 lanes = SHADER_SIMD_WIDTH;
+                for (u32 c = 0; c < 3; ++c)
+                {
+                    f32* out = fragment_outputs + c * lanes;
+                    for (u32 lane = 0; lane < lanes; ++lane)
+                    {
+                        f32 sum = 0.0f;
+                        for (u32 i = 0; i < c_vectors; ++i)
+                        {
+                            sum += fragment_inputs[(i * 4 + c) * lanes + lane];
+                        }
+                        out[lane] = sum * 0.5f;
+                    }
+                }
+                for (u32 lane = 0; lane < lanes; ++lane)
+                {
+                    fragment_outputs[3 * lanes + lane] = 1.0f;
+                }
+            }
+
+            const VertexShaderAPI s_vertex_api = {VS_Main, &s_vs_reflection, nullptr};
+            const FragmentShaderAPI s_fragment_api = {FS_Main, &s_fs_reflection, FS_MainPacket,
+                SHADER_SIMD_WIDTH};
+
+        } // namespace Varyings
+
+        /*
+         * Geometry pass of the deferred scene: the albedo and the normal, mapped to [0, 1],
+         * into the two G-buffer attachments. The scene is authored in clip space like the
+         * others, so that is its view space too and the normals pass through unchanged.
+         */
+        namespace Deferred
+        {
+
+            struct Uniforms
+            {
+                Mat4 mvp;
+            };
+
+            struct VertexOutput
+            {
+                Vec4 position;
+                Vec4 normal;
+                Vec4 color;
+            };
+
+            struct FragmentInput
+            {
+                Vec4 normal;
+                Vec4 color;
+            };
+
+            struct FragmentOutput
+            {
+                Vec4 albedo;
+                Vec4 normal;
+            };
+
+            const ShaderParam s_uniforms[] = {
+                {"MVP", Format::Mat4, offsetof(Uniforms, mvp)},
+            };
+
+            const ShaderParam s_vs_inputs[] = {
+                {"POSITION", Format::Vec3, offsetof(LitVertex, position)},
+                {"NORMAL", Format::Vec3, offsetof(LitVertex, normal)},
+                {"COLOR", Format::Vec3, offsetof(LitVertex, color)},
+            };
+
+            const ShaderParam s_vs_outputs[] = {
+                {"posClip", Format::Vec4, offsetof(VertexOutput, position)},
+                {"normal", Format::Vec4, offsetof(VertexOutput, normal)},
+                {"color", Format::Vec4, offsetof(VertexOutput, color)},
+            };
+
+            const ShaderParam s_fs_inputs[] = {
+                {"normal", Format::Vec4, offsetof(FragmentInput, normal)},
+                {"color", Format::Vec4, offsetof(FragmentInput, color)},
+            };
+
+            const ShaderParam s_fs_outputs[] = {
+                {"outAlbedo", Format::Vec4, offsetof(FragmentOutput, albedo)},
+                {"outNormal", Format::Vec4, offsetof(FragmentOutput, normal)},
+            };
+
+            const ShaderReflection s_vs_reflection = {
+                s_vs_inputs, 3, sizeof(LitVertex),
+                s_vs_outputs, 3, sizeof(VertexOutput),
+                s_uniforms, 1, sizeof(Uniforms),
+            };
+
+            const ShaderReflection s_fs_reflection = {
+                s_fs_inputs, 2, sizeof(FragmentInput),
+                s_fs_outputs, 2, sizeof(FragmentOutput),
+                nullptr, 0, 0,
+            };
+
+            void VS_Main(const void* vertex_input, void* vertex_output, const void* uniforms)
+            {
+                const LitVertex& in = *static_cast<const LitVertex*>(vertex_input);
+                const Uniforms& u = *static_cast<const Uniforms*>(uniforms);
+                VertexOutput& out = *static_cast<VertexOutput*>(vertex_output);
+
+                out.position = u.mvp * Vec4 {in.position.x, in.position.y, in.position.z, 1.0f};
+                out.normal = {in.normal.x, in.normal.y, in.normal.z, 0.0f};
+                out.color = {in.color.x, in.color.y, in.color.z, 1.0f};
+            }
+
+            void FS_Main(const void* fragment_input, void* fragment_output, const void*)
+            {
+                const FragmentInput& in = *static_cast<const FragmentInput*>(fragment_input);
+                FragmentOutput& out = *static_cast<FragmentOutput*>(fragment_output);
+
+                out.albedo = {in.color.x, in.color.y, in.color.z, 1.0f};
+                out.normal = {in.normal.x * 0.5f + 0.5f, in.normal.y * 0.5f + 0.5f,
+                    in.normal.z * 0.5f + 0.5f, 1.0f};
+            }
+
+            void FS_MainPacket(const f32* fragment_inputs, f32* fragment_outputs, u32,
+                const void*)
+            {
+                constexpr u32 lanes = SHADER_SIMD_WIDTH;
+                for (u32 lane = 0; lane < lanes; ++lane)
+                {
+                    for (u32 c = 0; c < 3; ++c)
+                    {
+                        fragment_outputs[c * lanes + lane] =
+                            fragment_inputs[(4 + c) * lanes + lane];
+                        fragment_outputs[(4 + c) * lanes + lane] =
+                            fragment_inputs[c * lanes + lane] * 0.5f + 0.5f;
+                    }
+                    fragment_outputs[3 * lanes + lane] = 1.0f;
+                    fragment_outputs[7 * lanes + lane] = 1.0f;
+                }
+            }
+
+            const VertexShaderAPI s_vertex_api = {VS_Main, &s_vs_reflection, nullptr};
+            const FragmentShaderAPI s_fragment_api = {FS_Main, &s_fs_reflection, FS_MainPacket,
+                SHADER_SIMD_WIDTH};
+
+        } // namespace Deferred
+
+    } // namespace
+
+    std::vector<BenchScene> CreateBenchScenes()
+    {
+        const VertexShaderAPI& basic_vs = *GetVertexShaderAPI();
+        const FragmentShaderAPI& basic_fs = *GetFragmentShaderAPI();
+        const PipelineState no_depth = {CullMode::None, false, false};
+        const PipelineState depth = {CullMode::None, true, true};
+
+        // The basic shaders through their per-vertex and per-pixel entry points only, so the
+        // difference to fill_rate is the cost of crossing the module boundary per element.
+        VertexShaderAPI scalar_vs = basic_vs;
+        scalar_vs.VS_MainBatch = nullptr;
+        FragmentShaderAPI scalar_fs = basic_fs;
+        scalar_fs.FS_MainPacket = nullptr;
+
+        Textured::FillTexture();
+        Sampled::CreateTexture();
+
+        std::vector<BenchScene> scenes;
+        scenes.push_back({"fill_rate", "fullscreen quads without depth, packet shaders",
+            CreateLayerStack(false), basic_vs, basic_fs, no_depth, false});
+        scenes.push_back({"fill_rate_inline",
+            "fill_rate with the basic fragment shader compiled into the bench and inlined",
+            CreateLayerStack(false), BasicShader::c_vertex_api, BasicShader::c_fragment_api,
+            no_depth, false, &SelectInlineRasterizer<BasicShader::FragmentShader>});
+        scenes.push_back({"small_triangles", "one million triangles of about one pixel",
+            {}, basic_vs, basic_fs, no_depth, false});
+        scenes.back().meshes.push_back(CreateTriangleGrid());
+        scenes.push_back({"small_triangles_soa",
+            "small_triangles with one vertex stream per attribute",
+            {}, basic_vs, basic_fs, no_depth, false});
+        scenes.back().meshes.push_back(CreateTriangleGrid());
+        scenes.back().meshes.back().vertices =
+            DeinterleaveVertices(scenes.back().meshes.back().vertices);
+        scenes.push_back({"overdraw_back_to_front",
+            "fullscreen quads with depth, every layer passes the depth test",
+            CreateLayerStack(false), basic_vs, basic_fs, depth, true});
+        scenes.push_back({"overdraw_front_to_back",
+            "fullscreen quads with depth, every layer after the first is occluded",
+            CreateLayerStack(true), basic_vs, basic_fs, depth, true});
+        scenes.push_back({"screen_edges",
+            "layered grids reaching past the target, scissored at the screen edges",
+            {}, basic_vs, basic_fs, no_depth, false});
+        for (u32 layer = 0; layer < c_fill_layers; ++layer)
+        {
+            scenes.back().meshes.push_back(CreateTriangleGrid(c_edge_grid_cells,
+                c_edge_grid_cells, c_edge_grid_extent, 0.5f));
+        }
+        scenes.push_back({"large_textured_triangle",
+            "one triangle reaching past the target, nearest sampled texture",
+            {}, Textured::s_vertex_api, Textured::s_fragment_api, no_depth, false});
+        scenes.back().meshes.push_back(CreateLargeTriangle());
+        scenes.push_back({"large_mipmapped_triangle",
+            "large_textured_triangle from a tiled texture, bilinear and mipmapped",
+            {}, Textured::s_vertex_api, Sampled::s_fragment_api, no_depth, false});
+        scenes.back().meshes.push_back(CreateLargeTriangle());
+        scenes.back().extra_uniforms = Sampled::GetExtraUniforms();
+        scenes.push_back({"many_varyings",
+            "fill_rate with 16 varying floats interpolated per pixel",
+            CreateLayerStack(false), Varyings::s_vertex_api, Varyings::s_fragment_api,
+            no_depth, false});
+        scenes.push_back({"many_draws",
+            "a thousand small quads, one draw each, recorded into command buffers in parallel",
+            CreateQuadGrid(), basic_vs, basic_fs, no_depth, false});
+        scenes.back().command_buffers = c_draw_command_buffers;
+        scenes.push_back({"shader_call_overhead",
+            "fill_rate through the per-vertex and per-pixel shader entry points",
+            CreateLayerStack(false), scalar_vs, scalar_fs, no_depth, false});
+        scenes.push_back({"msaa_overdraw",
+            "overdraw_back_to_front with 4x multisampling, compressed off the quad diagonals",
+            CreateLayerStack(false), basic_vs, basic_fs, depth, true});
+        scenes.back().multisample = true;
+        scenes.push_back({"msaa_screen_edges",
+            "screen_edges with 4x multisampling, blocks on triangle edges decompressed",
+            {}, basic_vs, basic_fs, no_depth, false});
+        for (u32 layer = 0; layer < c_fill_layers; ++layer)
+        {
+            scenes.back().meshes.push_back(CreateTriangleGrid(c_edge_grid_cells,
+                c_edge_grid_cells, c_edge_grid_extent, 0.5f));
+        }
+        scenes.back().multisample = true;
+        scenes.push_back({"incremental_overdraw",
+            "overdraw_back_to_front with a small quad moving on top, redrawn incrementally",
+            CreateLayerStack(false), basic_vs, basic_fs, depth, true});
+        scenes.back().meshes.push_back(CreateQuad(-0.1f, -0.1f, 0.1f, 0.1f, 0.05f,
+            {1.0f, 1.0f, 1.0f}));
+        scenes.back().incremental = true;
+        scenes.push_back({"deferred_lights",
+            "wave grids with depth into a G-buffer, 256 point lights culled per tile",
+            {}, Deferred::s_vertex_api, Deferred::s_fragment_api, depth, true});
+        for (u32 layer = 0; layer < c_deferred_layers; ++layer)
+        {
+            const f32 t = static_cast<f32>(layer) / static_cast<f32>(c_deferred_layers - 1);
+            scenes.back().meshes.push_back(CreateWaveGrid(0.8f - 0.2f * t, 0.04f,
+                static_cast<f32>(layer), {0.9f - 0.4f * t, 0.8f, 0.5f + 0.4f * t}));
+        }
+        scenes.back().lights = CreateLightGrid();
+        return scenes;
+    }
+
+} // namespace Rasterizer
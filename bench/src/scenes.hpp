@@ -0,0 +1,45 @@
+#pragma once
+#include "rasterizer.hpp"
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief One fixed benchmark workload. Every mesh is drawn once per frame, in order, with
+     * an identity MVP: scene geometry is authored directly in clip space so the results do
+     * not depend on the target's aspect ratio beyond the pixel count.
+     */
+    struct BenchScene
+    {
+        std::string name;
+        std::string description;
+        std::vector<Mesh> meshes;
+        VertexShaderAPI vs;
+        FragmentShaderAPI fs;
+        PipelineState state;
+        bool use_depth;
+        // Set for fragment shaders compiled into the bench, see SelectInlineRasterizer.
+        RasterizerSelector inline_shader {nullptr};
+        // Uniform bytes following the MVP, e.g. a TextureBinding.
+        std::vector<u8> extra_uniforms {};
+        // If set, the draws are split into this many command buffers, recorded on the job
+        // system in parallel and submitted in order, rather than drawn directly.
+        u32 command_buffers {0};
+        // Renders into a 4x MultisampleTarget, and a depth target with as many samples,
+        // resolved into the output target.
+        bool multisample {false};
+        // Renders incrementally, the last mesh moving back and forth every frame, so only the
+        // tiles it leaves and enters are drawn again; the targets are not cleared.
+        bool incremental {false};
+        // If set, the meshes are the geometry pass of deferred shading into a two attachment
+        // GBuffer, albedo and normal, which DeferredLighting lights with these lights.
+        std::vector<PointLight> lights {};
+    };
+
+    /**
+     * @brief Builds the benchmark suite. Deterministic: no timers or random seeds, so every
+     * run and every version renders the same pixels.
+     */
+    std::vector<BenchScene> CreateBenchScenes();
+
+} // namespace Rasterizer
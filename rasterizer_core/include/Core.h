@@ -10,6 +10,9 @@
 #include <cstdint>
 
 #ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <windows.h>
 #endif 
 
@@ -26,13 +29,8 @@ namespace Rasterizer {
     using f32 = float;
     using f64 = double;
 
-    #if defined(_MSC_VER)
+    // _Static_assert is C only; GCC and Clang reject it in C++ code.
     #define STATIC_ASSERT(expr, msg) static_assert(expr, msg)
-    #elif defined(__GNUC__) || defined(__clang__)
-    #define STATIC_ASSERT(expr, msg) _Static_assert(expr, msg)
-    #else
-    #error "Compiler not supported for STATIC_ASSERT"
-    #endif
 
     STATIC_ASSERT(sizeof(u8) == 1, "u8 is not 1 byte");
     STATIC_ASSERT(sizeof(u16) == 2, "u16 is not 2 bytes");
@@ -0,0 +1,23 @@
+#pragma once
+#include "Core.h"
+
+namespace Rasterizer
+{
+
+    enum class LogLevel
+    {
+        Info,
+        Warning,
+        Error,
+    };
+
+    /**
+     * @brief Central logging entry point, printf-style. Safe to call from worker threads.
+     */
+    void Log(LogLevel level, const char* format, ...);
+
+#define LOG_INFO(...) ::Rasterizer::Log(::Rasterizer::LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) ::Rasterizer::Log(::Rasterizer::LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) ::Rasterizer::Log(::Rasterizer::LogLevel::Error, __VA_ARGS__)
+
+} // namespace Rasterizer
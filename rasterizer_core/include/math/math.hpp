@@ -0,0 +1,205 @@
+#pragma once
+#include "Core.h"
+
+#include <cmath>
+
+namespace Rasterizer
+{
+
+    constexpr f32 c_pi = 3.14159265358979323846f;
+
+    struct Vec2
+    {
+        f32 x {0.0f};
+        f32 y {0.0f};
+    };
+
+    struct Vec3
+    {
+        f32 x {0.0f};
+        f32 y {0.0f};
+        f32 z {0.0f};
+
+        Vec3 operator+(const Vec3& other) const { return {x + other.x, y + other.y, z + other.z}; }
+        Vec3 operator-(const Vec3& other) const { return {x - other.x, y - other.y, z - other.z}; }
+        Vec3 operator*(f32 scale) const { return {x * scale, y * scale, z * scale}; }
+    };
+
+    struct Vec4
+    {
+        f32 x {0.0f};
+        f32 y {0.0f};
+        f32 z {0.0f};
+        f32 w {0.0f};
+    };
+
+    inline f32 Dot(const Vec3& a, const Vec3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    inline Vec3 Cross(const Vec3& a, const Vec3& b)
+    {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    inline Vec3 Normalize(const Vec3& v)
+    {
+        const f32 length = std::sqrt(Dot(v, v));
+        return length > 0.0f ? v * (1.0f / length) : v;
+    }
+
+    /**
+     * @brief Row-major 4x4 matrix operating on column vectors (v' = M * v).
+     * Projection matrices map view depth to the [0, w] clip range used by the pipeline.
+     */
+    struct Mat4
+    {
+        f32 m[4][4] {};
+
+        static Mat4 Identity()
+        {
+            Mat4 result;
+            for (int i = 0; i < 4; ++i)
+            {
+                result.m[i][i] = 1.0f;
+            }
+            return result;
+        }
+
+        static Mat4 Translation(const Vec3& t)
+        {
+            Mat4 result = Identity();
+            result.m[0][3] = t.x;
+            result.m[1][3] = t.y;
+            result.m[2][3] = t.z;
+            return result;
+        }
+
+        static Mat4 Scale(const Vec3& s)
+        {
+            Mat4 result;
+            result.m[0][0] = s.x;
+            result.m[1][1] = s.y;
+            result.m[2][2] = s.z;
+            result.m[3][3] = 1.0f;
+            return result;
+        }
+
+        static Mat4 RotationX(f32 radians)
+        {
+            Mat4 result = Identity();
+            const f32 c = std::cos(radians);
+            const f32 s = std::sin(radians);
+            result.m[1][1] = c;
+            result.m[1][2] = -s;
+            result.m[2][1] = s;
+            result.m[2][2] = c;
+            return result;
+        }
+
+        static Mat4 RotationY(f32 radians)
+        {
+            Mat4 result = Identity();
+            const f32 c = std::cos(radians);
+            const f32 s = std::sin(radians);
+            result.m[0][0] = c;
+            result.m[0][2] = s;
+            result.m[2][0] = -s;
+            result.m[2][2] = c;
+            return result;
+        }
+
+        /**
+         * @brief Right-handed perspective projection looking down -Z with depth in [0, 1].
+         */
+        static Mat4 Perspective(f32 fov_y, f32 aspect, f32 near_plane, f32 far_plane)
+        {
+            Mat4 result;
+            const f32 f = 1.0f / std::tan(fov_y * 0.5f);
+            result.m[0][0] = f / aspect;
+            result.m[1][1] = f;
+            result.m[2][2] = far_plane / (near_plane - far_plane);
+            result.m[2][3] = near_plane * far_plane / (near_plane - far_plane);
+            result.m[3][2] = -1.0f;
+            return result;
+        }
+    };
+
+    inline Mat4 operator*(const Mat4& a, const Mat4& b)
+    {
+        Mat4 result;
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                f32 sum = 0.0f;
+                for (int k = 0; k < 4; ++k)
+                {
+                    sum += a.m[row][k] * b.m[k][col];
+                }
+                result.m[row][col] = sum;
+            }
+        }
+        return result;
+    }
+
+    inline Vec4 operator*(const Mat4& a, const Vec4& v)
+    {
+        return {
+            a.m[0][0] * v.x + a.m[0][1] * v.y + a.m[0][2] * v.z + a.m[0][3] * v.w,
+            a.m[1][0] * v.x + a.m[1][1] * v.y + a.m[1][2] * v.z + a.m[1][3] * v.w,
+            a.m[2][0] * v.x + a.m[2][1] * v.y + a.m[2][2] * v.z + a.m[2][3] * v.w,
+            a.m[3][0] * v.x + a.m[3][1] * v.y + a.m[3][2] * v.z + a.m[3][3] * v.w,
+        };
+    }
+
+    /**
+     * @brief The inverse of a, by cofactor expansion over its 2x2 minors; the identity if a
+     * is singular.
+     */
+    inline Mat4 Inverse(const Mat4& a)
+    {
+        const f32(&m)[4][4] = a.m;
+        // Determinants of the 2x2 minors of the top two rows (s) and the bottom two (c).
+        const f32 s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        const f32 s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        const f32 s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        const f32 s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        const f32 s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        const f32 s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+        const f32 c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+        const f32 c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        const f32 c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        const f32 c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        const f32 c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        const f32 c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+        const f32 determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if (determinant == 0.0f)
+        {
+            return Mat4::Identity();
+        }
+        const f32 d = 1.0f / determinant;
+
+        Mat4 result;
+        result.m[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * d;
+        result.m[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * d;
+        result.m[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * d;
+        result.m[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * d;
+        result.m[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * d;
+        result.m[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * d;
+        result.m[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * d;
+        result.m[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * d;
+        result.m[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * d;
+        result.m[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * d;
+        result.m[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * d;
+        result.m[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * d;
+        result.m[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * d;
+        result.m[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * d;
+        result.m[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * d;
+        result.m[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * d;
+        return result;
+    }
+
+} // namespace Rasterizer
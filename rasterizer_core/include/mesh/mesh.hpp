@@ -0,0 +1,147 @@
+#pragma once
+#include "Core.h"
+#include "math/math.hpp"
+#include "shader/shader_api.hpp"
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief One element of a vertex, identified by its semantic name. Element i starts at
+     * offset + i * stride bytes into the vertex data.
+     */
+    struct VertexAttribute
+    {
+        std::string name;
+        Format format {Format::Unknown};
+        size_t offset {0};
+        // Bytes between consecutive elements; 0 means interleaved, i.e. VertexLayout::stride.
+        // FormatSize(format) puts the attribute in its own tightly packed stream.
+        size_t stride {0};
+    };
+
+    struct VertexLayout;
+
+    // Id of the layout's contents, see VertexLayout::GetId(). Thread safe.
+    u32 InternVertexLayout(const VertexLayout& layout);
+
+    /**
+     * @brief Describes the makeup of the vertices in a VertexBuffer.
+     */
+    struct VertexLayout
+    {
+        // Bytes per vertex over all attributes: the size of an interleaved vertex, or the
+        // sum of the stream strides when the attributes live in separate streams.
+        size_t stride {0};
+        std::vector<VertexAttribute> attributes {};
+        // Cached by GetId(); set it back to 0 after changing a layout that was drawn.
+        mutable u32 interned_id {0};
+
+        const VertexAttribute* Find(const std::string& name) const;
+        /**
+         * @brief Nonzero id shared by all layouts with the same stride and attributes. The
+         * first call interns the layout in a process-wide table, later ones return the cached
+         * id, so keying caches by it costs no string comparisons.
+         */
+        u32 GetId() const
+        {
+            if (interned_id == 0)
+            {
+                interned_id = InternVertexLayout(*this);
+            }
+            return interned_id;
+        }
+        size_t GetStride(const VertexAttribute& attribute) const
+        {
+            return attribute.stride ? attribute.stride : stride;
+        }
+        // True if every attribute is part of one vertex of stride bytes.
+        bool IsInterleaved() const;
+    };
+
+    /**
+     * @brief Vertex data of vertex_count * layout.stride bytes, either owned in data or
+     * referenced through external_data, e.g. straight inside a memory-mapped mesh file that
+     * Mesh::storage keeps alive. The attributes may be interleaved, in separate streams
+     * (structure of arrays) or a mix of both.
+     */
+    struct VertexBuffer
+    {
+        VertexLayout layout {};
+        std::vector<u8> data {};
+        const u8* external_data {nullptr};
+        size_t vertex_count {0};
+
+        const u8* GetData() const { return external_data ? external_data : data.data(); }
+        size_t GetSize() const { return vertex_count * layout.stride; }
+        // Only meaningful for interleaved layouts.
+        const u8* GetVertex(size_t index) const { return GetData() + index * layout.stride; }
+        const u8* GetAttribute(const VertexAttribute& attribute, size_t index) const
+        {
+            return GetData() + attribute.offset + index * layout.GetStride(attribute);
+        }
+        // True if every element of the attribute lies inside the vertex data.
+        bool IsInRange(const VertexAttribute& attribute) const;
+    };
+
+    /**
+     * @brief Copies the vertices into one tightly packed stream per attribute, in layout
+     * order, so a shader reading a subset of the attributes only touches their memory.
+     */
+    VertexBuffer DeinterleaveVertices(const VertexBuffer& vertices);
+
+    /**
+     * @brief Triangle corner indices, owned or external like VertexBuffer.
+     */
+    struct IndexBuffer
+    {
+        std::vector<u32> indices {};
+        const u32* external_indices {nullptr};
+        size_t external_count {0};
+
+        const u32* GetData() const { return external_indices ? external_indices : indices.data(); }
+        size_t GetCount() const { return external_indices ? external_count : indices.size(); }
+    };
+
+    /**
+     * @brief Cluster of neighbouring triangles, a contiguous range of the index buffer, with
+     * model-space bounds for culling whole clusters at once.
+     */
+    struct Meshlet
+    {
+        u32 first_index;
+        u32 triangle_count;
+        // Bounding sphere of the cluster's vertices.
+        Vec3 center;
+        f32 radius;
+        // Every triangle normal n satisfies Dot(n, cone_axis) >= cone_cutoff. A cutoff of -1
+        // or below means the normals are too spread out for cone culling.
+        Vec3 cone_axis;
+        f32 cone_cutoff;
+    };
+
+    enum class PrimitiveType
+    {
+        Triangles,
+    };
+
+    /**
+     * @brief Geometry container, independent of the file format it was loaded from.
+     * Without indices, every three consecutive vertices form a triangle.
+     */
+    struct Mesh
+    {
+        VertexBuffer vertices {};
+        IndexBuffer indices {};
+        PrimitiveType primitive_type {PrimitiveType::Triangles};
+        // Optional clusters of the index buffer, sorted by first_index and disjoint, see
+        // BuildMeshlets(). Pipeline::DrawMesh() culls them given a MeshletCulling.
+        std::vector<Meshlet> meshlets {};
+        // Keeps external vertex and index memory alive, e.g. the MappedFile of LoadMeshFile().
+        SharedPtr<const void> storage {};
+
+        bool IsIndexed() const { return indices.GetCount() != 0; }
+        u32 GetTriangleCount() const;
+    };
+
+} // namespace Rasterizer
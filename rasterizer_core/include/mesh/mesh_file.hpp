@@ -0,0 +1,70 @@
+#pragma once
+#include "Core.h"
+#include "mesh/mesh.hpp"
+
+namespace Rasterizer
+{
+
+    /*
+     * Binary mesh file (.rmesh), little endian, laid out so that loading is a memory map:
+     *
+     *   MeshFileHeader
+     *   MeshFileAttribute[attribute_count]    the VertexLayout
+     *   vertices                              vertex_count * vertex_stride bytes, interleaved
+     *                                         and/or one stream per attribute
+     *   indices                               index_count u32
+     *   Meshlet[meshlet_count]                cluster ranges and bounds
+     *
+     * Every blob starts at a multiple of c_mesh_file_alignment from the start of the file, so
+     * the mapped vertex and index data is cache line aligned and used in place.
+     */
+    constexpr u32 c_mesh_file_magic = 0x48534D52; // "RMSH"
+    constexpr u32 c_mesh_file_version = 2;
+    constexpr u64 c_mesh_file_alignment = 64;
+    constexpr u32 c_mesh_file_name_size = 32;
+
+    struct MeshFileHeader
+    {
+        u32 magic;
+        u32 version;
+        u32 attribute_count;
+        u32 vertex_stride;
+        u64 vertex_count;
+        u64 index_count;
+        u64 meshlet_count;
+        u64 attributes_offset;
+        u64 vertices_offset;
+        u64 indices_offset;
+        u64 meshlets_offset;
+    };
+
+    struct MeshFileAttribute
+    {
+        // Null terminated.
+        char name[c_mesh_file_name_size];
+        u32 format;
+        u32 offset;
+        // VertexAttribute::stride, 0 when interleaved.
+        u32 stride;
+    };
+
+    STATIC_ASSERT(sizeof(MeshFileHeader) == 72, "MeshFileHeader layout is part of the format");
+    STATIC_ASSERT(sizeof(MeshFileAttribute) == 44,
+        "MeshFileAttribute layout is part of the format");
+    STATIC_ASSERT(sizeof(Meshlet) == 40, "Meshlet layout is part of the mesh file format");
+
+    /**
+     * @brief Writes a mesh, including its meshlets, to a .rmesh file.
+     * @return false (with an error logged) if the file could not be written.
+     */
+    bool SaveMeshFile(const std::string& path, const Mesh& mesh);
+
+    /**
+     * @brief Memory-maps a .rmesh file. The vertex and index buffers of the mesh point into
+     * the mapping without a copy (see VertexBuffer::external_data) and mesh.storage keeps it
+     * alive; only the small layout and meshlet tables are copied.
+     * @return false (with an error logged) if the file is missing, truncated or malformed.
+     */
+    bool LoadMeshFile(const std::string& path, Mesh& mesh);
+
+} // namespace Rasterizer
@@ -0,0 +1,38 @@
+#pragma once
+#include "Core.h"
+#include "mesh/mesh.hpp"
+
+namespace Rasterizer
+{
+
+    // Vertices the Tipsify reordering assumes the vertex cache holds.
+    constexpr u32 c_optimizer_cache_size = 16;
+    // Default meshlet limits: 128 triangles is one vertex shader batch of the pipeline.
+    constexpr u32 c_meshlet_max_vertices = 96;
+    constexpr u32 c_meshlet_max_triangles = 128;
+
+    /**
+     * @brief Reorders triangles for post-transform vertex reuse (Tipsify, Sander et al. 2007):
+     * fans around recently used vertices so triangles sharing vertices end up close together.
+     * Triangles with indices outside [0, vertex_count) are moved to the end unchanged.
+     */
+    void OptimizeVertexCache(std::vector<u32>& indices, size_t vertex_count,
+        u32 cache_size = c_optimizer_cache_size);
+
+    /**
+     * @brief Reorders the vertices of an indexed mesh by first use so fetches walk memory
+     * forward, and drops vertices no index refers to. Rewrites the indices to match. External
+     * data is copied into the mesh first; separate streams come out one per attribute.
+     */
+    void OptimizeVertexFetch(Mesh& mesh);
+
+    /**
+     * @brief Splits the index buffer, in its current order, into consecutive meshlets of at
+     * most max_vertices unique vertices and max_triangles triangles, and computes their
+     * bounding spheres and normal cones from the "POSITION" (Vec3) attribute.
+     * @return false (with an error logged) if the mesh is not indexed or has no Vec3 POSITION.
+     */
+    bool BuildMeshlets(Mesh& mesh, u32 max_vertices = c_meshlet_max_vertices,
+        u32 max_triangles = c_meshlet_max_triangles);
+
+} // namespace Rasterizer
@@ -0,0 +1,96 @@
+#pragma once
+#include "Core.h"
+#include "pipeline/pipeline.hpp"
+#include "platform/frame_arena.hpp"
+
+namespace Rasterizer
+{
+
+    // First block of a command buffer's uniform storage.
+    constexpr size_t c_command_uniform_block_size = 64 << 10;
+
+    /**
+     * @brief Draws recorded for a later SubmitCommandBuffers() call, so scene traversal can
+     * run on several threads while pipelines are only driven from one.
+     *
+     * Commands are packed into one byte stream, an opcode followed by its operands, as a
+     * draw costs a pointer and a byte. A command buffer is private to the thread recording
+     * it and touches no pipeline state, so any number of them can be recorded in parallel.
+     * Bound state does not carry over from one command buffer to the next.
+     */
+    class CommandBuffer
+    {
+    public:
+        CommandBuffer() = default;
+
+        CommandBuffer(CommandBuffer&&) = default;
+        CommandBuffer& operator=(CommandBuffer&&) = default;
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        /**
+         * @brief Selects the pipeline of the draws that follow. Changing pipelines waits for
+         * nothing: like direct DrawMesh() calls, only draws of one pipeline are ordered.
+         */
+        void BindPipeline(Pipeline& pipeline);
+
+        /**
+         * @brief Uniforms of the draws that follow, referenced rather than copied; the block
+         * must stay unchanged until they completed (see UniformBlock).
+         */
+        void BindUniforms(const UniformBlock& uniforms);
+
+        /**
+         * @brief Copies the buffer into the command buffer, c_uniform_alignment aligned,
+         * unless it is the version bound last. Draws read the copy in place.
+         */
+        void BindUniforms(const UniformBuffer& uniforms);
+
+        /**
+         * @brief Records a DrawMesh() of the bound pipeline; the culling is copied.
+         */
+        void Draw(const Mesh& mesh, const MeshletCulling* culling = nullptr);
+
+        /**
+         * @brief Drops the recorded commands and keeps the storage. Only valid once the draws
+         * of the last submission completed, i.e. after Pipeline::Flush().
+         */
+        void Reset();
+
+        bool IsEmpty() const { return m_commands.empty(); }
+        u32 GetDrawCount() const { return m_draw_count; }
+        // Bytes of the encoded commands, without the copied uniforms.
+        size_t GetSize() const { return m_commands.size(); }
+
+    private:
+        friend void SubmitCommandBuffers(const std::vector<const CommandBuffer*>& buffers);
+
+        enum class Opcode : u8
+        {
+            BindPipeline,
+            BindUniforms,
+            Draw,
+            DrawCulled,
+        };
+
+        template <typename T>
+        void Record(Opcode opcode, const T& operands);
+
+    private:
+        std::vector<u8> m_commands {};
+        FrameArena m_uniforms {c_command_uniform_block_size};
+        // The UniformBuffer copied last, rebound without a copy while it is unchanged.
+        u64 m_uniform_version {0};
+        UniformBlock m_uniform_copy {};
+        bool m_pipeline_bound {false};
+        u32 m_draw_count {0};
+    };
+
+    /**
+     * @brief Queues the draws of the command buffers on their pipelines, buffer by buffer in
+     * the given order, and returns once all are queued. Call from the thread that configures
+     * and flushes the pipelines; the buffers must stay alive until the draws completed.
+     */
+    void SubmitCommandBuffers(const std::vector<const CommandBuffer*>& buffers);
+
+} // namespace Rasterizer
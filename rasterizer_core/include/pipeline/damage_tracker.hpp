@@ -0,0 +1,126 @@
+#pragma once
+#include "Core.h"
+#include "platform/platform.hpp"
+
+namespace Rasterizer
+{
+
+    // Frames of damage a DamageTracker remembers; targets last rendered longer ago are
+    // redrawn entirely. Covers triple buffering with a frame to spare.
+    constexpr u32 c_max_target_age = 4;
+
+    /**
+     * @brief A set of screen tiles, one bit each.
+     */
+    class TileMask
+    {
+    public:
+        /**
+         * @brief Sizes the mask for tile_count tiles, none of them set.
+         */
+        void Resize(u32 tile_count)
+        {
+            m_words.assign((tile_count + 63) / 64, 0);
+            m_tile_count = tile_count;
+        }
+
+        u32 GetTileCount() const { return m_tile_count; }
+
+        void Set(u32 tile) { m_words[tile / 64] |= 1ull << (tile % 64); }
+        bool Test(u32 tile) const { return (m_words[tile / 64] >> (tile % 64)) & 1; }
+
+        void Clear() { std::fill(m_words.begin(), m_words.end(), 0ull); }
+        void Fill();
+
+        bool IsEmpty() const;
+        u32 Count() const;
+
+        TileMask& operator|=(const TileMask& other);
+        bool operator==(const TileMask& other) const { return m_words == other.m_words; }
+
+        /**
+         * @brief Appends the set tiles of a grid tiles_x wide as pixel rectangles clipped to
+         * width x height: runs of tiles along a row, merged with the run above them when it
+         * spans the same columns.
+         */
+        void GetRects(u32 tiles_x, u32 tile_size, u32 width, u32 height,
+            std::vector<DamageRect>& rects) const;
+
+    private:
+        std::vector<u64> m_words {};
+        u32 m_tile_count {0};
+    };
+
+    /**
+     * @brief FNV-1a over a byte range, chained through hash.
+     */
+    u64 HashBytes(const void* data, size_t size, u64 hash = 0xcbf29ce484222325ull);
+
+    /**
+     * @brief Finds the tiles of a frame that differ from the frame before.
+     *
+     * Every frame lists its draws in order, each with a signature of its inputs and the tiles
+     * its triangles were binned to. A draw whose signature or tiles do not match the draw at
+     * its index last frame damages the tiles it covered then and the ones it covers now, as
+     * do draws only one of the two frames has; the other tiles saw the same draws with the
+     * same inputs and kept their pixels. The damage of the last c_max_target_age frames is
+     * kept, so a target rendered to every few frames, like a swapchain buffer, redraws what
+     * changed since its own last frame.
+     */
+    class DamageTracker
+    {
+    public:
+        /**
+         * @brief Sizes the tracker for a tile grid and forgets the previous frames; the next
+         * frame is damaged everywhere.
+         */
+        void Resize(u32 tiles_x, u32 tiles_y);
+
+        /**
+         * @brief Damages every tile of the next frame, for changes no signature covers.
+         */
+        void Invalidate() { m_invalidated = true; }
+
+        /**
+         * @brief Records the next draw of the current frame.
+         * @return Its tiles, initially none, to be set by the caller before EndFrame().
+         */
+        TileMask& AddDraw(u64 signature);
+
+        /**
+         * @brief Ends the current frame and computes its damage.
+         * @param target_age Frames since the target was last rendered to, 1 if it holds the
+         * previous frame; 0 when its contents are unknown.
+         * @return The tiles to redraw on that target, all of them if it is older than the
+         * frames remembered.
+         */
+        const TileMask& EndFrame(u32 target_age);
+
+        /**
+         * @brief The tiles the last EndFrame() found to differ from the frame before it.
+         */
+        const TileMask& GetDamage() const { return m_history[m_frame % c_max_target_age]; }
+
+    private:
+        struct DrawRecord
+        {
+            u64 signature {0};
+            TileMask tiles {};
+        };
+
+    private:
+        // The current and the previous frame's draws, pooled to keep their masks.
+        std::vector<DrawRecord> m_draws[2] {};
+        u32 m_draw_count[2] {0, 0};
+        u32 m_current {0};
+        // Damage per frame, indexed by the frame number modulo c_max_target_age.
+        TileMask m_history[c_max_target_age] {};
+        TileMask m_redraw {};
+        u64 m_frame {0};
+        // Frames of history that are valid, up to c_max_target_age.
+        u32 m_history_frames {0};
+        u32 m_tile_count {0};
+        bool m_invalidated {true};
+    };
+
+} // namespace Rasterizer
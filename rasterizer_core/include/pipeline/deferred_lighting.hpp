@@ -0,0 +1,117 @@
+#pragma once
+#include "Core.h"
+#include "math/math.hpp"
+#include "pipeline/depth_target.hpp"
+#include "pipeline/gbuffer.hpp"
+#include "pipeline/render_target.hpp"
+#include "platform/job_system.hpp"
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief A view-space point light. Its intensity falls off as (1 - d^2 / radius^2)^2
+     * over the distance d, reaching zero at the radius, so beyond it the light is culled.
+     */
+    struct PointLight
+    {
+        Vec3 position {};
+        f32 radius {1.0f};
+        // Linear RGB, may exceed 1.
+        Vec3 color {1.0f, 1.0f, 1.0f};
+    };
+
+    /**
+     * @brief What DeferredLighting::Shade() reads besides the lights.
+     */
+    struct LightingDesc
+    {
+        // The projection of the geometry pass, which reconstructs view-space positions from
+        // the depth target.
+        Mat4 projection {Mat4::Identity()};
+        // G-buffer attachments holding the albedo in RGB and the view-space normal, mapped
+        // from [-1, 1] to [0, 1], in RGB.
+        u32 albedo_attachment {0};
+        u32 normal_attachment {1};
+        // Added to the incoming light of every pixel.
+        Vec3 ambient {};
+        // Written where the depth target kept this depth, the one it was cleared to. Such
+        // pixels are not lit and their G-buffer is not read.
+        u32 background_color {0xFF000000};
+        f32 background_depth {1.0f};
+    };
+
+    /**
+     * @brief Lighting pass of deferred shading: lights a G-buffer and its depth target with
+     * point lights into a render target, one job per c_hiz_tile_size tile.
+     *
+     * A tile's job bounds the depths of its geometry by the HiZ block ranges, scanning only
+     * the blocks that mix geometry and background, unprojects the tile's corners at those
+     * depths into a view-space box and keeps the lights whose sphere reaches it. It then
+     * shades its 4x2 blocks with that list on c_simd_lanes lanes, skipping background
+     * blocks, so the cost follows the visible pixels times the lights of their tile rather
+     * than the fragments drawn times every light.
+     */
+    class DeferredLighting
+    {
+    public:
+        explicit DeferredLighting(JobSystemPtr jobs);
+        ~DeferredLighting();
+
+        DeferredLighting(const DeferredLighting&) = delete;
+        DeferredLighting& operator=(const DeferredLighting&) = delete;
+
+        /**
+         * @brief Queues the lighting of a frame, started once dependency reached zero, e.g.
+         * Pipeline::GetCompletion() of the geometry pass; waits for the previous one first.
+         * The lights are copied, the targets must stay alive until the pass completed.
+         * @return false (with an error logged) if the sizes of the targets do not match, the
+         * depth target is multisampled or the G-buffer lacks the attachments.
+         */
+        bool Shade(const GBuffer& gbuffer, const DepthTarget& depth, const LightingDesc& desc,
+            const std::vector<PointLight>& lights, RenderTarget& output,
+            JobCounter* dependency = nullptr);
+
+        /**
+         * @brief Reaches zero once the queued lighting finished.
+         */
+        JobCounter& GetCompletion() { return m_completion; }
+
+        /**
+         * @brief Waits for the queued lighting.
+         */
+        void Flush();
+
+    private:
+        static void DispatchJob(void* data, u32 index, u32 worker_index);
+        static void ShadeTileJob(void* data, u32 tile_index, u32 worker_index);
+
+        // Fills the lights reaching the tile's geometry into lights, returns their count, or
+        // ~0u if the tile only shows background.
+        u32 CullLights(u32 tile_x, u32 tile_y, u32* lights) const;
+        void ShadeTile(u32 tile_index, std::vector<u32>& lights);
+
+    private:
+        JobSystemPtr m_jobs {};
+
+        const GBuffer* m_gbuffer {nullptr};
+        const DepthTarget* m_depth {nullptr};
+        RenderTarget* m_output {nullptr};
+        LightingDesc m_desc {};
+        Mat4 m_inverse_projection {};
+
+        // The lights of the frame, one array per component.
+        std::vector<f32> m_light_x {};
+        std::vector<f32> m_light_y {};
+        std::vector<f32> m_light_z {};
+        std::vector<f32> m_light_radius {};
+        std::vector<f32> m_light_r {};
+        std::vector<f32> m_light_g {};
+        std::vector<f32> m_light_b {};
+
+        // Per worker, the indices of the lights of the tile it shades.
+        std::vector<std::vector<u32>> m_tile_lights {};
+        JobCounter m_completion {};
+    };
+
+} // namespace Rasterizer
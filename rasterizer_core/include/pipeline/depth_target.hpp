@@ -0,0 +1,106 @@
+#pragma once
+#include "Core.h"
+
+namespace Rasterizer
+{
+
+    // Pixel size of the fine HiZ level; early-Z rejects whole blocks of this size.
+    constexpr u32 c_hiz_block_size = 8;
+    // Pixel size of the coarse HiZ level, one entry per pipeline screen tile.
+    constexpr u32 c_hiz_tile_size = 64;
+
+    /**
+     * @brief Conservative depth bounds of a screen region.
+     */
+    struct DepthRange
+    {
+        f32 min;
+        f32 max;
+    };
+
+    /**
+     * @brief 32-bit float depth buffer with a two level hierarchical-Z (HiZ) pyramid.
+     *
+     * Depths are [0, 1] with smaller values closer; the pipeline tests with "less". Pixels are
+     * stored in 4x2 blocks whose 8 values follow the rasterizer's lane order (two 2x2 quads),
+     * so a block of depths loads straight into SIMD lanes. Per c_hiz_block_size block and per
+     * c_hiz_tile_size tile the min/max of the stored depths is kept; the writer refreshes them
+     * with RefreshBlock() / RefreshTile() after touching the pixels.
+     *
+     * A multisampled target keeps one depth per sample, each sample index in a plane of its
+     * own with the layout above; the HiZ ranges bound the depths of all samples.
+     */
+    class DepthTarget
+    {
+    public:
+        DepthTarget(u32 width, u32 height, u32 samples = 1);
+
+        u32 GetWidth() const { return m_width; }
+        u32 GetHeight() const { return m_height; }
+        u32 GetSampleCount() const { return m_samples; }
+
+        /**
+         * @brief The 8 depths of the 4x2 block containing pixel (x, y) in lane order.
+         */
+        f32* GetQuadBlock(u32 x, u32 y, u32 sample = 0)
+        {
+            return m_depths.data() + sample * m_plane_size + QuadBlockOffset(x, y);
+        }
+        const f32* GetQuadBlock(u32 x, u32 y, u32 sample = 0) const
+        {
+            return m_depths.data() + sample * m_plane_size + QuadBlockOffset(x, y);
+        }
+
+        f32 GetDepth(u32 x, u32 y, u32 sample = 0) const;
+
+        const DepthRange& GetBlockRange(u32 block_x, u32 block_y) const
+        {
+            return m_block_ranges[block_y * m_blocks_x + block_x];
+        }
+        const DepthRange& GetTileRange(u32 tile_x, u32 tile_y) const
+        {
+            return m_tile_ranges[tile_y * m_tiles_x + tile_x];
+        }
+
+        /**
+         * @brief Recomputes the range of a HiZ block from its pixels inside the target.
+         */
+        void RefreshBlock(u32 block_x, u32 block_y);
+
+        /**
+         * @brief Recomputes the range of a HiZ tile from its (already refreshed) blocks.
+         */
+        void RefreshTile(u32 tile_x, u32 tile_y);
+
+        void Clear(f32 depth = 1.0f);
+
+        /**
+         * @brief Sets every sample of a rectangle, and its HiZ ranges, to the depth. The
+         * rectangle must be aligned to c_hiz_tile_size, except at the right and bottom of the
+         * target.
+         */
+        void ClearRect(u32 x, u32 y, u32 width, u32 height, f32 depth = 1.0f);
+
+    private:
+        size_t QuadBlockOffset(u32 x, u32 y) const
+        {
+            const size_t block = static_cast<size_t>(y / 2) * (m_padded_width / 4) + x / 4;
+            return block * 8 + (x & 2) * 2 + (y & 1) * 2 + (x & 1);
+        }
+
+    private:
+        std::vector<f32> m_depths {};
+        std::vector<DepthRange> m_block_ranges {};
+        std::vector<DepthRange> m_tile_ranges {};
+        size_t m_plane_size {0};
+        u32 m_samples {1};
+        u32 m_width {0};
+        u32 m_height {0};
+        u32 m_padded_width {0};
+        u32 m_blocks_x {0};
+        u32 m_blocks_y {0};
+        u32 m_tiles_x {0};
+        u32 m_tiles_y {0};
+    };
+
+} // namespace Rasterizer
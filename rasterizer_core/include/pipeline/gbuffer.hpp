@@ -0,0 +1,63 @@
+#pragma once
+#include "Core.h"
+#include "pipeline/tile_cache.hpp"
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief Render targets of a deferred geometry pass, stored as the tiles the pipeline
+     * rasterizes rather than as rows.
+     *
+     * Every c_hiz_tile_size tile holds one c_tile_cache_pixels plane of BGRA8 pixels per
+     * attachment, back to back and in the layout of a TileCache, so the raster kernels write
+     * the tile in place (Pipeline::Configure()) and a lighting job reads each attachment of
+     * a 4x2 block as one vector. Pixels of edge tiles outside the target are never written.
+     */
+    class GBuffer
+    {
+    public:
+        GBuffer(u32 width, u32 height, u32 attachment_count);
+
+        u32 GetWidth() const { return m_width; }
+        u32 GetHeight() const { return m_height; }
+        u32 GetAttachmentCount() const { return m_attachment_count; }
+        u32 GetTilesX() const { return m_tiles_x; }
+        u32 GetTilesY() const { return m_tiles_y; }
+
+        /**
+         * @brief The attachment planes of a tile, see TileCache::QuadBlockOffset().
+         */
+        u32* GetTile(u32 tile_x, u32 tile_y)
+        {
+            return m_pixels.data() + TileOffset(tile_x, tile_y);
+        }
+        const u32* GetTile(u32 tile_x, u32 tile_y) const
+        {
+            return m_pixels.data() + TileOffset(tile_x, tile_y);
+        }
+
+        u32 GetPixel(u32 attachment, u32 x, u32 y) const;
+
+        /**
+         * @brief Sets every pixel of every attachment to the value.
+         */
+        void Clear(u32 value);
+
+    private:
+        size_t TileOffset(u32 tile_x, u32 tile_y) const
+        {
+            return (static_cast<size_t>(tile_y) * m_tiles_x + tile_x) * m_attachment_count *
+                c_tile_cache_pixels;
+        }
+
+    private:
+        std::vector<u32> m_pixels {};
+        u32 m_width {0};
+        u32 m_height {0};
+        u32 m_attachment_count {0};
+        u32 m_tiles_x {0};
+        u32 m_tiles_y {0};
+    };
+
+} // namespace Rasterizer
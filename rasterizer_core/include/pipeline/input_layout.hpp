@@ -0,0 +1,114 @@
+#pragma once
+#include "Core.h"
+#include "mesh/mesh.hpp"
+#include "shader/shader_api.hpp"
+
+#include <unordered_map>
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief Copies element indices[i] of a vertex attribute stream to destination +
+     * i * destination_stride. Picked per fetch when its InputLayout is built.
+     */
+    using GatherFn = void (*)(u8* destination, u32 destination_stride, const u8* source,
+        size_t source_stride, u32 size, const u32* indices, u32 count);
+
+    /**
+     * @brief Copies one run of vertex bytes into the vertex shader input. Attributes that are
+     * adjacent in both the vertex and the shader input share one fetch.
+     */
+    struct AttributeFetch
+    {
+        size_t source_offset;
+        u32 source_stride;
+        u32 destination_offset;
+        u32 size;
+        GatherFn gather;
+    };
+
+    /**
+     * @brief Vertex fetch of one (VertexLayout, vertex shader reflection) pair, like a D3D11
+     * input layout: the attributes are matched by name once, at creation, leaving offsets,
+     * strides and a specialized copy per fetch.
+     */
+    class InputLayout
+    {
+    public:
+        /**
+         * @brief Matches the shader inputs against the layout. An invalid result (with an
+         * error logged) is still returned, so the mismatch is only reported once.
+         */
+        static UniquePtr<InputLayout> Create(const VertexLayout& layout,
+            const ShaderReflection& reflection);
+
+        bool IsValid() const { return m_valid; }
+        // The interleaved vertices already are vertex shader inputs and are passed as is.
+        bool IsDirect() const { return m_direct; }
+        // True if every fetched element lies inside the vertex data; no name lookups.
+        bool IsInRange(const VertexBuffer& vertices) const;
+
+        /**
+         * @brief Gathers the shader inputs of count vertices, indices[i] into destination +
+         * i * destination_stride, one fetch at a time so each stream is read in index order.
+         */
+        void Gather(const u8* vertex_data, const u32* indices, u32 count, u8* destination,
+            u32 destination_stride) const
+        {
+            for (const AttributeFetch& fetch : m_fetches)
+            {
+                fetch.gather(destination + fetch.destination_offset, destination_stride,
+                    vertex_data + fetch.source_offset, fetch.source_stride, fetch.size, indices,
+                    count);
+            }
+        }
+
+    private:
+        std::vector<AttributeFetch> m_fetches {};
+        bool m_valid {false};
+        bool m_direct {false};
+    };
+
+    /**
+     * @brief Hash-consed input layouts of a pipeline, keyed by the interned layout id (see
+     * VertexLayout::GetId()) and the reflection, so a draw finds its layout with one integer
+     * lookup. Clear() whenever a shader is reloaded, as a new module may reuse the addresses
+     * of the old reflection.
+     */
+    class InputLayoutCache
+    {
+    public:
+        const InputLayout& Get(const VertexLayout& layout, const ShaderReflection& reflection);
+        void Clear();
+        size_t GetSize() const { return m_layouts.size(); }
+
+    private:
+        struct Key
+        {
+            u32 layout_id;
+            const ShaderReflection* reflection;
+
+            bool operator==(const Key& other) const
+            {
+                return layout_id == other.layout_id && reflection == other.reflection;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const
+            {
+                const u64 bits = reinterpret_cast<uintptr_t>(key.reflection) ^
+                    (static_cast<u64>(key.layout_id) << 32);
+                return static_cast<size_t>(bits * 0x9E3779B97F4A7C15ull);
+            }
+        };
+
+        std::unordered_map<Key, UniquePtr<InputLayout>, KeyHash> m_layouts {};
+        // Consecutive draws mostly share a layout.
+        Key m_last_key {0, nullptr};
+        const InputLayout* m_last {nullptr};
+    };
+
+} // namespace Rasterizer
@@ -0,0 +1,108 @@
+#pragma once
+#include "Core.h"
+#include "pipeline/depth_target.hpp"
+#include "pipeline/render_target.hpp"
+
+namespace Rasterizer
+{
+
+    // Samples per pixel of a MultisampleTarget.
+    constexpr u32 c_msaa_samples = 4;
+    // Pixel size of the blocks a MultisampleTarget compresses, one HiZ block each.
+    constexpr u32 c_msaa_block_size = c_hiz_block_size;
+    constexpr u32 c_msaa_block_pixels = c_msaa_block_size * c_msaa_block_size;
+    // Sample positions in 1/16 pixel from the pixel center, the rotated grid of D3D's
+    // standard 4x pattern: no two samples share a row or column.
+    inline constexpr i32 c_msaa_sample_x[c_msaa_samples] = {-2, 6, -6, 2};
+    inline constexpr i32 c_msaa_sample_y[c_msaa_samples] = {-6, -2, 2, 6};
+
+    /**
+     * @brief 4x multisampled BGRA8 color buffer that resolves into a RenderTarget.
+     *
+     * Samples are stored per c_msaa_block_size block: c_msaa_samples planes of the block's
+     * pixels, row by row, so a row of one sample loads as eight lanes. A block whose every
+     * sample of every pixel was written by one triangle is compressed: all of its samples are
+     * equal, and only plane 0 is stored and read. The raster kernel writes a block either
+     * compressed or, after Decompress(), per sample, and marks it unresolved; Resolve()
+     * averages those blocks into the resolve target and copies the compressed ones.
+     */
+    class MultisampleTarget
+    {
+    public:
+        /**
+         * @param resolve_target Receives the resolved pixels and defines the size; must
+         * outlive this target.
+         */
+        explicit MultisampleTarget(RenderTarget& resolve_target);
+
+        u32 GetWidth() const { return m_width; }
+        u32 GetHeight() const { return m_height; }
+        RenderTarget& GetResolveTarget() { return *m_resolve_target; }
+
+        /**
+         * @brief The c_msaa_samples sample planes of a block, see the class comment.
+         */
+        u32* GetBlockSamples(u32 block_x, u32 block_y)
+        {
+            return m_samples.data() + BlockIndex(block_x, block_y) * c_msaa_samples *
+                c_msaa_block_pixels;
+        }
+
+        bool IsCompressed(u32 block_x, u32 block_y) const
+        {
+            return (m_block_flags[BlockIndex(block_x, block_y)] & c_block_compressed) != 0;
+        }
+
+        /**
+         * @brief Marks a block as compressed and unresolved, its plane 0 about to be written.
+         */
+        void SetCompressed(u32 block_x, u32 block_y)
+        {
+            m_block_flags[BlockIndex(block_x, block_y)] = c_block_compressed | c_block_unresolved;
+        }
+
+        /**
+         * @brief Stores the samples of a block separately from now on and marks it unresolved,
+         * its samples about to be written individually.
+         */
+        void Decompress(u32 block_x, u32 block_y);
+
+        /**
+         * @brief Resolves the unresolved blocks overlapping the inclusive pixel rectangle into
+         * the resolve target. The rectangle must be aligned to c_msaa_block_size, except at
+         * the right and bottom of the target.
+         * @return The number of blocks resolved.
+         */
+        u32 Resolve(u32 x0, u32 y0, u32 x1, u32 y1);
+
+        /**
+         * @brief Sets every sample, and the resolve target, to the color.
+         */
+        void Clear(u32 color);
+
+        /**
+         * @brief Clear() of a rectangle aligned to c_msaa_block_size, except at the right and
+         * bottom of the target.
+         */
+        void ClearRect(u32 x, u32 y, u32 width, u32 height, u32 color);
+
+    private:
+        static constexpr u8 c_block_compressed = 1;
+        static constexpr u8 c_block_unresolved = 2;
+
+        size_t BlockIndex(u32 block_x, u32 block_y) const
+        {
+            return static_cast<size_t>(block_y) * m_blocks_x + block_x;
+        }
+
+    private:
+        std::vector<u32> m_samples {};
+        std::vector<u8> m_block_flags {};
+        RenderTarget* m_resolve_target {nullptr};
+        u32 m_width {0};
+        u32 m_height {0};
+        u32 m_blocks_x {0};
+        u32 m_blocks_y {0};
+    };
+
+} // namespace Rasterizer
@@ -0,0 +1,351 @@
+#pragma once
+#include "Core.h"
+#include "mesh/mesh.hpp"
+#include "pipeline/damage_tracker.hpp"
+#include "pipeline/input_layout.hpp"
+#include "pipeline/depth_target.hpp"
+#include "pipeline/gbuffer.hpp"
+#include "pipeline/multisample_target.hpp"
+#include "pipeline/raster_kernel.hpp"
+#include "pipeline/render_target.hpp"
+#include "pipeline/uniform_buffer.hpp"
+#include "platform/frame_arena.hpp"
+#include "platform/job_system.hpp"
+#include "shader/shader_api.hpp"
+
+namespace Rasterizer
+{
+
+    // Screen tiles are the unit of parallel rasterization; each tile is shaded by one worker.
+    constexpr u32 c_tile_size = 64;
+    STATIC_ASSERT(c_tile_size == c_hiz_tile_size, "HiZ tiles must match the pipeline tiles");
+    // Triangles shaded and binned by one geometry job.
+    constexpr u32 c_triangles_per_chunk = 1024;
+    // Triangles whose corners go through the vertex shader in one batch, sized so the batch
+    // inputs and outputs stay cache resident.
+    constexpr u32 c_vertex_batch_triangles = 128;
+    // Entries of the post-transform vertex cache that dedups the indices of one batch; a
+    // power of two well above the 3 * c_vertex_batch_triangles corners to keep collisions rare.
+    constexpr u32 c_vertex_cache_bits = 10;
+    constexpr u32 c_vertex_cache_entries = 1u << c_vertex_cache_bits;
+    STATIC_ASSERT(c_vertex_cache_entries >= 3 * c_vertex_batch_triangles,
+        "The vertex cache must be able to hold a whole batch");
+    // First block of the uniform ring, room for a thousand draws of a few cache lines each.
+    constexpr size_t c_uniform_ring_block_size = 256 << 10;
+
+    enum class CullMode
+    {
+        None,
+        Back,
+        Front,
+    };
+
+    /**
+     * @brief Fixed-function state of a pipeline. Counter-clockwise triangles are front facing.
+     */
+    struct PipelineState
+    {
+        CullMode cull_mode {CullMode::Back};
+        // Only used with a depth target bound. The depth test passes fragments closer than the
+        // stored depth.
+        bool depth_test {true};
+        bool depth_write {true};
+    };
+
+    /**
+     * @brief Per-draw view of a mesh with meshlets, for discarding whole clusters before
+     * vertex shading. The transform must not mirror, so the model-space winding of the
+     * meshlet normal cones matches the facing the pipeline culls by.
+     */
+    struct MeshletCulling
+    {
+        // The transform the vertex shader applies to POSITION, model to clip space.
+        Mat4 model_view_projection {};
+        // Eye position in model space, for the normal cone test.
+        Vec3 camera_position {};
+    };
+
+    /**
+     * @brief Settings of incremental rendering, see Pipeline::SetIncremental().
+     */
+    struct IncrementalDesc
+    {
+        // What the pipeline clears the tiles it redraws to, in place of the caller clearing
+        // the targets.
+        u32 clear_color {0xFF000000};
+        f32 clear_depth {1.0f};
+    };
+
+    struct PipelineMemoryStats
+    {
+        size_t arena_capacity;
+        // Blocks the frame arenas and the draw/chunk pools requested from the system so far.
+        // Constant from frame to frame once a repeating workload reached its steady state.
+        u64 system_allocations;
+    };
+
+    /**
+     * @brief Pairs a vertex and fragment shader with render targets and draws meshes.
+     *
+     * Every draw becomes a small job graph on the shared JobSystem:
+     * - "vertex shade" per chunk of c_triangles_per_chunk triangles: fetch, VS, clip, setup;
+     *   indices repeated within a batch of c_vertex_batch_triangles reuse the shaded vertex;
+     * - "bin" per chunk, as soon as that chunk is shaded: appends triangle indices to
+     *   chunk-private lists of the c_tile_size screen tiles they touch, in the worker's
+     *   arena; a triangle spanning several tiles skips those its edges exclude;
+     * - "raster tile" per tile the draw's triangles touch, once the draw is binned and the
+     *   last earlier draw touching the same tile is finished. A tile is only ever touched by
+     *   one job at a time and walks the chunks in submission order, so framebuffer writes
+     *   need no lock and stay ordered; tiles a draw misses cost it nothing.
+     *   With a depth target, triangles behind the tile's HiZ range are dropped before any
+     *   pixel work, then per HiZ block, and the per-pixel depth test runs before shading.
+     *   Runs of triangles fitting a 4x4 pixel stamp go to the micro triangle kernel, which
+     *   shades the quads of neighbouring ones in the same block. Colors are written to
+     *   the worker's TileCache and copied to the render targets, row by row, when the tile
+     *   is done; multisample targets are resolved then, while the tile is still in cache.
+     *   A G-buffer's tiles are already in that layout and are written in place.
+     * Tiles of one draw therefore overlap with the geometry of the next one; there is no
+     * barrier between draws. In incremental mode (SetIncremental()) a "damage" job waits for
+     * the frame to be binned first, compares it with the previous frames through a
+     * DamageTracker and clears the tiles that changed; only those are then rasterized.
+     *
+     * Post-transform triangles, varyings and tile bins are bump-allocated from one FrameArena
+     * per worker (plus one for the submitting thread), all released by Flush(), which thereby
+     * marks the end of a frame.
+     */
+    class Pipeline
+    {
+    public:
+        explicit Pipeline(JobSystemPtr jobs);
+        ~Pipeline();
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        /**
+         * @brief Binds shaders and targets and validates that they fit together, then picks
+         * the raster kernel specialized on the depth state, fragment shader entry point and
+         * render target count. Waits for queued draws first.
+         * @param depth_target Optional, must match the render target size.
+         * @param inline_shader Optional SelectInlineRasterizer<FragmentShader> for a fragment
+         * shader compiled into the host, which fs must describe; its kernels call it directly.
+         * @return false (with an error logged) if the shader interfaces or targets mismatch;
+         * the pipeline then ignores draws until configured successfully.
+         */
+        bool Configure(const VertexShaderAPI& vs, const FragmentShaderAPI& fs,
+            const std::vector<RenderTarget*>& targets, DepthTarget* depth_target = nullptr,
+            const PipelineState& state = {}, RasterizerSelector inline_shader = nullptr);
+
+        /**
+         * @brief Configure() for multisampled rendering: coverage and depth are per sample,
+         * the fragment shader runs once per pixel, and every draw resolves the tiles it
+         * touched into the resolve targets. The depth target, if any, must have
+         * c_msaa_samples samples. Clear the multisample targets rather than their resolve
+         * targets.
+         */
+        bool Configure(const VertexShaderAPI& vs, const FragmentShaderAPI& fs,
+            const std::vector<MultisampleTarget*>& targets, DepthTarget* depth_target = nullptr,
+            const PipelineState& state = {}, RasterizerSelector inline_shader = nullptr);
+
+        /**
+         * @brief Configure() for the geometry pass of deferred shading: the fragment shader
+         * writes one output per attachment of the G-buffer, whose tiles the raster kernels
+         * write in place instead of going through the tile cache. Pixels the draws leave at
+         * the clear depth are not read by DeferredLighting, so the G-buffer needs no clear.
+         */
+        bool Configure(const VertexShaderAPI& vs, const FragmentShaderAPI& fs, GBuffer& gbuffer,
+            DepthTarget* depth_target = nullptr, const PipelineState& state = {},
+            RasterizerSelector inline_shader = nullptr);
+
+        /**
+         * @brief The uniforms of the bound shaders by name, resolved by Configure(). Find the
+         * slots once after configuring and set them per draw through UniformBuffer::Set().
+         */
+        const UniformLayout& GetUniformLayout() const { return m_uniform_layout; }
+
+        /**
+         * @brief Copies uniforms into the frame's uniform ring, c_uniform_alignment aligned.
+         * The block stays valid and unchanged until Flush() and may be passed to any number
+         * of draws. Uploading a buffer again without changing it returns the same block.
+         */
+        UniformBlock UploadUniforms(const UniformBuffer& uniforms);
+
+        /**
+         * @brief Queues a draw of the mesh into the bound targets and returns immediately.
+         * The mesh and the uniform block must stay alive and unchanged until the draw
+         * completed; the draw keeps a pointer to the block rather than a copy. Draws whose
+         * mesh or uniforms do not satisfy the shader reflection are skipped with an error.
+         * @param culling If set and the mesh has meshlets, meshlets outside the frustum, or
+         * facing away under CullMode::Back (towards the eye under CullMode::Front), are
+         * skipped before their vertices are shaded. Triangles outside every meshlet are drawn.
+         */
+        void DrawMesh(const Mesh& mesh, const UniformBlock& uniforms,
+            const MeshletCulling* culling = nullptr);
+
+        /**
+         * @brief DrawMesh() with the uniforms uploaded first; a buffer that did not change
+         * since the previous draw shares that draw's block.
+         */
+        void DrawMesh(const Mesh& mesh, const UniformBuffer& uniforms,
+            const MeshletCulling* culling = nullptr)
+        {
+            DrawMesh(mesh, UploadUniforms(uniforms), culling);
+        }
+
+        /**
+         * @brief Renders mostly static frames incrementally, or every tile again if desc is
+         * null, the default. Each frame's draws are compared with the previous frame's by
+         * their mesh, uniform bytes, culling and the tiles they cover; only the tiles where
+         * they differ are cleared, as the desc says, and rendered again. The caller no longer
+         * clears the targets. Changed vertex, index or texture contents behind unchanged
+         * pointers are not noticed, call InvalidateFrame() after changing them.
+         */
+        void SetIncremental(const IncrementalDesc* desc);
+
+        /**
+         * @brief Renders every tile of the next incremental frame again.
+         */
+        void InvalidateFrame() { m_damage.Invalidate(); }
+
+        /**
+         * @brief Ends the frame's draws: in incremental mode, once they are binned, work out
+         * which tiles to render. Further draws have to wait for Flush(). Nothing to do
+         * otherwise; Flush() submits a frame itself if needed.
+         * @param target_age Frames since the bound targets were last rendered to, the
+         * Surface::age of a window's back buffer; 1 for targets drawn every frame, 0 if their
+         * contents are unknown.
+         */
+        void Submit(u32 target_age = 1);
+
+        /**
+         * @brief The pixels of the frame that changed since the previous one, for
+         * IWindow::Draw(), valid once the frame completed. Without incremental rendering this
+         * is the whole target.
+         */
+        const std::vector<DamageRect>& GetDamage() const { return m_damage_rects; }
+
+        /**
+         * @brief Reaches zero once every queued draw finished, e.g. to chain a present job.
+         * In incremental mode that needs Submit() first.
+         */
+        JobCounter& GetCompletion() { return m_completion; }
+
+        /**
+         * @brief Waits for all queued draws and recycles their transient storage.
+         */
+        void Flush();
+
+        PipelineMemoryStats GetMemoryStats() const;
+
+        /**
+         * @brief Drops the cached input layouts. Configure() does this when the vertex shader
+         * changes; call it after reloading a shader module in place.
+         */
+        void InvalidateInputLayouts() { m_input_layouts.Clear(); }
+
+    private:
+        struct GeometryChunk;
+        struct DrawContext;
+        struct WorkerScratch;
+
+        static void ShadeChunkJob(void* data, u32 chunk_index, u32 worker_index);
+        static void BinChunkJob(void* data, u32 chunk_index, u32 worker_index);
+        static void DispatchTilesJob(void* data, u32 index, u32 worker_index);
+        // No work of its own; signals its counter once its dependency released it.
+        static void ReleaseJob(void* data, u32 index, u32 worker_index);
+        static void RasterizeTileJob(void* data, u32 tile_index, u32 worker_index);
+        static void DamageJob(void* data, u32 index, u32 worker_index);
+
+        // All Configure()s; multisample_targets is empty or resolves into targets, targets
+        // is empty if gbuffer is set.
+        bool ConfigureTargets(const VertexShaderAPI& vs, const FragmentShaderAPI& fs,
+            const std::vector<RenderTarget*>& targets,
+            const std::vector<MultisampleTarget*>& multisample_targets, GBuffer* gbuffer,
+            DepthTarget* depth_target, const PipelineState& state,
+            RasterizerSelector inline_shader);
+
+        void ShadeChunk(DrawContext& draw, GeometryChunk& chunk, WorkerScratch& scratch,
+            u32 first_triangle, u32 end_triangle);
+        // Shades, clips and sets up a triangle range; returns the vertices shaded.
+        u32 ShadeTriangles(const DrawContext& draw, GeometryChunk& chunk,
+            WorkerScratch& scratch, u32 first_triangle, u32 end_triangle);
+        // Returns the number of vertices shaded, less than 3 per triangle for indexed meshes.
+        u32 ShadeVertexBatch(const DrawContext& draw, WorkerScratch& scratch, u32 first_triangle,
+            u32 triangle_count);
+        void SetupTriangle(GeometryChunk& chunk, const f32* v0, const f32* v1, const f32* v2);
+        void BinChunk(GeometryChunk& chunk, WorkerScratch& scratch);
+        void RasterizeTile(const DrawContext& draw, u32 tile_index, WorkerScratch& scratch);
+        // Finds the tiles of the frame to redraw and clears them.
+        void SelectRedrawTiles();
+
+    private:
+        JobSystemPtr m_jobs {};
+
+        VertexShaderAPI m_vs {};
+        FragmentShaderAPI m_fs {};
+        std::vector<RenderTarget*> m_targets {};
+        // Empty unless multisampled, then one per render target, which it resolves into.
+        std::vector<MultisampleTarget*> m_multisample_targets {};
+        // Set instead of the render targets for a deferred geometry pass.
+        GBuffer* m_gbuffer {nullptr};
+        DepthTarget* m_depth {nullptr};
+        PipelineState m_state {};
+        bool m_configured {false};
+
+        u32 m_width {0};
+        u32 m_height {0};
+        u32 m_tiles_x {0};
+        u32 m_tiles_y {0};
+        // Clip-space guard band (see clipper.hpp): triangles inside it are only scissored.
+        f32 m_guard_band_x {1.0f};
+        f32 m_guard_band_y {1.0f};
+
+        // Float count of one vertex shader output, clip position first.
+        u32 m_vertex_floats {0};
+        // Vertex output float index and fragment input float index of every varying component.
+        std::vector<u32> m_varying_sources {};
+        std::vector<u32> m_varying_destinations {};
+        // Fragment output float index of the color written to each render target.
+        std::vector<u32> m_color_offsets {};
+        // Float count of one fragment's input and output struct.
+        u32 m_fs_input_floats {0};
+        u32 m_fs_output_floats {0};
+        // The kernels picked by Configure() and the configuration it reads.
+        RasterKernels m_kernels {};
+        RasterContext m_raster {};
+        // Bytes of one chunk triangle record: the setup followed by its varyings.
+        u32 m_triangle_stride {0};
+
+        std::vector<WorkerScratch> m_scratch;
+
+        // Draws queued since the last Flush(); contexts are pooled to keep their capacity.
+        std::vector<UniquePtr<DrawContext>> m_draws;
+        u32 m_draw_count {0};
+        // Draw parameters copied by DrawMesh().
+        FrameArena m_submit_arena {};
+        UniformLayout m_uniform_layout {};
+        // Uniform blocks of the frame. Flush() waits for every draw before rewinding it, so
+        // one arena is a ring with a single frame in flight.
+        FrameArena m_uniform_ring {c_uniform_ring_block_size};
+        // The last upload, shared by draws until the buffer's version changes.
+        u64 m_uploaded_version {0};
+        UniformBlock m_uploaded_block {};
+        InputLayoutCache m_input_layouts {};
+        u64 m_pool_allocations {0};
+        JobCounter m_completion {};
+
+        // Incremental rendering: the tiles to redraw this frame once the damage job picked
+        // them, null while every touched tile is drawn.
+        bool m_incremental {false};
+        IncrementalDesc m_incremental_desc {};
+        DamageTracker m_damage {};
+        const TileMask* m_redraw {nullptr};
+        std::vector<DamageRect> m_damage_rects {};
+        std::vector<DamageRect> m_redraw_rects {};
+        // Held by Submit() and every chunk of the frame until it is binned.
+        JobCounter m_frame_binned {};
+        bool m_submitted {false};
+        u32 m_target_age {1};
+    };
+
+} // namespace Rasterizer
@@ -0,0 +1,1214 @@
+#pragma once
+#include "Core.h"
+#include "pipeline/depth_target.hpp"
+#include "pipeline/multisample_target.hpp"
+#include "pipeline/render_target.hpp"
+#include "pipeline/simd.hpp"
+#include "pipeline/tile_cache.hpp"
+#include "shader/shader_api.hpp"
+
+#include <algorithm>
+#include <bit>
+
+/*
+ * The innermost loop of the pipeline: coverage, early depth, varying interpolation, the
+ * fragment shader and the color writes of one triangle inside one tile. It is a template on
+ * the pipeline state that would otherwise be branched on per pixel block, instantiated once
+ * per combination; Pipeline::Configure picks the instantiation, like a PSO. Kept in a header
+ * so a fragment shader compiled into the host can be instantiated into it and inlined, see
+ * InlineFragmentStage. Triangles of a few pixels take a second kernel of the same permutation,
+ * RasterizeMicroTriangles, which skips the traversal and packs several into one block.
+ * Multisampled targets have a kernel of their own, RasterizeTriangleMultisample. Colors go to
+ * the worker's TileCache, which the pipeline writes back once the tile is done.
+ */
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief Attribute that is affine in screen space: origin at the triangle's vertex 0,
+     * changing by dx per pixel right and dy per pixel down.
+     */
+    struct PlaneEquation
+    {
+        f32 dx;
+        f32 dy;
+        f32 origin;
+    };
+
+    // Screen positions are snapped to 16.8 fixed point, 1/256 pixel.
+    constexpr u32 c_subpixel_bits = 8;
+    constexpr i32 c_subpixel_scale = 1 << c_subpixel_bits;
+    // Largest position magnitude in pixels that snaps and rasterizes without overflow; the
+    // guard band keeps clipped triangles well inside it.
+    constexpr f32 c_max_snapped_pixels = 32768.0f;
+
+    inline f32 FixedToPixels(i32 value)
+    {
+        return static_cast<f32>(value) * (1.0f / static_cast<f32>(c_subpixel_scale));
+    }
+
+    /**
+     * @brief Screen-space triangle ready for rasterization. Vertices are ordered so that the
+     * signed area, and therefore every edge function inside the triangle, is positive.
+     * Each one is followed in memory by the plane equation of every varying divided by w,
+     * so a pixel needs two multiply-adds per varying instead of a barycentric blend.
+     */
+    struct TriangleSetup
+    {
+        // Snapped vertex positions in fixed-point pixels, see c_subpixel_bits.
+        i32 x[3];
+        i32 y[3];
+        // NDC depth, and 1 / w for perspective correction.
+        PlaneEquation z;
+        PlaneEquation inv_w;
+        f32 min_z;
+        f32 max_z;
+        f32 min_inv_w;
+
+        // Inclusive pixel bounds, clamped to the render targets.
+        i32 min_x;
+        i32 min_y;
+        i32 max_x;
+        i32 max_y;
+
+        const PlaneEquation* GetVaryings() const
+        {
+            return reinterpret_cast<const PlaneEquation*>(this + 1);
+        }
+        PlaneEquation* GetVaryings() { return reinterpret_cast<PlaneEquation*>(this + 1); }
+    };
+
+    /**
+     * @brief The plane through the values f[i] at the triangle's vertices. d[x|y][i] are the
+     * offsets of vertices 1 and 2 from vertex 0, inv_area one over their cross product.
+     */
+    inline PlaneEquation ComputePlane(const f32* f, const f32* dx, const f32* dy, f32 inv_area)
+    {
+        const f32 d1 = f[1] - f[0];
+        const f32 d2 = f[2] - f[0];
+        return {(d1 * dy[1] - d2 * dy[0]) * inv_area, (d2 * dx[0] - d1 * dx[1]) * inv_area,
+            f[0]};
+    }
+
+    /**
+     * @brief Evaluates the plane at offsets (x, y) from the triangle's vertex 0.
+     */
+    inline Float8 EvaluatePlane8(const PlaneEquation& plane, Float8 x, Float8 y)
+    {
+        return MulAdd8(Broadcast8(plane.dx), x, MulAdd8(Broadcast8(plane.dy), y,
+            Broadcast8(plane.origin)));
+    }
+
+    /**
+     * @brief What a raster kernel reads from the configured pipeline; constant between
+     * Pipeline::Configure calls.
+     */
+    struct RasterContext
+    {
+        // Fragment input float index of every varying component.
+        const u32* varying_destinations;
+        u32 varying_count;
+        // Float count of one fragment's input and output struct.
+        u32 fs_input_floats;
+        u32 fs_output_floats;
+        // Fragment output float index of the color of each render target.
+        const u32* color_offsets;
+        RenderTarget* const* targets;
+        u32 target_count;
+        // Null unless multisampled; targets are then their resolve targets.
+        MultisampleTarget* const* multisample_targets;
+        // Null when no depth target is bound.
+        DepthTarget* depth;
+        FSMainFn fs_main;
+        FSMainPacketFn fs_packet;
+    };
+
+    /**
+     * @brief Per-worker state of a raster kernel: c_simd_lanes fragments worth of shader
+     * inputs and outputs (see FragmentLane()), the cached colors and the statistics of the
+     * current tile.
+     */
+    struct RasterScratch
+    {
+        f32* fs_input;
+        f32* fs_output;
+        // Holds the render targets' pixels while the tile is rasterized; unused by the
+        // multisampled kernel, which writes its own block storage.
+        TileCache* tile_cache;
+        u64 fragments_shaded;
+        u64 hiz_blocks_rejected;
+    };
+
+    /**
+     * @brief Rasterizes the part of the triangle inside the inclusive tile rectangle.
+     * @return true if depths were written, so the caller refreshes the tile's HiZ range.
+     */
+    using RasterizeTriangleFn = bool (*)(const RasterContext& context,
+        const TriangleSetup& triangle, i32 tile_x0, i32 tile_y0, i32 tile_x1, i32 tile_y1,
+        RasterScratch& scratch, const void* uniforms);
+
+    /**
+     * @brief Rasterizes micro triangles (see IsMicroTriangle()) in order, shading the quads of
+     * different triangles together in one block.
+     * @return true if depths were written, so the caller refreshes the tile's HiZ range.
+     */
+    using RasterizeMicroTrianglesFn = bool (*)(const RasterContext& context,
+        const TriangleSetup* const* triangles, u32 triangle_count, i32 tile_x0, i32 tile_y0,
+        i32 tile_x1, i32 tile_y1, RasterScratch& scratch, const void* uniforms);
+
+    /**
+     * @brief The kernels of one permutation, for triangles in general and for micro triangles.
+     */
+    struct RasterKernels
+    {
+        RasterizeTriangleFn triangle;
+        RasterizeMicroTrianglesFn micro_triangles;
+    };
+
+    /**
+     * @brief The state a kernel is specialized on. A depth test or write is only requested
+     * with a depth target bound; fs_width is 1 without a packet entry point.
+     */
+    struct RasterPermutation
+    {
+        bool depth_test;
+        bool depth_write;
+        u32 fs_width;
+        u32 target_count;
+        // Multisampled permutations have no micro triangle kernel.
+        bool multisample;
+    };
+
+    /**
+     * @brief Returns the kernels of a permutation, null if the shader cannot run it.
+     */
+    using RasterizerSelector = RasterKernels (*)(const RasterPermutation& permutation);
+
+    /**
+     * @brief Index of float component k of block lane l in packets of width lanes, each packet
+     * holding packet_floats components per lane. Width 1 degenerates to one struct per lane.
+     */
+    constexpr size_t FragmentLane(u32 lane, u32 component, u32 width, u32 packet_floats)
+    {
+        return (lane / width) * packet_floats * width + component * width + lane % width;
+    }
+
+    // Pixel offsets of the lanes of a 4x2 block: two 2x2 quads, as the packet ABI lays them out.
+    alignas(32) inline constexpr f32 c_lane_x[c_simd_lanes] = {0, 1, 0, 1, 2, 3, 2, 3};
+    alignas(32) inline constexpr f32 c_lane_y[c_simd_lanes] = {0, 0, 1, 1, 0, 0, 1, 1};
+    // Lanes of each block column and row.
+    inline constexpr u32 c_column_lanes[4] = {0x05, 0x0A, 0x50, 0xA0};
+    inline constexpr u32 c_row_lanes[2] = {0x33, 0xCC};
+    inline constexpr u32 c_all_lanes = (1u << c_simd_lanes) - 1;
+
+    /**
+     * @brief Whether the part of the triangle inside the inclusive tile rectangle fits in one
+     * 4x4 pixel stamp aligned to 4 pixels, i.e. covers at most four 2x2 quads. Such triangles
+     * cost more in traversal and half-empty blocks than in shading.
+     */
+    inline bool IsMicroTriangle(const TriangleSetup& triangle, i32 tile_x0, i32 tile_y0,
+        i32 tile_x1, i32 tile_y1)
+    {
+        const i32 x0 = std::max(triangle.min_x, tile_x0);
+        const i32 x1 = std::min(triangle.max_x, tile_x1);
+        const i32 y0 = std::max(triangle.min_y, tile_y0);
+        const i32 y1 = std::min(triangle.max_y, tile_y1);
+        return ((x0 ^ x1) & ~3) == 0 && ((y0 ^ y1) & ~3) == 0;
+    }
+
+    /**
+     * @brief Edge function of a snapped triangle in exact integer arithmetic: its value at the
+     * center of pixel (px, py) is At(px, py), incrementally origin + px * step_x + py * step_y.
+     * The pixel is covered when the values of all three edges are >= 0.
+     */
+    struct EdgeEquation
+    {
+        i64 origin;
+        i64 step_x;
+        i64 step_y;
+
+        i64 At(i32 px, i32 py) const { return origin + px * step_x + py * step_y; }
+    };
+
+    // 1 unless the edge from (0, 0) to (dx, dy) is a top or a left edge. Branchless, as edge
+    // directions are unpredictable.
+    inline i32 EdgeBias(i32 dx, i32 dy)
+    {
+        return static_cast<i32>((dy > 0) | ((dy == 0) & (dx <= 0)));
+    }
+
+    /**
+     * @brief The edge equations of a triangle; edge i is zero on the edge opposite to vertex
+     * i and positive inside: e = dx * (sample_y - y) - dy * (sample_x - x) relative to a
+     * vertex of that edge. 16.8 positions bound |e| by 2^48, so it never overflows.
+     *
+     * Pixel centers exactly on an edge follow the top-left rule: they belong to the triangle
+     * if the edge is a top edge (horizontal with the triangle below) or a left edge (the
+     * triangle to its right), otherwise the value is biased by -1. Both triangles sharing an
+     * edge evaluate the same integers with opposite signs, so exactly one of them covers a
+     * pixel on it: no cracks and no pixels shaded twice.
+     */
+    inline void SetupEdges(const TriangleSetup& triangle, EdgeEquation* edges)
+    {
+        constexpr i64 half = c_subpixel_scale / 2;
+        for (u32 i = 0; i < 3; ++i)
+        {
+            const u32 from = (i + 1) % 3;
+            const u32 to = (i + 2) % 3;
+            const i32 dx = triangle.x[to] - triangle.x[from];
+            const i32 dy = triangle.y[to] - triangle.y[from];
+            edges[i] = {dx * (half - triangle.y[from]) - dy * (half - triangle.x[from]) -
+                EdgeBias(dx, dy), -i64(dy) * c_subpixel_scale, i64(dx) * c_subpixel_scale};
+        }
+    }
+
+    /**
+     * @brief The three edge equations of a triangle over the lanes of 4x2 blocks, tested in
+     * 32-bit integer lanes one square of pixels at a time.
+     *
+     * Steps are multiples of c_subpixel_scale, so e + c_subpixel_scale * k is >= 0 exactly
+     * when (e >> c_subpixel_bits) + k is. SetupSquare() takes that shifted value at a square's
+     * origin; across a square of up to c_hiz_block_size pixels every edge changes it by less
+     * than 2^28, so clamping it to +-2^30 keeps all signs and nothing overflows. Blocks are
+     * then reached by stepping: an add per edge and block.
+     */
+    struct EdgeFunctions8
+    {
+        // Per edge: its first vertex, bias and per pixel steps in units of c_subpixel_scale.
+        i32 from_x[3];
+        i32 from_y[3];
+        i32 bias[3];
+        i32 step_x[3];
+        i32 step_y[3];
+        // Offsets of a block's lanes from its first pixel, and the step to the next block.
+        Int32x8 lanes[3];
+        Int32x8 block_step[3];
+
+        explicit EdgeFunctions8(const TriangleSetup& triangle)
+        {
+            for (u32 i = 0; i < 3; ++i)
+            {
+                const u32 from = (i + 1) % 3;
+                const u32 to = (i + 2) % 3;
+                const i32 dx = triangle.x[to] - triangle.x[from];
+                const i32 dy = triangle.y[to] - triangle.y[from];
+                from_x[i] = triangle.x[from];
+                from_y[i] = triangle.y[from];
+                bias[i] = EdgeBias(dx, dy);
+                step_x[i] = -dy;
+                step_y[i] = dx;
+                lanes[i] = BlockSteps8(step_x[i], step_y[i]);
+                block_step[i] = BroadcastInt32x8(4 * step_x[i]);
+            }
+        }
+
+        /**
+         * @brief The edge values at pixel (px, py), as SetupEdges() evaluates them, for the
+         * square of pixels from there. Samples are taken (offset_x, offset_y) fixed-point
+         * units from the pixel centers.
+         */
+        void SetupSquare(i32 px, i32 py, i32* origins, i32 offset_x = 0, i32 offset_y = 0) const
+        {
+            constexpr i64 c_limit = i64(1) << 30;
+            constexpr i32 half = c_subpixel_scale / 2;
+            for (u32 i = 0; i < 3; ++i)
+            {
+                const i64 sample_x = half + offset_x + px * c_subpixel_scale - from_x[i];
+                const i64 sample_y = half + offset_y + py * c_subpixel_scale - from_y[i];
+                const i64 value =
+                    (step_y[i] * sample_y + step_x[i] * sample_x - bias[i]) >> c_subpixel_bits;
+                origins[i] = static_cast<i32>(std::clamp(value, -c_limit, c_limit));
+            }
+        }
+
+        /**
+         * @brief Whether an edge excludes every pixel center of the size x size square.
+         */
+        bool ExcludesSquare(const i32* origins, i32 size) const
+        {
+            for (u32 i = 0; i < 3; ++i)
+            {
+                if (origins[i] + std::max(0, (size - 1) * step_x[i]) +
+                    std::max(0, (size - 1) * step_y[i]) < 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Whether every pixel center of the size x size square is inside all edges.
+         */
+        bool CoversSquare(const i32* origins, i32 size) const
+        {
+            for (u32 i = 0; i < 3; ++i)
+            {
+                if (origins[i] + std::min(0, (size - 1) * step_x[i]) +
+                    std::min(0, (size - 1) * step_y[i]) < 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Lane values of the block offset by (x, y) pixels from the square's origin.
+        void BlockAt(const i32* origins, i32 x, i32 y, Int32x8* values) const
+        {
+            for (u32 i = 0; i < 3; ++i)
+            {
+                values[i] = BroadcastInt32x8(origins[i] + x * step_x[i] + y * step_y[i]) +
+                    lanes[i];
+            }
+        }
+
+        // Steps the lane values to the block 4 pixels to the right.
+        void StepBlock(Int32x8* values) const
+        {
+            for (u32 i = 0; i < 3; ++i)
+            {
+                values[i] = values[i] + block_step[i];
+            }
+        }
+
+        // Mask of the covered lanes.
+        static u32 Inside(const Int32x8* values)
+        {
+            return NonNegativeMask(values[0], values[1], values[2]);
+        }
+    };
+
+    /**
+     * @brief Fragment stage calling a module's per-pixel entry point, one call per fragment.
+     */
+    struct ScalarFragmentStage
+    {
+        static constexpr u32 c_width = 1;
+
+        static void Shade(const RasterContext& context, const f32* inputs, f32* outputs, u32,
+            const void* uniforms)
+        {
+            context.fs_main(inputs, outputs, uniforms);
+        }
+    };
+
+    /**
+     * @brief Fragment stage calling a module's packet entry point through its pointer.
+     */
+    template <u32 Width>
+    struct PacketFragmentStage
+    {
+        static constexpr u32 c_width = Width;
+
+        static void Shade(const RasterContext& context, const f32* inputs, f32* outputs,
+            u32 coverage_mask, const void* uniforms)
+        {
+            context.fs_packet(inputs, outputs, coverage_mask, uniforms);
+        }
+    };
+
+    /**
+     * @brief Fragment stage of a shader compiled into the host: FragmentShader provides
+     * `static constexpr u32 simd_width` and a static FS_MainPacket (see FSMainPacketFn), which
+     * the compiler can inline into the kernel. Hot-reloading does not apply to it.
+     */
+    template <typename FragmentShader>
+    struct InlineFragmentStage
+    {
+        static constexpr u32 c_width = FragmentShader::simd_width;
+        STATIC_ASSERT(c_width == 4 || c_width == 8, "Packet shaders are 4 or 8 lanes wide");
+
+        static void Shade(const RasterContext&, const f32* inputs, f32* outputs,
+            u32 coverage_mask, const void* uniforms)
+        {
+            FragmentShader::FS_MainPacket(inputs, outputs, coverage_mask, uniforms);
+        }
+    };
+
+    /**
+     * @brief Stores one varying component of a block's lanes into the fragment inputs.
+     */
+    template <u32 Width>
+    inline void StoreFragmentInput(f32* fs_input, u32 destination, u32 fs_input_floats,
+        Float8 value)
+    {
+        if constexpr (Width == c_simd_lanes)
+        {
+            Store8(fs_input + destination * c_simd_lanes, value);
+        }
+        else
+        {
+            alignas(32) f32 lanes[c_simd_lanes];
+            Store8(lanes, value);
+            for (u32 lane = 0; lane < c_simd_lanes; ++lane)
+            {
+                fs_input[FragmentLane(lane, destination, Width, fs_input_floats)] = lanes[lane];
+            }
+        }
+    }
+
+    /**
+     * @brief Runs the fragment shader on the covered packets of a block whose inputs are
+     * stored, then hands the packed colors of each render target t to write(t, colors).
+     */
+    template <u32 TargetCount, typename FragmentStage, typename WriteColors>
+    inline void ShadeFragmentColors(const RasterContext& context, u32 coverage,
+        RasterScratch& scratch, const void* uniforms, WriteColors&& write)
+    {
+        constexpr u32 width = FragmentStage::c_width;
+        constexpr u32 lane_mask = (1u << width) - 1;
+        const u32 target_count = TargetCount ? TargetCount : context.target_count;
+        const u32 fs_output_floats = context.fs_output_floats;
+        f32* fs_output = scratch.fs_output;
+
+        scratch.fragments_shaded += std::popcount(coverage);
+        for (u32 first = 0; first < c_simd_lanes; first += width)
+        {
+            const u32 packet_coverage = (coverage >> first) & lane_mask;
+            if (packet_coverage == 0)
+            {
+                continue;
+            }
+            FragmentStage::Shade(context, scratch.fs_input + first * context.fs_input_floats,
+                fs_output + first * fs_output_floats, packet_coverage, uniforms);
+        }
+
+        alignas(32) f32 colors[4][c_simd_lanes];
+        alignas(32) u32 packed[c_simd_lanes];
+        for (u32 t = 0; t < target_count; ++t)
+        {
+            const u32 offset = context.color_offsets[t];
+            const f32* channels[4];
+            for (u32 c = 0; c < 4; ++c)
+            {
+                if constexpr (width == c_simd_lanes)
+                {
+                    channels[c] = fs_output + (offset + c) * c_simd_lanes;
+                }
+                else
+                {
+                    for (u32 lane = 0; lane < c_simd_lanes; ++lane)
+                    {
+                        colors[c][lane] = fs_output[FragmentLane(lane, offset + c, width,
+                            fs_output_floats)];
+                    }
+                    channels[c] = colors[c];
+                }
+            }
+            PackColors8(channels[0], channels[1], channels[2], channels[3], packed);
+            write(t, packed);
+        }
+    }
+
+    /**
+     * @brief ShadeFragmentColors() writing the colors of the covered lanes to the tile cache.
+     * The two quads of the block sit at pixels (quad_x[i], quad_y[i]), not necessarily next
+     * to each other; when they form a 4x2 block they store as one vector.
+     */
+    template <u32 TargetCount, typename FragmentStage>
+    inline void ShadeFragments(const RasterContext& context, u32 coverage, const u32* quad_x,
+        const u32* quad_y, RasterScratch& scratch, const void* uniforms)
+    {
+        TileCache& cache = *scratch.tile_cache;
+        const bool one_block = (quad_x[0] & 3) == 0 && quad_x[1] == quad_x[0] + 2 &&
+            quad_y[1] == quad_y[0];
+        ShadeFragmentColors<TargetCount, FragmentStage>(context, coverage, scratch, uniforms,
+            [&](u32 t, const u32* colors)
+            {
+                if (one_block)
+                {
+                    StoreColors8(cache.GetQuadBlock(t, quad_x[0], quad_y[0]), colors,
+                        coverage);
+                    return;
+                }
+                for (u32 quad = 0; quad < 2; ++quad)
+                {
+                    const u32 quad_coverage = (coverage >> (4 * quad)) & 0xF;
+                    if (quad_coverage == 0)
+                    {
+                        continue;
+                    }
+                    // A 2x2 quad is the first or the second half of its 4x2 block's lanes.
+                    u32* pixels = cache.GetQuadBlock(t, quad_x[quad], quad_y[quad]) +
+                        (quad_x[quad] & 2) * 2;
+                    for (u32 lane = 0; lane < 4; ++lane)
+                    {
+                        if (quad_coverage & (1u << lane))
+                        {
+                            pixels[lane] = colors[4 * quad + lane];
+                        }
+                    }
+                }
+            });
+    }
+
+    /**
+     * @brief The raster kernel of one permutation. TargetCount 0 loops over
+     * context.target_count render targets, any other value is the exact count.
+     */
+    template <bool DepthTest, bool DepthWrite, u32 TargetCount, typename FragmentStage>
+    bool RasterizeTriangle(const RasterContext& context, const TriangleSetup& triangle,
+        i32 tile_x0, i32 tile_y0, i32 tile_x1, i32 tile_y1, RasterScratch& scratch,
+        const void* uniforms)
+    {
+        const i32 x0 = std::max(triangle.min_x, tile_x0);
+        const i32 x1 = std::min(triangle.max_x, tile_x1);
+        const i32 y0 = std::max(triangle.min_y, tile_y0);
+        const i32 y1 = std::min(triangle.max_y, tile_y1);
+        if (x0 > x1 || y0 > y1)
+        {
+            return false;
+        }
+
+        constexpr u32 width = FragmentStage::c_width;
+        const u32 varying_count = context.varying_count;
+        const PlaneEquation* varyings = triangle.GetVaryings();
+        const u32* destinations = context.varying_destinations;
+        const u32 fs_input_floats = context.fs_input_floats;
+        f32* fs_input = scratch.fs_input;
+        DepthTarget* depth_target = context.depth;
+
+        const EdgeFunctions8 edges(triangle);
+        const Float8 origin_x = Broadcast8(FixedToPixels(triangle.x[0]));
+        const Float8 origin_y = Broadcast8(FixedToPixels(triangle.y[0]));
+        const Float8 lane_x = Load8(c_lane_x);
+        const Float8 lane_y = Load8(c_lane_y);
+
+        alignas(32) f32 lanes[c_simd_lanes];
+        bool wrote_depth = false;
+
+        // HiZ blocks are the unit of early depth rejection, 4x2 pixel blocks inside them the
+        // unit of SIMD work. Tile origins are aligned to both, so no block leaves the tile.
+        constexpr i32 c_block = static_cast<i32>(c_hiz_block_size);
+        for (i32 hiz_y = y0 & ~(c_block - 1); hiz_y <= y1; hiz_y += c_block)
+        {
+            for (i32 hiz_x = x0 & ~(c_block - 1); hiz_x <= x1; hiz_x += c_block)
+            {
+                const u32 hiz_block_x = static_cast<u32>(hiz_x) / c_hiz_block_size;
+                const u32 hiz_block_y = static_cast<u32>(hiz_y) / c_hiz_block_size;
+                bool test_pixels = DepthTest;
+                if constexpr (DepthTest)
+                {
+                    const DepthRange& range =
+                        depth_target->GetBlockRange(hiz_block_x, hiz_block_y);
+                    if (triangle.min_z >= range.max)
+                    {
+                        ++scratch.hiz_blocks_rejected;
+                        continue;
+                    }
+                    // In front of everything stored in the block: every pixel passes.
+                    test_pixels = triangle.max_z >= range.min;
+                }
+                i32 edge_origins[3];
+                edges.SetupSquare(hiz_x, hiz_y, edge_origins);
+                if (edges.ExcludesSquare(edge_origins, c_block))
+                {
+                    continue;
+                }
+
+                const i32 block_x1 = std::min(hiz_x + c_block - 1, x1);
+                const i32 block_y1 = std::min(hiz_y + c_block - 1, y1);
+                bool block_written = false;
+                for (i32 by = std::max(hiz_y, y0 & ~1); by <= block_y1; by += 2)
+                {
+                    const u32 row_mask = (by >= y0 ? c_row_lanes[0] : 0) |
+                        (by + 1 <= y1 ? c_row_lanes[1] : 0);
+                    const Float8 sample_y = Broadcast8(static_cast<f32>(by) + 0.5f) + lane_y;
+                    const Float8 row_offset_y = sample_y - origin_y;
+                    const i32 first_bx = std::max(hiz_x, x0 & ~3);
+                    Int32x8 edge_values[3];
+                    edges.BlockAt(edge_origins, first_bx - hiz_x, by - hiz_y, edge_values);
+
+                    for (i32 bx = first_bx; bx <= block_x1; bx += 4)
+                    {
+                        u32 rect_mask = 0;
+                        for (i32 column = std::max(x0 - bx, 0); column <= std::min(x1 - bx, 3);
+                            ++column)
+                        {
+                            rect_mask |= c_column_lanes[column];
+                        }
+
+                        u32 coverage = EdgeFunctions8::Inside(edge_values) & rect_mask &
+                            row_mask;
+                        edges.StepBlock(edge_values);
+                        if (coverage == 0)
+                        {
+                            continue;
+                        }
+
+                        // Lanes outside the triangle are helper lanes interpolated at their
+                        // own pixel, which keeps the quad derivatives of packet shaders valid.
+                        const Float8 sample_x = Broadcast8(static_cast<f32>(bx) + 0.5f) + lane_x;
+                        const Float8 offset_x = sample_x - origin_x;
+                        const Float8 offset_y = row_offset_y;
+
+                        // Early-Z: NDC depth is affine in screen space, so it interpolates
+                        // without perspective correction.
+                        if constexpr (DepthTest || DepthWrite)
+                        {
+                            const Float8 depth = EvaluatePlane8(triangle.z, offset_x, offset_y);
+                            f32* stored = depth_target->GetQuadBlock(static_cast<u32>(bx),
+                                static_cast<u32>(by));
+                            if (DepthTest && test_pixels)
+                            {
+                                coverage &= LessMask(depth, Load8(stored));
+                                if (coverage == 0)
+                                {
+                                    continue;
+                                }
+                            }
+                            if constexpr (DepthWrite)
+                            {
+                                Store8(lanes, depth);
+                                for (u32 lane = 0; lane < c_simd_lanes; ++lane)
+                                {
+                                    if (coverage & (1u << lane))
+                                    {
+                                        stored[lane] = lanes[lane];
+                                    }
+                                }
+                                block_written = true;
+                            }
+                        }
+
+                        // Varyings are stored divided by w, so interpolating them and
+                        // multiplying by the interpolated w is perspective correct. Clamping
+                        // 1 / w to the triangle's minimum keeps helper lanes finite.
+                        const Float8 w = Broadcast8(1.0f) / Max8(EvaluatePlane8(triangle.inv_w,
+                            offset_x, offset_y), Broadcast8(triangle.min_inv_w));
+                        for (u32 i = 0; i < varying_count; ++i)
+                        {
+                            StoreFragmentInput<width>(fs_input, destinations[i],
+                                fs_input_floats, EvaluatePlane8(varyings[i], offset_x,
+                                offset_y) * w);
+                        }
+
+                        const u32 quad_x[2] = {static_cast<u32>(bx), static_cast<u32>(bx) + 2};
+                        const u32 quad_y[2] = {static_cast<u32>(by), static_cast<u32>(by)};
+                        ShadeFragments<TargetCount, FragmentStage>(context, coverage, quad_x,
+                            quad_y, scratch, uniforms);
+                    }
+                }
+
+                if (DepthWrite && block_written)
+                {
+                    depth_target->RefreshBlock(hiz_block_x, hiz_block_y);
+                    wrote_depth = true;
+                }
+            }
+        }
+        return wrote_depth;
+    }
+
+    // Offsets of the lanes of a 4x2 block from its first pixel in a MultisampleTarget plane.
+    inline constexpr u32 c_lane_sample_pixels[c_simd_lanes] = {0, 1, c_msaa_block_size,
+        c_msaa_block_size + 1, 2, 3, c_msaa_block_size + 2, c_msaa_block_size + 3};
+
+    /**
+     * @brief The raster kernel of a multisampled permutation, writing the context's
+     * multisample targets and a depth target with c_msaa_samples samples. Coverage and depth
+     * are per sample; the fragment shader runs once per pixel, at its center, and its color
+     * goes to the pixel's covered samples. HiZ blocks the triangle covers entirely, with no
+     * sample failing the depth test, are written compressed.
+     */
+    template <bool DepthTest, bool DepthWrite, typename FragmentStage>
+    bool RasterizeTriangleMultisample(const RasterContext& context,
+        const TriangleSetup& triangle, i32 tile_x0, i32 tile_y0, i32 tile_x1, i32 tile_y1,
+        RasterScratch& scratch, const void* uniforms)
+    {
+        const i32 x0 = std::max(triangle.min_x, tile_x0);
+        const i32 x1 = std::min(triangle.max_x, tile_x1);
+        const i32 y0 = std::max(triangle.min_y, tile_y0);
+        const i32 y1 = std::min(triangle.max_y, tile_y1);
+        if (x0 > x1 || y0 > y1)
+        {
+            return false;
+        }
+
+        constexpr u32 width = FragmentStage::c_width;
+        const u32 varying_count = context.varying_count;
+        const PlaneEquation* varyings = triangle.GetVaryings();
+        const u32* destinations = context.varying_destinations;
+        const u32 fs_input_floats = context.fs_input_floats;
+        f32* fs_input = scratch.fs_input;
+        DepthTarget* depth_target = context.depth;
+        MultisampleTarget* const* targets = context.multisample_targets;
+        const u32 target_count = context.target_count;
+
+        const EdgeFunctions8 edges(triangle);
+        const Float8 origin_x = Broadcast8(FixedToPixels(triangle.x[0]));
+        const Float8 origin_y = Broadcast8(FixedToPixels(triangle.y[0]));
+        const Float8 lane_x = Load8(c_lane_x);
+        const Float8 lane_y = Load8(c_lane_y);
+        // Sample positions in fixed point, and the depth at each sample relative to the center.
+        constexpr i32 c_sample_scale = c_subpixel_scale / 16;
+        f32 depth_offsets[c_msaa_samples];
+        for (u32 s = 0; s < c_msaa_samples; ++s)
+        {
+            depth_offsets[s] = (triangle.z.dx * static_cast<f32>(c_msaa_sample_x[s]) +
+                triangle.z.dy * static_cast<f32>(c_msaa_sample_y[s])) / 16.0f;
+        }
+
+        alignas(32) f32 lanes[c_simd_lanes];
+        bool wrote_depth = false;
+
+        constexpr i32 c_block = static_cast<i32>(c_hiz_block_size);
+        for (i32 hiz_y = y0 & ~(c_block - 1); hiz_y <= y1; hiz_y += c_block)
+        {
+            for (i32 hiz_x = x0 & ~(c_block - 1); hiz_x <= x1; hiz_x += c_block)
+            {
+                const u32 hiz_block_x = static_cast<u32>(hiz_x) / c_hiz_block_size;
+                const u32 hiz_block_y = static_cast<u32>(hiz_y) / c_hiz_block_size;
+                bool test_pixels = DepthTest;
+                if constexpr (DepthTest)
+                {
+                    const DepthRange& range =
+                        depth_target->GetBlockRange(hiz_block_x, hiz_block_y);
+                    if (triangle.min_z >= range.max)
+                    {
+                        ++scratch.hiz_blocks_rejected;
+                        continue;
+                    }
+                    test_pixels = triangle.max_z >= range.min;
+                }
+                i32 edge_origins[c_msaa_samples][3];
+                bool excluded = true;
+                bool covered = true;
+                for (u32 s = 0; s < c_msaa_samples; ++s)
+                {
+                    edges.SetupSquare(hiz_x, hiz_y, edge_origins[s],
+                        c_msaa_sample_x[s] * c_sample_scale, c_msaa_sample_y[s] * c_sample_scale);
+                    excluded = excluded && edges.ExcludesSquare(edge_origins[s], c_block);
+                    covered = covered && edges.CoversSquare(edge_origins[s], c_block);
+                }
+                if (excluded)
+                {
+                    continue;
+                }
+
+                const i32 block_x1 = std::min(hiz_x + c_block - 1, x1);
+                const i32 block_y1 = std::min(hiz_y + c_block - 1, y1);
+                // Every sample of the block may get this triangle's color: store it once. A
+                // sample failing the depth test decompresses the block from there on, which
+                // is exact as long as the samples were equal before this triangle.
+                bool compress = covered && hiz_x >= x0 && hiz_y >= y0 &&
+                    block_x1 == hiz_x + c_block - 1 && block_y1 == hiz_y + c_block - 1;
+                bool colors_prepared = false;
+                bool block_written = false;
+                for (i32 by = std::max(hiz_y, y0 & ~1); by <= block_y1; by += 2)
+                {
+                    const u32 row_mask = (by >= y0 ? c_row_lanes[0] : 0) |
+                        (by + 1 <= y1 ? c_row_lanes[1] : 0);
+                    const Float8 sample_y = Broadcast8(static_cast<f32>(by) + 0.5f) + lane_y;
+                    const Float8 row_offset_y = sample_y - origin_y;
+                    const i32 first_bx = std::max(hiz_x, x0 & ~3);
+                    Int32x8 edge_values[c_msaa_samples][3];
+                    for (u32 s = 0; s < c_msaa_samples; ++s)
+                    {
+                        edges.BlockAt(edge_origins[s], first_bx - hiz_x, by - hiz_y,
+                            edge_values[s]);
+                    }
+
+                    for (i32 bx = first_bx; bx <= block_x1; bx += 4)
+                    {
+                        u32 rect_mask = 0;
+                        for (i32 column = std::max(x0 - bx, 0); column <= std::min(x1 - bx, 3);
+                            ++column)
+                        {
+                            rect_mask |= c_column_lanes[column];
+                        }
+
+                        u32 sample_coverage[c_msaa_samples];
+                        u32 coverage = 0;
+                        for (u32 s = 0; s < c_msaa_samples; ++s)
+                        {
+                            sample_coverage[s] = EdgeFunctions8::Inside(edge_values[s]) &
+                                rect_mask & row_mask;
+                            coverage |= sample_coverage[s];
+                            edges.StepBlock(edge_values[s]);
+                        }
+                        if (coverage == 0)
+                        {
+                            continue;
+                        }
+
+                        const Float8 sample_x = Broadcast8(static_cast<f32>(bx) + 0.5f) + lane_x;
+                        const Float8 offset_x = sample_x - origin_x;
+                        const Float8 offset_y = row_offset_y;
+
+                        if constexpr (DepthTest || DepthWrite)
+                        {
+                            const Float8 depth = EvaluatePlane8(triangle.z, offset_x, offset_y);
+                            coverage = 0;
+                            for (u32 s = 0; s < c_msaa_samples; ++s)
+                            {
+                                if (sample_coverage[s] == 0)
+                                {
+                                    continue;
+                                }
+                                const Float8 sample_depth = depth + Broadcast8(depth_offsets[s]);
+                                f32* stored = depth_target->GetQuadBlock(static_cast<u32>(bx),
+                                    static_cast<u32>(by), s);
+                                if (DepthTest && test_pixels)
+                                {
+                                    sample_coverage[s] &= LessMask(sample_depth, Load8(stored));
+                                }
+                                if constexpr (DepthWrite)
+                                {
+                                    Store8(lanes, sample_depth);
+                                    for (u32 lane = 0; lane < c_simd_lanes; ++lane)
+                                    {
+                                        if (sample_coverage[s] & (1u << lane))
+                                        {
+                                            stored[lane] = lanes[lane];
+                                        }
+                                    }
+                                }
+                                coverage |= sample_coverage[s];
+                            }
+                            if (coverage == 0)
+                            {
+                                continue;
+                            }
+                            block_written = DepthWrite;
+                        }
+
+                        // Interpolated at the pixel centers, even where only some samples are
+                        // inside: the same helper lane extrapolation as RasterizeTriangle.
+                        const Float8 w = Broadcast8(1.0f) / Max8(EvaluatePlane8(triangle.inv_w,
+                            offset_x, offset_y), Broadcast8(triangle.min_inv_w));
+                        for (u32 i = 0; i < varying_count; ++i)
+                        {
+                            StoreFragmentInput<width>(fs_input, destinations[i],
+                                fs_input_floats, EvaluatePlane8(varyings[i], offset_x,
+                                offset_y) * w);
+                        }
+
+                        bool all_samples = true;
+                        for (u32 s = 0; s < c_msaa_samples; ++s)
+                        {
+                            all_samples = all_samples && sample_coverage[s] == c_all_lanes;
+                        }
+                        if (!colors_prepared || (compress && !all_samples))
+                        {
+                            for (u32 t = 0; t < target_count && !colors_prepared; ++t)
+                            {
+                                compress = compress && (!test_pixels ||
+                                    targets[t]->IsCompressed(hiz_block_x, hiz_block_y));
+                            }
+                            compress = compress && all_samples;
+                            for (u32 t = 0; t < target_count; ++t)
+                            {
+                                if (compress)
+                                {
+                                    targets[t]->SetCompressed(hiz_block_x, hiz_block_y);
+                                }
+                                else
+                                {
+                                    targets[t]->Decompress(hiz_block_x, hiz_block_y);
+                                }
+                            }
+                            colors_prepared = true;
+                        }
+                        const u32 first_pixel = static_cast<u32>(by - hiz_y) *
+                            c_msaa_block_size + static_cast<u32>(bx - hiz_x);
+                        ShadeFragmentColors<0, FragmentStage>(context, coverage, scratch,
+                            uniforms, [&](u32 t, const u32* colors)
+                            {
+                                u32* samples =
+                                    targets[t]->GetBlockSamples(hiz_block_x, hiz_block_y) +
+                                    first_pixel;
+                                for (u32 lane = 0; lane < c_simd_lanes; ++lane)
+                                {
+                                    const u32 pixel = c_lane_sample_pixels[lane];
+                                    if (compress)
+                                    {
+                                        samples[pixel] = colors[lane];
+                                        continue;
+                                    }
+                                    for (u32 s = 0; s < c_msaa_samples; ++s)
+                                    {
+                                        if (sample_coverage[s] & (1u << lane))
+                                        {
+                                            samples[s * c_msaa_block_pixels + pixel] =
+                                                colors[lane];
+                                        }
+                                    }
+                                }
+                            });
+                    }
+                }
+
+                if (DepthWrite && block_written)
+                {
+                    depth_target->RefreshBlock(hiz_block_x, hiz_block_y);
+                    wrote_depth = true;
+                }
+            }
+        }
+        return wrote_depth;
+    }
+
+    /**
+     * @brief Evaluates plane a in the lanes of a block's first quad and plane b in those of
+     * its second, at offsets (x, y) from the vertex 0 of the respective triangle.
+     */
+    inline Float8 EvaluateQuadPlanes8(const PlaneEquation& a, const PlaneEquation& b, Float8 x,
+        Float8 y)
+    {
+        return MulAdd8(BroadcastQuads8(a.dx, b.dx), x, MulAdd8(BroadcastQuads8(a.dy, b.dy), y,
+            BroadcastQuads8(a.origin, b.origin)));
+    }
+
+    /**
+     * @brief A covered 2x2 quad of a micro triangle, at pixel (x, y), waiting for a block.
+     */
+    struct MicroQuad
+    {
+        const TriangleSetup* triangle;
+        u32 x;
+        u32 y;
+        u32 coverage;
+    };
+
+    /**
+     * @brief Depth tests and shades one or two quads as the two halves of a block, each
+     * interpolated with the planes of its own triangle.
+     * @return true if depths were written.
+     */
+    template <bool DepthTest, bool DepthWrite, u32 TargetCount, typename FragmentStage>
+    bool ShadeMicroQuads(const RasterContext& context, const MicroQuad* quads, u32 quad_count,
+        RasterScratch& scratch, const void* uniforms)
+    {
+        // Without a second quad the first one fills both halves, the second one uncovered.
+        const MicroQuad& a = quads[0];
+        const MicroQuad& b = quads[quad_count - 1];
+        const TriangleSetup& triangle_a = *a.triangle;
+        const TriangleSetup& triangle_b = *b.triangle;
+        u32 coverage = a.coverage | (quad_count > 1 ? b.coverage << 4 : 0);
+
+        // c_lane_x places the second quad two pixels right of the first; undo that. The sample
+        // positions are exact, so the lanes interpolate as in RasterizeTriangle.
+        const Float8 sample_x = BroadcastQuads8(static_cast<f32>(a.x) + 0.5f,
+            static_cast<f32>(static_cast<i32>(b.x) - 2) + 0.5f) + Load8(c_lane_x);
+        const Float8 sample_y = BroadcastQuads8(static_cast<f32>(a.y) + 0.5f,
+            static_cast<f32>(b.y) + 0.5f) + Load8(c_lane_y);
+        const Float8 offset_x = sample_x - BroadcastQuads8(FixedToPixels(triangle_a.x[0]),
+            FixedToPixels(triangle_b.x[0]));
+        const Float8 offset_y = sample_y - BroadcastQuads8(FixedToPixels(triangle_a.y[0]),
+            FixedToPixels(triangle_b.y[0]));
+
+        bool wrote_depth = false;
+        if constexpr (DepthTest || DepthWrite)
+        {
+            DepthTarget* depth_target = context.depth;
+            const Float8 depth = EvaluateQuadPlanes8(triangle_a.z, triangle_b.z, offset_x,
+                offset_y);
+            f32* stored[2] = {depth_target->GetQuadBlock(a.x, a.y),
+                depth_target->GetQuadBlock(b.x, b.y)};
+            alignas(32) f32 lanes[c_simd_lanes];
+            if constexpr (DepthTest)
+            {
+                std::copy_n(stored[0], 4, lanes);
+                std::copy_n(stored[1], 4, lanes + 4);
+                coverage &= LessMask(depth, Load8(lanes));
+                if (coverage == 0)
+                {
+                    return false;
+                }
+            }
+            if constexpr (DepthWrite)
+            {
+                Store8(lanes, depth);
+                for (u32 lane = 0; lane < c_simd_lanes; ++lane)
+                {
+                    if (coverage & (1u << lane))
+                    {
+                        stored[lane >> 2][lane & 3] = lanes[lane];
+                    }
+                }
+                for (u32 q = 0; q < quad_count; ++q)
+                {
+                    if ((coverage >> (4 * q)) & 0xF)
+                    {
+                        depth_target->RefreshBlock(quads[q].x / c_hiz_block_size,
+                            quads[q].y / c_hiz_block_size);
+                        wrote_depth = true;
+                    }
+                }
+            }
+        }
+
+        constexpr u32 width = FragmentStage::c_width;
+        const PlaneEquation* varyings_a = triangle_a.GetVaryings();
+        const PlaneEquation* varyings_b = triangle_b.GetVaryings();
+        const Float8 w = Broadcast8(1.0f) / Max8(EvaluateQuadPlanes8(triangle_a.inv_w,
+            triangle_b.inv_w, offset_x, offset_y),
+            BroadcastQuads8(triangle_a.min_inv_w, triangle_b.min_inv_w));
+        for (u32 i = 0; i < context.varying_count; ++i)
+        {
+            StoreFragmentInput<width>(scratch.fs_input, context.varying_destinations[i],
+                context.fs_input_floats, EvaluateQuadPlanes8(varyings_a[i], varyings_b[i],
+                offset_x, offset_y) * w);
+        }
+
+        const u32 quad_x[2] = {a.x, b.x};
+        const u32 quad_y[2] = {a.y, b.y};
+        ShadeFragments<TargetCount, FragmentStage>(context, coverage, quad_x, quad_y, scratch,
+            uniforms);
+        return wrote_depth;
+    }
+
+    /**
+     * @brief The micro triangle kernel of one permutation. Skips the traversal of
+     * RasterizeTriangle: the coverage of a triangle's stamp is two blocks evaluated directly,
+     * and its covered quads are queued so the next micro triangle fills the other half of the
+     * block. Quads only wait for one that would read depths they write.
+     */
+    template <bool DepthTest, bool DepthWrite, u32 TargetCount, typename FragmentStage>
+    bool RasterizeMicroTriangles(const RasterContext& context,
+        const TriangleSetup* const* triangles, u32 triangle_count, i32 tile_x0, i32 tile_y0,
+        i32 tile_x1, i32 tile_y1, RasterScratch& scratch, const void* uniforms)
+    {
+        MicroQuad pending[2];
+        u32 pending_count = 0;
+        bool wrote_depth = false;
+
+        for (u32 t = 0; t < triangle_count; ++t)
+        {
+            const TriangleSetup& triangle = *triangles[t];
+            const i32 x0 = std::max(triangle.min_x, tile_x0);
+            const i32 x1 = std::min(triangle.max_x, tile_x1);
+            const i32 y0 = std::max(triangle.min_y, tile_y0);
+            const i32 y1 = std::min(triangle.max_y, tile_y1);
+            if (x0 > x1 || y0 > y1)
+            {
+                continue;
+            }
+
+            // The stamp lies inside one HiZ block. Pending quads may not be in its range yet,
+            // which only makes the test more conservative; their pixels are tested exactly.
+            if constexpr (DepthTest)
+            {
+                const DepthRange& range = context.depth->GetBlockRange(
+                    static_cast<u32>(x0) / c_hiz_block_size,
+                    static_cast<u32>(y0) / c_hiz_block_size);
+                if (triangle.min_z >= range.max)
+                {
+                    ++scratch.hiz_blocks_rejected;
+                    continue;
+                }
+            }
+
+            const EdgeFunctions8 edges(triangle);
+            const i32 stamp_x = x0 & ~3;
+            const i32 stamp_y = y0 & ~3;
+            i32 edge_origins[3];
+            edges.SetupSquare(stamp_x, stamp_y, edge_origins);
+            u32 rect_mask = 0;
+            for (i32 column = x0 - stamp_x; column <= x1 - stamp_x; ++column)
+            {
+                rect_mask |= c_column_lanes[column];
+            }
+
+            for (i32 by = y0 & ~1; by <= y1; by += 2)
+            {
+                const u32 row_mask = (by >= y0 ? c_row_lanes[0] : 0) |
+                    (by + 1 <= y1 ? c_row_lanes[1] : 0);
+                Int32x8 edge_values[3];
+                edges.BlockAt(edge_origins, 0, by - stamp_y, edge_values);
+                const u32 coverage = EdgeFunctions8::Inside(edge_values) & rect_mask & row_mask;
+                for (u32 q = 0; q < 2; ++q)
+                {
+                    const u32 quad_coverage = (coverage >> (4 * q)) & 0xF;
+                    if (quad_coverage == 0)
+                    {
+                        continue;
+                    }
+                    const MicroQuad quad = {&triangle, static_cast<u32>(stamp_x) + 2 * q,
+                        static_cast<u32>(by), quad_coverage};
+                    // Both halves test against the depths before the block, so they must not
+                    // share pixels when depths are tested and written.
+                    const bool overlaps = DepthTest && DepthWrite && pending_count == 1 &&
+                        pending[0].x == quad.x && pending[0].y == quad.y;
+                    if (pending_count == 2 || overlaps)
+                    {
+                        wrote_depth |= ShadeMicroQuads<DepthTest, DepthWrite, TargetCount,
+                            FragmentStage>(context, pending, pending_count, scratch, uniforms);
+                        pending_count = 0;
+                    }
+                    pending[pending_count++] = quad;
+                }
+            }
+        }
+
+        if (pending_count > 0)
+        {
+            wrote_depth |= ShadeMicroQuads<DepthTest, DepthWrite, TargetCount, FragmentStage>(
+                context, pending, pending_count, scratch, uniforms);
+        }
+        return wrote_depth;
+    }
+
+    // Both kernels of a permutation.
+    template <bool DepthTest, bool DepthWrite, u32 TargetCount, typename FragmentStage>
+    inline constexpr RasterKernels c_raster_kernels = {
+        RasterizeTriangle<DepthTest, DepthWrite, TargetCount, FragmentStage>,
+        RasterizeMicroTriangles<DepthTest, DepthWrite, TargetCount, FragmentStage>};
+
+    /**
+     * @brief Picks the kernels of a permutation for one fragment stage; a single render target
+     * gets its own instantiation, more are looped over. Multisampled ones always loop.
+     */
+    template <typename FragmentStage>
+    RasterKernels SelectRasterizer(const RasterPermutation& permutation)
+    {
+        if (permutation.fs_width != FragmentStage::c_width)
+        {
+            return {};
+        }
+        static constexpr RasterKernels s_kernels[2][2][2] = {
+            {
+                {c_raster_kernels<false, false, 0, FragmentStage>,
+                    c_raster_kernels<false, false, 1, FragmentStage>},
+                {c_raster_kernels<false, true, 0, FragmentStage>,
+                    c_raster_kernels<false, true, 1, FragmentStage>},
+            },
+            {
+                {c_raster_kernels<true, false, 0, FragmentStage>,
+                    c_raster_kernels<true, false, 1, FragmentStage>},
+                {c_raster_kernels<true, true, 0, FragmentStage>,
+                    c_raster_kernels<true, true, 1, FragmentStage>},
+            },
+        };
+        static constexpr RasterKernels s_multisample_kernels[2][2] = {
+            {
+                {RasterizeTriangleMultisample<false, false, FragmentStage>, nullptr},
+                {RasterizeTriangleMultisample<false, true, FragmentStage>, nullptr},
+            },
+            {
+                {RasterizeTriangleMultisample<true, false, FragmentStage>, nullptr},
+                {RasterizeTriangleMultisample<true, true, FragmentStage>, nullptr},
+            },
+        };
+        if (permutation.multisample)
+        {
+            return s_multisample_kernels[permutation.depth_test][permutation.depth_write];
+        }
+        return s_kernels[permutation.depth_test][permutation.depth_write]
+            [permutation.target_count == 1];
+    }
+
+    /**
+     * @brief Selector for Pipeline::Configure running FragmentShader inlined, see
+     * InlineFragmentStage. The FragmentShaderAPI passed along must describe the same shader.
+     */
+    template <typename FragmentShader>
+    RasterKernels SelectInlineRasterizer(const RasterPermutation& permutation)
+    {
+        return SelectRasterizer<InlineFragmentStage<FragmentShader>>(permutation);
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,63 @@
+#pragma once
+#include "Core.h"
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief 32-bit BGRA8 color buffer (0xAARRGGBB as a u32), either owning its pixels or
+     * wrapping memory provided by someone else, e.g. a window framebuffer.
+     */
+    class RenderTarget
+    {
+    public:
+        RenderTarget(u32 width, u32 height);
+        /**
+         * @param pitch Distance between rows in pixels.
+         */
+        RenderTarget(u32* pixels, u32 width, u32 height, u32 pitch);
+
+        u32 GetWidth() const { return m_width; }
+        u32 GetHeight() const { return m_height; }
+        u32 GetPitch() const { return m_pitch; }
+
+        u32* GetData() { return m_pixels; }
+        const u32* GetData() const { return m_pixels; }
+        u32* GetRow(u32 y) { return m_pixels + static_cast<size_t>(y) * m_pitch; }
+
+        /**
+         * @brief Points a wrapping target at other memory of the same layout, e.g. the next
+         * swapchain buffer. Only valid while no draw into the target is in flight.
+         */
+        void SetData(u32* pixels) { m_pixels = pixels; }
+
+        void Clear(u32 color);
+
+        /**
+         * @brief Sets the pixels of a rectangle inside the target to the color.
+         */
+        void ClearRect(u32 x, u32 y, u32 width, u32 height, u32 color);
+
+    private:
+        std::vector<u32> m_storage {};
+        u32* m_pixels {nullptr};
+        u32 m_width {0};
+        u32 m_height {0};
+        u32 m_pitch {0};
+    };
+
+    /**
+     * @brief Packs a linear [0, 1] RGBA color into the BGRA8 layout used by RenderTarget.
+     */
+    inline u32 PackColor(const f32* rgba)
+    {
+        auto to_byte = [](f32 value) -> u32
+        {
+            value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+            return static_cast<u32>(value * 255.0f + 0.5f);
+        };
+        return (to_byte(rgba[3]) << 24) | (to_byte(rgba[0]) << 16) | (to_byte(rgba[1]) << 8) |
+            to_byte(rgba[2]);
+    }
+
+} // namespace Rasterizer
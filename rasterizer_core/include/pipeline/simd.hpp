@@ -0,0 +1,628 @@
+#pragma once
+#include "Core.h"
+#include "pipeline/render_target.hpp"
+
+#if defined(RASTERIZER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(RASTERIZER_SIMD_SSE41)
+#include <smmintrin.h>
+#else
+#include <cmath>
+#endif
+
+namespace Rasterizer
+{
+
+    /*
+     * Eight f32 lanes, the rasterizer's unit of work: a 4x2 pixel block made of two 2x2 quads.
+     * One AVX2 register, two SSE4.1 registers, or a plain array when built without SIMD.
+     */
+    constexpr u32 c_simd_lanes = 8;
+
+#if defined(RASTERIZER_SIMD_AVX2)
+
+    struct Float8
+    {
+        __m256 v;
+    };
+
+    inline Float8 Broadcast8(f32 value) { return {_mm256_set1_ps(value)}; }
+    // quad0 in the lanes of the block's first 2x2 quad, quad1 in those of the second.
+    inline Float8 BroadcastQuads8(f32 quad0, f32 quad1)
+    {
+        return {_mm256_set_m128(_mm_set1_ps(quad1), _mm_set1_ps(quad0))};
+    }
+    inline Float8 Load8(const f32* values) { return {_mm256_loadu_ps(values)}; }
+    inline void Store8(f32* values, Float8 a) { _mm256_storeu_ps(values, a.v); }
+    inline Float8 operator+(Float8 a, Float8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+    inline Float8 operator-(Float8 a, Float8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    inline Float8 operator*(Float8 a, Float8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+    inline Float8 operator/(Float8 a, Float8 b) { return {_mm256_div_ps(a.v, b.v)}; }
+    inline Float8 Max8(Float8 a, Float8 b) { return {_mm256_max_ps(a.v, b.v)}; }
+    inline Float8 Min8(Float8 a, Float8 b) { return {_mm256_min_ps(a.v, b.v)}; }
+    inline Float8 Sqrt8(Float8 a) { return {_mm256_sqrt_ps(a.v)}; }
+    // a * b + c, fused where the instruction set has it.
+    inline Float8 MulAdd8(Float8 a, Float8 b, Float8 c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+
+    /**
+     * @brief Eight i32 lanes, laid out like Float8; the raster kernels' edge functions.
+     */
+    struct Int32x8
+    {
+        __m256i v;
+    };
+
+    inline Int32x8 BroadcastInt32x8(i32 value) { return {_mm256_set1_epi32(value)}; }
+    inline Int32x8 operator+(Int32x8 a, Int32x8 b) { return {_mm256_add_epi32(a.v, b.v)}; }
+
+    /**
+     * @brief The lanes of a 4x2 block, two 2x2 quads side by side, at step_x per pixel
+     * column and step_y per pixel row from the first.
+     */
+    inline Int32x8 BlockSteps8(i32 step_x, i32 step_y)
+    {
+        const __m256i column = _mm256_setr_epi32(0, 1, 0, 1, 2, 3, 2, 3);
+        const __m256i row = _mm256_setr_epi32(0, 0, 1, 1, 0, 0, 1, 1);
+        return {_mm256_add_epi32(_mm256_mullo_epi32(column, _mm256_set1_epi32(step_x)),
+            _mm256_mullo_epi32(row, _mm256_set1_epi32(step_y)))};
+    }
+
+    /**
+     * @brief Bit l is set when all three values are >= 0 in lane l.
+     */
+    inline u32 NonNegativeMask(Int32x8 a, Int32x8 b, Int32x8 c)
+    {
+        // A lane is negative in any of them if the sign bit of their OR is set.
+        const __m256i any = _mm256_or_si256(_mm256_or_si256(a.v, b.v), c.v);
+        return ~static_cast<u32>(_mm256_movemask_ps(_mm256_castsi256_ps(any))) & 0xFF;
+    }
+
+    /**
+     * @brief Bit l is set when a < b in lane l.
+     */
+    inline u32 LessMask(Float8 a, Float8 b)
+    {
+        return static_cast<u32>(_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)));
+    }
+
+    /**
+     * @brief PackColor() for eight lanes of SoA RGBA.
+     */
+    inline void PackColors8(const f32* r, const f32* g, const f32* b, const f32* a, u32* out)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 scale = _mm256_set1_ps(255.0f);
+        const __m256 half = _mm256_set1_ps(0.5f);
+        auto to_byte = [&](const f32* values)
+        {
+            const __m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(values), zero), one);
+            return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, scale), half));
+        };
+        const __m256i color = _mm256_or_si256(
+            _mm256_or_si256(_mm256_slli_epi32(to_byte(a), 24), _mm256_slli_epi32(to_byte(r), 16)),
+            _mm256_or_si256(_mm256_slli_epi32(to_byte(g), 8), to_byte(b)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), color);
+    }
+
+    /**
+     * @brief The inverse of PackColors8(): eight colors to [0, 1] SoA RGBA.
+     */
+    inline void UnpackColors8(const u32* colors, f32* r, f32* g, f32* b, f32* a)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(colors));
+        const __m256i byte = _mm256_set1_epi32(0xFF);
+        const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+        auto to_float = [&](__m256i shifted)
+        {
+            return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(shifted, byte)), scale);
+        };
+        _mm256_storeu_ps(r, to_float(_mm256_srli_epi32(v, 16)));
+        _mm256_storeu_ps(g, to_float(_mm256_srli_epi32(v, 8)));
+        _mm256_storeu_ps(b, to_float(v));
+        _mm256_storeu_ps(a, to_float(_mm256_srli_epi32(v, 24)));
+    }
+
+    /**
+     * @brief The rounded per-channel average of eight colors from each of four arrays, e.g.
+     * the samples of a row of pixels.
+     */
+    inline void AverageColors8(const u32* a, const u32* b, const u32* c, const u32* d, u32* out)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i round = _mm256_set1_epi16(2);
+        __m256i low = round;
+        __m256i high = round;
+        const u32* const sources[4] = {a, b, c, d};
+        for (const u32* colors : sources)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(colors));
+            low = _mm256_add_epi16(low, _mm256_unpacklo_epi8(v, zero));
+            high = _mm256_add_epi16(high, _mm256_unpackhi_epi8(v, zero));
+        }
+        // Unpacking and packing both work within 128-bit halves, so the lanes stay in order.
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_packus_epi16(
+            _mm256_srli_epi16(low, 2), _mm256_srli_epi16(high, 2)));
+    }
+
+    /**
+     * @brief Stores the colors of the lanes whose bit is set in mask, keeping the others.
+     */
+    inline void StoreColors8(u32* out, const u32* colors, u32 mask)
+    {
+        const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        const __m256i lanes = _mm256_cmpeq_epi32(
+            _mm256_and_si256(_mm256_set1_epi32(static_cast<i32>(mask)), bits), bits);
+        __m256i* destination = reinterpret_cast<__m256i*>(out);
+        _mm256_storeu_si256(destination, _mm256_blendv_epi8(_mm256_loadu_si256(destination),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(colors)), lanes));
+    }
+
+    /**
+     * @brief Reorders eight pixels of two rows into the two 4x2 blocks they form, in lane
+     * order (see c_lane_x), and back.
+     */
+    inline void RowsToQuadBlocks8(const u32* row0, const u32* row1, u32* blocks)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1));
+        // Pixel pairs are 64-bit lanes: interleave the pairs of the two rows per block.
+        constexpr i32 c_pairs = _MM_SHUFFLE(3, 1, 2, 0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(blocks),
+            _mm256_permute4x64_epi64(_mm256_permute2x128_si256(a, b, 0x20), c_pairs));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(blocks + c_simd_lanes),
+            _mm256_permute4x64_epi64(_mm256_permute2x128_si256(a, b, 0x31), c_pairs));
+    }
+    inline void QuadBlocksToRows8(const u32* blocks, u32* row0, u32* row1)
+    {
+        constexpr i32 c_pairs = _MM_SHUFFLE(3, 1, 2, 0);
+        const __m256i a = _mm256_permute4x64_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks)), c_pairs);
+        const __m256i b = _mm256_permute4x64_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks + c_simd_lanes)), c_pairs);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row0),
+            _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row1),
+            _mm256_permute2x128_si256(a, b, 0x31));
+    }
+
+#elif defined(RASTERIZER_SIMD_SSE41)
+
+    struct Float8
+    {
+        __m128 lo;
+        __m128 hi;
+    };
+
+    inline Float8 Broadcast8(f32 value) { return {_mm_set1_ps(value), _mm_set1_ps(value)}; }
+    inline Float8 BroadcastQuads8(f32 quad0, f32 quad1)
+    {
+        return {_mm_set1_ps(quad0), _mm_set1_ps(quad1)};
+    }
+    inline Float8 Load8(const f32* values)
+    {
+        return {_mm_loadu_ps(values), _mm_loadu_ps(values + 4)};
+    }
+    inline void Store8(f32* values, Float8 a)
+    {
+        _mm_storeu_ps(values, a.lo);
+        _mm_storeu_ps(values + 4, a.hi);
+    }
+    inline Float8 operator+(Float8 a, Float8 b)
+    {
+        return {_mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi)};
+    }
+    inline Float8 operator-(Float8 a, Float8 b)
+    {
+        return {_mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi)};
+    }
+    inline Float8 operator*(Float8 a, Float8 b)
+    {
+        return {_mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi)};
+    }
+    inline Float8 operator/(Float8 a, Float8 b)
+    {
+        return {_mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi)};
+    }
+    inline Float8 Max8(Float8 a, Float8 b)
+    {
+        return {_mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi)};
+    }
+    inline Float8 Min8(Float8 a, Float8 b)
+    {
+        return {_mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi)};
+    }
+    inline Float8 Sqrt8(Float8 a)
+    {
+        return {_mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi)};
+    }
+    inline Float8 MulAdd8(Float8 a, Float8 b, Float8 c)
+    {
+        return a * b + c;
+    }
+
+    struct Int32x8
+    {
+        __m128i lo;
+        __m128i hi;
+    };
+
+    inline Int32x8 BroadcastInt32x8(i32 value)
+    {
+        return {_mm_set1_epi32(value), _mm_set1_epi32(value)};
+    }
+    inline Int32x8 operator+(Int32x8 a, Int32x8 b)
+    {
+        return {_mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi)};
+    }
+    inline Int32x8 BlockSteps8(i32 step_x, i32 step_y)
+    {
+        // Both quads step alike, the second one starts two columns further.
+        const __m128i quad = _mm_add_epi32(
+            _mm_mullo_epi32(_mm_setr_epi32(0, 1, 0, 1), _mm_set1_epi32(step_x)),
+            _mm_mullo_epi32(_mm_setr_epi32(0, 0, 1, 1), _mm_set1_epi32(step_y)));
+        return {quad, _mm_add_epi32(quad, _mm_set1_epi32(2 * step_x))};
+    }
+
+    /**
+     * @brief Bit l is set when all three values are >= 0 in lane l.
+     */
+    inline u32 NonNegativeMask(Int32x8 a, Int32x8 b, Int32x8 c)
+    {
+        const __m128i lo = _mm_or_si128(_mm_or_si128(a.lo, b.lo), c.lo);
+        const __m128i hi = _mm_or_si128(_mm_or_si128(a.hi, b.hi), c.hi);
+        const u32 negative = static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(lo)) |
+            (_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4));
+        return ~negative & 0xFF;
+    }
+
+    /**
+     * @brief Bit l is set when a < b in lane l.
+     */
+    inline u32 LessMask(Float8 a, Float8 b)
+    {
+        return static_cast<u32>(_mm_movemask_ps(_mm_cmplt_ps(a.lo, b.lo)) |
+            (_mm_movemask_ps(_mm_cmplt_ps(a.hi, b.hi)) << 4));
+    }
+
+    /**
+     * @brief PackColor() for eight lanes of SoA RGBA.
+     */
+    inline void PackColors8(const f32* r, const f32* g, const f32* b, const f32* a, u32* out)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        auto to_byte = [&](const f32* values)
+        {
+            const __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values), zero), one);
+            return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+        };
+        for (u32 half_index = 0; half_index < 2; ++half_index)
+        {
+            const u32 o = half_index * 4;
+            const __m128i high = _mm_or_si128(_mm_slli_epi32(to_byte(a + o), 24),
+                _mm_slli_epi32(to_byte(r + o), 16));
+            const __m128i low = _mm_or_si128(_mm_slli_epi32(to_byte(g + o), 8), to_byte(b + o));
+            const __m128i color = _mm_or_si128(high, low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), color);
+        }
+    }
+
+    /**
+     * @brief The inverse of PackColors8(): eight colors to [0, 1] SoA RGBA.
+     */
+    inline void UnpackColors8(const u32* colors, f32* r, f32* g, f32* b, f32* a)
+    {
+        const __m128i byte = _mm_set1_epi32(0xFF);
+        const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+        auto to_float = [&](__m128i shifted)
+        {
+            return _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(shifted, byte)), scale);
+        };
+        for (u32 o = 0; o < c_simd_lanes; o += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors + o));
+            _mm_storeu_ps(r + o, to_float(_mm_srli_epi32(v, 16)));
+            _mm_storeu_ps(g + o, to_float(_mm_srli_epi32(v, 8)));
+            _mm_storeu_ps(b + o, to_float(v));
+            _mm_storeu_ps(a + o, to_float(_mm_srli_epi32(v, 24)));
+        }
+    }
+
+    /**
+     * @brief The rounded per-channel average of eight colors from each of four arrays, e.g.
+     * the samples of a row of pixels.
+     */
+    inline void AverageColors8(const u32* a, const u32* b, const u32* c, const u32* d, u32* out)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const u32* const sources[4] = {a, b, c, d};
+        for (u32 o = 0; o < c_simd_lanes; o += 4)
+        {
+            __m128i low = _mm_set1_epi16(2);
+            __m128i high = low;
+            for (const u32* colors : sources)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors + o));
+                low = _mm_add_epi16(low, _mm_unpacklo_epi8(v, zero));
+                high = _mm_add_epi16(high, _mm_unpackhi_epi8(v, zero));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o),
+                _mm_packus_epi16(_mm_srli_epi16(low, 2), _mm_srli_epi16(high, 2)));
+        }
+    }
+
+    /**
+     * @brief Stores the colors of the lanes whose bit is set in mask, keeping the others.
+     */
+    inline void StoreColors8(u32* out, const u32* colors, u32 mask)
+    {
+        const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+        for (u32 o = 0; o < c_simd_lanes; o += 4)
+        {
+            const __m128i lanes = _mm_cmpeq_epi32(
+                _mm_and_si128(_mm_set1_epi32(static_cast<i32>(mask >> o)), bits), bits);
+            __m128i* destination = reinterpret_cast<__m128i*>(out + o);
+            _mm_storeu_si128(destination, _mm_blendv_epi8(_mm_loadu_si128(destination),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors + o)), lanes));
+        }
+    }
+
+    /**
+     * @brief Reorders eight pixels of two rows into the two 4x2 blocks they form, in lane
+     * order (see c_lane_x), and back.
+     */
+    inline void RowsToQuadBlocks8(const u32* row0, const u32* row1, u32* blocks)
+    {
+        for (u32 o = 0; o < c_simd_lanes; o += 4)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + o));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + o));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(blocks + 2 * o),
+                _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(blocks + 2 * o + 4),
+                _mm_unpackhi_epi64(a, b));
+        }
+    }
+    inline void QuadBlocksToRows8(const u32* blocks, u32* row0, u32* row1)
+    {
+        for (u32 o = 0; o < c_simd_lanes; o += 4)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 2 * o));
+            const __m128i b =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 2 * o + 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row0 + o), _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row1 + o), _mm_unpackhi_epi64(a, b));
+        }
+    }
+
+#else
+
+    struct Float8
+    {
+        f32 v[c_simd_lanes];
+    };
+
+    template <typename Op>
+    inline Float8 Map8(Float8 a, Float8 b, Op op)
+    {
+        Float8 result;
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            result.v[i] = op(a.v[i], b.v[i]);
+        }
+        return result;
+    }
+
+    inline Float8 Broadcast8(f32 value)
+    {
+        Float8 result;
+        for (f32& lane : result.v)
+        {
+            lane = value;
+        }
+        return result;
+    }
+    inline Float8 BroadcastQuads8(f32 quad0, f32 quad1)
+    {
+        Float8 result;
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            result.v[i] = i < c_simd_lanes / 2 ? quad0 : quad1;
+        }
+        return result;
+    }
+    inline Float8 Load8(const f32* values)
+    {
+        Float8 result;
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            result.v[i] = values[i];
+        }
+        return result;
+    }
+    inline void Store8(f32* values, Float8 a)
+    {
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            values[i] = a.v[i];
+        }
+    }
+    inline Float8 operator+(Float8 a, Float8 b)
+    {
+        return Map8(a, b, [](f32 x, f32 y) { return x + y; });
+    }
+    inline Float8 operator-(Float8 a, Float8 b)
+    {
+        return Map8(a, b, [](f32 x, f32 y) { return x - y; });
+    }
+    inline Float8 operator*(Float8 a, Float8 b)
+    {
+        return Map8(a, b, [](f32 x, f32 y) { return x * y; });
+    }
+    inline Float8 operator/(Float8 a, Float8 b)
+    {
+        return Map8(a, b, [](f32 x, f32 y) { return x / y; });
+    }
+    inline Float8 Max8(Float8 a, Float8 b)
+    {
+        return Map8(a, b, [](f32 x, f32 y) { return x > y ? x : y; });
+    }
+    inline Float8 Min8(Float8 a, Float8 b)
+    {
+        return Map8(a, b, [](f32 x, f32 y) { return x < y ? x : y; });
+    }
+    inline Float8 Sqrt8(Float8 a)
+    {
+        return Map8(a, a, [](f32 x, f32) { return std::sqrt(x); });
+    }
+    inline Float8 MulAdd8(Float8 a, Float8 b, Float8 c)
+    {
+        return a * b + c;
+    }
+
+    struct Int32x8
+    {
+        i32 v[c_simd_lanes];
+    };
+
+    inline Int32x8 BroadcastInt32x8(i32 value)
+    {
+        Int32x8 result;
+        for (i32& lane : result.v)
+        {
+            lane = value;
+        }
+        return result;
+    }
+    inline Int32x8 operator+(Int32x8 a, Int32x8 b)
+    {
+        Int32x8 result;
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            result.v[i] = a.v[i] + b.v[i];
+        }
+        return result;
+    }
+    inline Int32x8 BlockSteps8(i32 step_x, i32 step_y)
+    {
+        Int32x8 result;
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            result.v[i] = static_cast<i32>((i >> 2) * 2 + (i & 1)) * step_x +
+                static_cast<i32>((i >> 1) & 1) * step_y;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Bit l is set when all three values are >= 0 in lane l.
+     */
+    inline u32 NonNegativeMask(Int32x8 a, Int32x8 b, Int32x8 c)
+    {
+        u32 mask = 0;
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            mask |= static_cast<u32>(a.v[i] >= 0 && b.v[i] >= 0 && c.v[i] >= 0) << i;
+        }
+        return mask;
+    }
+
+    /**
+     * @brief Bit l is set when a < b in lane l.
+     */
+    inline u32 LessMask(Float8 a, Float8 b)
+    {
+        u32 mask = 0;
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            mask |= static_cast<u32>(a.v[i] < b.v[i]) << i;
+        }
+        return mask;
+    }
+
+    /**
+     * @brief PackColor() for eight lanes of SoA RGBA.
+     */
+    inline void PackColors8(const f32* r, const f32* g, const f32* b, const f32* a, u32* out)
+    {
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            const f32 rgba[4] = {r[i], g[i], b[i], a[i]};
+            out[i] = PackColor(rgba);
+        }
+    }
+
+    /**
+     * @brief The inverse of PackColors8(): eight colors to [0, 1] SoA RGBA.
+     */
+    inline void UnpackColors8(const u32* colors, f32* r, f32* g, f32* b, f32* a)
+    {
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            r[i] = static_cast<f32>((colors[i] >> 16) & 0xFF) * (1.0f / 255.0f);
+            g[i] = static_cast<f32>((colors[i] >> 8) & 0xFF) * (1.0f / 255.0f);
+            b[i] = static_cast<f32>(colors[i] & 0xFF) * (1.0f / 255.0f);
+            a[i] = static_cast<f32>(colors[i] >> 24) * (1.0f / 255.0f);
+        }
+    }
+
+    /**
+     * @brief The rounded per-channel average of eight colors from each of four arrays, e.g.
+     * the samples of a row of pixels.
+     */
+    inline void AverageColors8(const u32* a, const u32* b, const u32* c, const u32* d, u32* out)
+    {
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            u32 color = 0;
+            for (u32 shift = 0; shift < 32; shift += 8)
+            {
+                const u32 sum = ((a[i] >> shift) & 0xFF) + ((b[i] >> shift) & 0xFF) +
+                    ((c[i] >> shift) & 0xFF) + ((d[i] >> shift) & 0xFF);
+                color |= ((sum + 2) >> 2) << shift;
+            }
+            out[i] = color;
+        }
+    }
+
+    /**
+     * @brief Stores the colors of the lanes whose bit is set in mask, keeping the others.
+     */
+    inline void StoreColors8(u32* out, const u32* colors, u32 mask)
+    {
+        for (u32 i = 0; i < c_simd_lanes; ++i)
+        {
+            if (mask & (1u << i))
+            {
+                out[i] = colors[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Reorders eight pixels of two rows into the two 4x2 blocks they form, in lane
+     * order (see c_lane_x), and back.
+     */
+    inline void RowsToQuadBlocks8(const u32* row0, const u32* row1, u32* blocks)
+    {
+        for (u32 i = 0; i < 2 * c_simd_lanes; ++i)
+        {
+            const u32 x = (i >> 3) * 4 + ((i >> 2) & 1) * 2 + (i & 1);
+            blocks[i] = (i & 2) ? row1[x] : row0[x];
+        }
+    }
+    inline void QuadBlocksToRows8(const u32* blocks, u32* row0, u32* row1)
+    {
+        for (u32 i = 0; i < 2 * c_simd_lanes; ++i)
+        {
+            const u32 x = (i >> 3) * 4 + ((i >> 2) & 1) * 2 + (i & 1);
+            ((i & 2) ? row1 : row0)[x] = blocks[i];
+        }
+    }
+
+#endif
+
+} // namespace Rasterizer
@@ -0,0 +1,78 @@
+#pragma once
+#include "Core.h"
+#include "shader/shader_api.hpp"
+
+namespace Rasterizer
+{
+
+    // Texels per side of the square tiles textures are stored in: 4x4 BGRA8 texels are one
+    // 64-byte cache line.
+    constexpr u32 c_texture_tile_size = 4;
+    constexpr u32 c_texture_tile_texels = c_texture_tile_size * c_texture_tile_size;
+
+    /**
+     * @brief Where one mip level of a Texture lives in its texel storage.
+     */
+    struct TextureLevel
+    {
+        // Index of the level's first texel.
+        u32 offset;
+        u32 width;
+        u32 height;
+        // Tiles per row of the level.
+        u32 tiles_x;
+    };
+
+    /**
+     * @brief Immutable BGRA8 texture with a full mip chain, sampled by shaders through
+     * GetBinding().
+     *
+     * Every level is stored in c_texture_tile_size tiles, the tiles of a level in rows, each
+     * tile cache line aligned. The bilinear footprints of neighbouring pixels then mostly
+     * share a cache line whichever direction a triangle walks the texture, where rows would
+     * touch a new line per pixel on a vertical or diagonal walk. Levels are 2x2 box filtered
+     * down to 1x1, odd sizes rounding down.
+     */
+    class Texture
+    {
+    public:
+        /**
+         * @param texels width x height texels in rows, 0xAARRGGBB like RenderTarget pixels.
+         */
+        Texture(u32 width, u32 height, const u32* texels);
+
+        u32 GetWidth() const { return m_levels[0].width; }
+        u32 GetHeight() const { return m_levels[0].height; }
+        u32 GetLevelCount() const { return static_cast<u32>(m_levels.size()); }
+        const TextureLevel& GetLevel(u32 level) const { return m_levels[level]; }
+
+        /**
+         * @brief Texel (x, y) of a level; x and y must lie inside it.
+         */
+        u32 GetTexel(u32 level, u32 x, u32 y) const
+        {
+            return m_texels[TexelOffset(m_levels[level], x, y)];
+        }
+
+        const u32* GetTexels() const { return m_texels; }
+
+        /**
+         * @brief The uniform that gives shaders access to this texture.
+         */
+        TextureBinding GetBinding() const;
+
+        static u32 TexelOffset(const TextureLevel& level, u32 x, u32 y)
+        {
+            const u32 tile = (y / c_texture_tile_size) * level.tiles_x + x / c_texture_tile_size;
+            return level.offset + tile * c_texture_tile_texels +
+                (y % c_texture_tile_size) * c_texture_tile_size + x % c_texture_tile_size;
+        }
+
+    private:
+        std::vector<TextureLevel> m_levels {};
+        // Over-allocated by a cache line so m_texels can start on one.
+        std::vector<u32> m_storage {};
+        u32* m_texels {nullptr};
+    };
+
+} // namespace Rasterizer
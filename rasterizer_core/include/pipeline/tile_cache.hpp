@@ -0,0 +1,114 @@
+#pragma once
+#include "Core.h"
+#include "pipeline/depth_target.hpp"
+#include "pipeline/render_target.hpp"
+
+namespace Rasterizer
+{
+
+    // Pixels of one cached tile per render target.
+    constexpr u32 c_tile_cache_pixels = c_hiz_tile_size * c_hiz_tile_size;
+
+    /**
+     * @brief A worker's copy of the colors of the tile it rasterizes, one c_hiz_tile_size
+     * square per render target.
+     *
+     * Pixels are stored per c_hiz_block_size block, each one the 4x2 blocks covering it in
+     * lane order (see c_lane_x), so the colors of a raster kernel's block store as one vector
+     * and an HiZ block is four cache lines. A block is read from the render targets when it
+     * is first written and written back by Flush() once the tile is done: the targets see
+     * whole rows once per tile and draw rather than scattered pixels per fragment.
+     */
+    class TileCache
+    {
+    public:
+        /**
+         * @brief Sizes the cache for target_count render targets; drops any cached pixels.
+         */
+        void Resize(u32 target_count);
+
+        /**
+         * @brief Starts caching the tile at pixel (x0, y0), aligned to c_hiz_tile_size, of
+         * the render targets, which must match the count passed to Resize().
+         */
+        void Begin(RenderTarget* const* targets, u32 x0, u32 y0);
+
+        /**
+         * @brief Starts writing the tile at pixel (x0, y0) straight into pixels, one
+         * c_tile_cache_pixels plane per target in the cache's own layout, e.g. a GBuffer
+         * tile. Nothing is loaded and Flush() has nothing to write back.
+         */
+        void BeginInPlace(u32* pixels, u32 x0, u32 y0);
+
+        /**
+         * @brief The cached colors of target's 4x2 block containing pixel (x, y) of the tile,
+         * in lane order; reads its HiZ block from the render targets if not cached yet.
+         */
+        u32* GetQuadBlock(u32 target, u32 x, u32 y)
+        {
+            const u32 local_x = x - m_x0;
+            const u32 local_y = y - m_y0;
+            const u32 block = (local_y / c_hiz_block_size) * c_blocks_per_row +
+                local_x / c_hiz_block_size;
+            if (!(m_cached & (1ull << block)))
+            {
+                Load(block);
+            }
+            return m_tile + target * c_tile_cache_pixels + QuadBlockOffset(local_x, local_y);
+        }
+
+        /**
+         * @brief Writes the cached blocks back to the render targets and empties the cache.
+         * @return The number of blocks written back.
+         */
+        u32 Flush();
+
+        /**
+         * @brief Offset of the 4x2 block containing pixel (x, y) of a tile from the tile's
+         * first pixel, in a plane of the cache's layout.
+         */
+        static u32 QuadBlockOffset(u32 x, u32 y)
+        {
+            const u32 block = (y / c_hiz_block_size) * c_blocks_per_row + x / c_hiz_block_size;
+            const u32 quad_block = (y % c_hiz_block_size) / 2 * (c_hiz_block_size / 4) +
+                (x % c_hiz_block_size) / 4;
+            return block * c_block_pixels + quad_block * 8;
+        }
+
+        /**
+         * @brief Offset of pixel (x, y) of a tile from its first one.
+         */
+        static u32 PixelOffset(u32 x, u32 y)
+        {
+            return QuadBlockOffset(x, y) + (x & 2) * 2 + (y & 1) * 2 + (x & 1);
+        }
+
+    private:
+        static constexpr u32 c_blocks_per_row = c_hiz_tile_size / c_hiz_block_size;
+        static constexpr u32 c_block_pixels = c_hiz_block_size * c_hiz_block_size;
+        STATIC_ASSERT(c_blocks_per_row * c_blocks_per_row <= 64,
+            "Cached blocks are tracked in a 64-bit mask");
+
+        // Offset of pixel (x, y) of a block from its first one.
+        static u32 BlockPixel(u32 x, u32 y)
+        {
+            return (y / 2 * (c_hiz_block_size / 4) + x / 4) * 8 + (x & 2) * 2 + (y & 1) * 2 +
+                (x & 1);
+        }
+
+        void Load(u32 block);
+
+    private:
+        std::vector<u32> m_pixels {};
+        // The planes written: m_pixels, or the caller's tile in place.
+        u32* m_tile {nullptr};
+        // Null while writing in place.
+        RenderTarget* const* m_targets {nullptr};
+        u32 m_target_count {0};
+        u32 m_x0 {0};
+        u32 m_y0 {0};
+        // Bit b is set when block b of the tile is cached.
+        u64 m_cached {0};
+    };
+
+} // namespace Rasterizer
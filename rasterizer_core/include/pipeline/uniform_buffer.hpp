@@ -0,0 +1,132 @@
+#pragma once
+#include "Core.h"
+#include "shader/shader_api.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <string>
+
+namespace Rasterizer
+{
+
+    // Alignment of the uniform blocks the pipeline hands to shaders: one cache line, so two
+    // draws' blocks never share a line and shaders may use aligned vector loads.
+    constexpr size_t c_uniform_alignment = 64;
+
+    /**
+     * @brief Location of one named uniform, resolved once through a UniformLayout so setting
+     * it per draw is a plain store. Invalid if the shaders do not declare the name.
+     */
+    struct UniformSlot
+    {
+        static constexpr u32 c_invalid_offset = ~0u;
+
+        u32 offset {c_invalid_offset};
+        Format format {Format::Unknown};
+
+        bool IsValid() const { return offset != c_invalid_offset; }
+    };
+
+    /**
+     * @brief Immutable uniform data of a draw. Whatever it points to must stay unchanged
+     * until the draws that reference it completed, so worker threads read it without copies
+     * or locks. Pipeline::UploadUniforms() returns blocks in the frame's uniform ring;
+     * constant data that outlives the frame may be referenced in place.
+     */
+    struct UniformBlock
+    {
+        const void* data {nullptr};
+        size_t size {0};
+    };
+
+    /**
+     * @brief Raw block of uniform data handed to both shader stages of a draw.
+     * The layout is whatever struct the shaders agree on; reflection describes it.
+     *
+     * Every change of the contents gets a new version, unique across all buffers, so the
+     * pipeline can upload a buffer once and share the copy among the draws that follow.
+     */
+    class UniformBuffer
+    {
+    public:
+        explicit UniformBuffer(size_t size) : m_data(size, 0), m_version(NextVersion()) {}
+
+        // Assumes the caller writes through the pointer.
+        void* GetData()
+        {
+            m_version = NextVersion();
+            return m_data.data();
+        }
+        const void* GetData() const { return m_data.data(); }
+        size_t GetSize() const { return m_data.size(); }
+        u64 GetVersion() const { return m_version; }
+
+        template<typename T>
+        void Set(size_t offset, const T& value)
+        {
+            assert(offset + sizeof(T) <= m_data.size());
+            std::memcpy(m_data.data() + offset, &value, sizeof(T));
+            m_version = NextVersion();
+        }
+
+        /**
+         * @brief Sets a uniform found by name beforehand. Invalid slots are ignored, their
+         * name was reported when the lookup failed.
+         */
+        template<typename T>
+        void Set(UniformSlot slot, const T& value)
+        {
+            if (slot.IsValid())
+            {
+                assert(sizeof(T) == FormatSize(slot.format));
+                Set(slot.offset, value);
+            }
+        }
+
+    private:
+        static u64 NextVersion();
+
+    private:
+        std::vector<u8> m_data;
+        u64 m_version;
+    };
+
+    /**
+     * @brief The uniforms of a vertex and fragment shader by name, which share one block.
+     * Pipeline::Configure() builds it from the reflection so names are looked up when a
+     * pipeline is created, never per draw.
+     */
+    class UniformLayout
+    {
+    public:
+        /**
+         * @brief Replaces the layout with the uniforms of both shaders.
+         * @return false (with an error logged) if the shaders declare a name with different
+         * formats or offsets.
+         */
+        bool Build(const ShaderReflection& vs, const ShaderReflection& fs);
+
+        /**
+         * @brief Warns and returns an invalid slot if neither shader declares the name.
+         */
+        UniformSlot Find(const char* name) const;
+
+        // Bytes the uniform block of a draw needs at least.
+        size_t GetSize() const { return m_size; }
+
+    private:
+        UniformSlot Find(const char* name, bool warn) const;
+
+    private:
+        struct Entry
+        {
+            // Copied, a reloaded shader module takes its reflection strings with it.
+            std::string name;
+            UniformSlot slot;
+        };
+
+        std::vector<Entry> m_entries {};
+        size_t m_size {0};
+    };
+
+} // namespace Rasterizer
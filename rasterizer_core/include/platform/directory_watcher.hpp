@@ -0,0 +1,59 @@
+#pragma once
+#include "Core.h"
+
+#if !defined(WIN32) && !defined(__linux__)
+#include <filesystem>
+#endif
+
+namespace Rasterizer
+{
+    class DirectoryWatcher;
+    using DirectoryWatcherPtr = UniquePtr<DirectoryWatcher>;
+
+    /**
+     * @brief Change notifications for the files of one directory (not its subdirectories):
+     * ReadDirectoryChangesW on Windows, inotify on Linux and modification time polling
+     * elsewhere.
+     */
+    class DirectoryWatcher
+    {
+    public:
+        DirectoryWatcher() = default;
+        ~DirectoryWatcher();
+
+        DirectoryWatcher(const DirectoryWatcher&) = delete;
+        DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+        /**
+         * @return The watcher, or null (with an error logged) if the directory cannot be
+         * watched.
+         */
+        static DirectoryWatcherPtr Create(const std::string& directory);
+
+        /**
+         * @brief Waits up to timeout_ms for files to be written, created or renamed into the
+         * directory and appends their names to changed. An empty name means notifications
+         * were lost and any file may have changed.
+         * @return true if anything changed.
+         */
+        bool Wait(u32 timeout_ms, std::vector<std::string>& changed);
+
+    private:
+        bool Watch(const std::string& directory);
+
+    private:
+        std::string m_directory {};
+#if defined(WIN32)
+        bool Issue();
+
+        HANDLE m_handle {INVALID_HANDLE_VALUE};
+        OVERLAPPED m_overlapped {};
+        alignas(DWORD) u8 m_buffer[16384] {};
+#elif defined(__linux__)
+        int m_fd {-1};
+#else
+        std::unordered_map<std::string, std::filesystem::file_time_type> m_write_times {};
+#endif
+    };
+
+} // namespace Rasterizer
@@ -0,0 +1,47 @@
+#pragma once
+#include "Core.h"
+
+namespace Rasterizer
+{
+    class DynamicLibrary;
+    using DynamicLibraryPtr = UniquePtr<DynamicLibrary>;
+
+    /**
+     * @brief Loaded shared library (DLL / .so), unloaded on destruction. Function pointers
+     * taken from it must not be called anymore once it is destroyed.
+     */
+    class DynamicLibrary
+    {
+    public:
+        DynamicLibrary() = default;
+        ~DynamicLibrary();
+
+        DynamicLibrary(const DynamicLibrary&) = delete;
+        DynamicLibrary& operator=(const DynamicLibrary&) = delete;
+
+        /**
+         * @return The library, or null (with an error logged) if it cannot be loaded.
+         */
+        static DynamicLibraryPtr Open(const std::string& path);
+
+        // Address of an exported symbol, null if the library does not export it.
+        void* GetSymbol(const char* name) const;
+
+        template <typename T>
+        T GetFunction(const char* name) const
+        {
+            return reinterpret_cast<T>(GetSymbol(name));
+        }
+
+        const std::string& GetPath() const { return m_path; }
+
+    private:
+        std::string m_path {};
+#ifdef WIN32
+        HMODULE m_handle {nullptr};
+#else
+        void* m_handle {nullptr};
+#endif
+    };
+
+} // namespace Rasterizer
@@ -0,0 +1,116 @@
+#pragma once
+#include "Core.h"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace Rasterizer
+{
+
+    // Size of the first block of a frame arena; later blocks double the capacity.
+    constexpr size_t c_frame_arena_block_size = 4 << 20;
+
+    /**
+     * @brief Bump allocator for memory that lives until the end of a frame.
+     *
+     * Allocation moves a pointer; Reset() drops everything at once without running
+     * destructors, so only trivially destructible types belong in it. When a frame outgrows
+     * the current block a new one is chained, and the next Reset() merges all blocks into a
+     * single one, so a repeating workload settles into a steady state with no system
+     * allocations at all. Not thread safe: the pipeline keeps one arena per worker.
+     */
+    class FrameArena
+    {
+    public:
+        explicit FrameArena(size_t block_size = c_frame_arena_block_size)
+            : m_block_size(block_size)
+        {
+        }
+
+        FrameArena(FrameArena&&) = default;
+        FrameArena& operator=(FrameArena&&) = default;
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+        {
+            size_t offset = AlignedOffset(alignment);
+            if (m_blocks.empty() || offset + size > m_blocks.back().size)
+            {
+                AddBlock(size + alignment);
+                offset = AlignedOffset(alignment);
+            }
+            m_offset = offset + size;
+            m_used += size;
+            m_last = m_blocks.back().data.get() + offset;
+            return m_last;
+        }
+
+        template <typename T>
+        T* Allocate(size_t count)
+        {
+            STATIC_ASSERT(std::is_trivially_destructible_v<T>,
+                "Frame arena memory is released without running destructors");
+            return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        /**
+         * @brief Gives back the tail of the most recent allocation, e.g. after reserving for
+         * the worst case. Other allocations are left untouched.
+         */
+        void Shrink(void* allocation, size_t size)
+        {
+            u8* begin = static_cast<u8*>(allocation);
+            if (begin != m_last)
+            {
+                return;
+            }
+            const size_t end = static_cast<size_t>(begin - m_blocks.back().data.get()) + size;
+            if (end <= m_offset)
+            {
+                m_used -= m_offset - end;
+                m_offset = end;
+            }
+        }
+
+        /**
+         * @brief Releases every allocation. Only valid once nothing references them anymore.
+         */
+        void Reset();
+
+        // Bytes handed out since the last Reset().
+        size_t GetUsed() const { return m_used; }
+        size_t GetCapacity() const;
+        // Blocks requested from the system over the arena's lifetime.
+        u64 GetBlockAllocations() const { return m_block_allocations; }
+
+    private:
+        struct Block
+        {
+            UniquePtr<u8[]> data;
+            size_t size;
+        };
+
+        // Offset of the next address with the given alignment in the current block.
+        size_t AlignedOffset(size_t alignment) const
+        {
+            if (m_blocks.empty())
+            {
+                return 0;
+            }
+            const uintptr_t base = reinterpret_cast<uintptr_t>(m_blocks.back().data.get());
+            return ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+        }
+
+        void AddBlock(size_t min_size);
+
+    private:
+        std::vector<Block> m_blocks {};
+        size_t m_block_size;
+        size_t m_offset {0};
+        size_t m_used {0};
+        u8* m_last {nullptr};
+        u64 m_block_allocations {0};
+    };
+
+} // namespace Rasterizer
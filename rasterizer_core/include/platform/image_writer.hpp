@@ -0,0 +1,22 @@
+#pragma once
+#include "Core.h"
+
+namespace Rasterizer
+{
+
+    enum class ImageFormat
+    {
+        // The BGRA8 pixels as they are in memory, width * height * 4 bytes without a header.
+        Raw,
+        // 8-bit RGBA PNG, stored without compression to keep encoding cheap.
+        PNG,
+    };
+
+    /**
+     * @brief Writes BGRA8 (0xAARRGGBB) pixels to a file, pitch in pixels.
+     * @return false (with an error logged) if the file could not be written.
+     */
+    bool WriteImage(const std::string& path, ImageFormat format, const u32* pixels, u32 width,
+        u32 height, u32 pitch);
+
+} // namespace Rasterizer
@@ -0,0 +1,133 @@
+#pragma once
+#include "Core.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Rasterizer
+{
+    class JobSystem;
+    class JobCounter;
+    using JobSystemPtr = SharedPtr<JobSystem>;
+
+    /**
+     * @brief Job entry point. index is the per-job value given at submission (chunk, tile...),
+     * worker_index identifies the executing worker so jobs can use per-worker scratch memory.
+     */
+    using JobFunction = void (*)(void* data, u32 index, u32 worker_index);
+
+    /**
+     * @brief Unit of work. Plain data so submitting a job never allocates.
+     */
+    struct Job
+    {
+        JobFunction function {nullptr};
+        void* data {nullptr};
+        u32 index {0};
+        const char* name {"job"};
+        // Decremented once the job finished, may be null. The submitter arms it beforehand
+        // (Reset/Add) so it cannot reach zero while related jobs are still being queued.
+        JobCounter* signal {nullptr};
+    };
+
+    /**
+     * @brief Dependency counter. Jobs decrement it as they finish; jobs queued on it with
+     * JobSystem::RunAfter start as soon as it reaches zero, without a global barrier.
+     */
+    class JobCounter
+    {
+    public:
+        explicit JobCounter(u32 value = 0) : m_value(value) {}
+
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        /**
+         * @brief Re-arms the counter. Only valid while nothing waits on it.
+         */
+        void Reset(u32 value) { m_value.store(value, std::memory_order_relaxed); }
+        void Add(u32 value) { m_value.fetch_add(value, std::memory_order_relaxed); }
+        bool IsDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<u32> m_value;
+        mutable std::mutex m_mutex {};
+        std::vector<Job> m_waiting {};
+    };
+
+    /**
+     * @brief Shared work-stealing scheduler for every pipeline stage.
+     *
+     * Each worker owns a deque: it pushes and pops its own jobs LIFO for locality, while idle
+     * workers steal the oldest jobs from others, so uneven job costs (an empty sky tile next
+     * to a dense mesh tile) balance out dynamically. The thread that creates the system is
+     * worker 0 and executes jobs while it waits. Every job is a profiler zone named after it.
+     */
+    class JobSystem
+    {
+    public:
+        explicit JobSystem(u32 worker_count);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        /**
+         * @param worker_count Total workers including the caller, 0 picks the core count.
+         */
+        static JobSystemPtr Create(u32 worker_count = 0);
+
+        u32 GetWorkerCount() const { return m_worker_count; }
+
+        /**
+         * @brief Queues a job on the calling worker's deque.
+         */
+        void Run(const Job& job);
+
+        /**
+         * @brief Queues a job once dependency reaches zero (immediately if it already has).
+         */
+        void RunAfter(JobCounter& dependency, const Job& job);
+
+        /**
+         * @brief Decrements a counter by hand, releasing its waiting jobs when it hits zero.
+         */
+        void Signal(JobCounter& counter);
+
+        /**
+         * @brief Blocks until the counter reaches zero. Worker threads, including worker 0,
+         * keep executing jobs meanwhile instead of sleeping.
+         */
+        void Wait(const JobCounter& counter);
+
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex {};
+            std::deque<Job> jobs {};
+        };
+
+        void Push(const Job& job);
+        bool TryPop(u32 worker_index, Job& job);
+        void Execute(u32 worker_index, const Job& job);
+        void WorkerLoop(u32 worker_index);
+        u32 GetCurrentWorkerIndex() const;
+
+    private:
+        u32 m_worker_count {1};
+        std::vector<UniquePtr<WorkerQueue>> m_queues {};
+        std::vector<std::thread> m_threads {};
+
+        std::atomic<u32> m_queued {0};
+        std::atomic<u32> m_sleepers {0};
+        std::mutex m_sleep_mutex {};
+        std::condition_variable m_wake {};
+        bool m_stopping {false};
+    };
+
+} // namespace Rasterizer
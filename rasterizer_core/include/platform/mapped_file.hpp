@@ -0,0 +1,42 @@
+#pragma once
+#include "Core.h"
+
+namespace Rasterizer
+{
+    class MappedFile;
+    using MappedFilePtr = SharedPtr<MappedFile>;
+
+    /**
+     * @brief Read-only memory mapping of a whole file. Pages are loaded by the OS on first
+     * touch, so opening is constant time regardless of the file size.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @return The mapping, or null (with an error logged) if the file cannot be mapped.
+         */
+        static MappedFilePtr Open(const std::string& path);
+
+        const u8* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        bool Map(const std::string& path);
+
+    private:
+        const u8* m_data {nullptr};
+        size_t m_size {0};
+#ifdef WIN32
+        HANDLE m_file {INVALID_HANDLE_VALUE};
+        HANDLE m_mapping {nullptr};
+#endif
+    };
+
+} // namespace Rasterizer
@@ -1,11 +1,79 @@
 #pragma once
 #include "Core.h"
+#include "platform/image_writer.hpp"
 
 namespace Rasterizer
 {
     class IWindow;
     using WindowPtr = SharedPtr<IWindow>;
 
+    enum class PresentMode
+    {
+        // Every frame is shown, one per vertical blank; Draw() blocks when all buffers queue.
+        Vsync,
+        // Shown at vertical blank, but a newer frame replaces one still waiting to be shown.
+        Mailbox,
+        // Shown as soon as possible without waiting for vertical blank; may tear.
+        Immediate,
+    };
+
+    enum class SurfaceFormat
+    {
+        // 0xAARRGGBB per u32, the RenderTarget layout.
+        BGRA8,
+    };
+
+    /**
+     * @brief CPU-writable memory backing a window's back buffer. Pipelines bind it directly
+     * as a RenderTarget(pixels, width, height, pitch), so presenting needs no extra copy.
+     */
+    struct Surface
+    {
+        u32* pixels {nullptr};
+        u32 width {0};
+        u32 height {0};
+        // Distance between rows in pixels.
+        u32 pitch {0};
+        SurfaceFormat format {SurfaceFormat::BGRA8};
+        // Frames since the pixels were presented: 1 if they hold the previous frame, 2 the
+        // one before, and so on; 0 if their contents are undefined.
+        u32 age {0};
+    };
+
+    /**
+     * @brief Pixel rectangle of a frame that differs from the frame presented before it.
+     */
+    struct DamageRect
+    {
+        u32 x {0};
+        u32 y {0};
+        u32 width {0};
+        u32 height {0};
+    };
+
+    /**
+     * @brief Framebuffers the window renders and presents through.
+     */
+    struct SwapchainDesc
+    {
+        // 2 or 3.
+        u32 buffer_count {2};
+        PresentMode present_mode {PresentMode::Vsync};
+    };
+
+    /**
+     * @brief Offscreen window: frames stay in memory and are optionally written to disk.
+     */
+    struct HeadlessDesc
+    {
+        // printf-style pattern taking the frame index as %u, e.g. "frames/frame_%04u.png".
+        // Empty to keep frames in memory only.
+        std::string dump_path {};
+        ImageFormat dump_format {ImageFormat::PNG};
+        // IsOpen() turns false after this many Draw() calls, 0 to never close.
+        u32 frame_count {0};
+    };
+
     /**
      * @brief Window interface for platform-specific window management.
      * This interface defines the basic functionality required for creating and managing a window.
@@ -16,7 +84,18 @@ namespace Rasterizer
         IWindow() = default;
         virtual ~IWindow() {};
 
-        static WindowPtr Create(const std::string& title, int width, int height);
+        /**
+         * @brief Opens a window on screen. Platforms without a windowing backend fall back to
+         * a headless window.
+         */
+        static WindowPtr Create(const std::string& title, int width, int height,
+            const SwapchainDesc& swapchain = {});
+
+        /**
+         * @brief Creates a window without display or event loop, on every platform.
+         */
+        static WindowPtr CreateHeadless(const std::string& title, int width, int height,
+            const HeadlessDesc& headless = {});
 
         virtual void PollEvents() = 0;
         virtual bool IsOpen() = 0;
@@ -26,7 +105,24 @@ namespace Rasterizer
         virtual int GetHeight() = 0;
         virtual void* GetWindowHandle() = 0;
 
+        /**
+         * @brief Back buffer the next frame renders into, GetWidth() x GetHeight() pixels.
+         * Another buffer of the swapchain is returned after every Draw().
+         */
+        virtual Surface GetSurface() = 0;
+
+        /**
+         * @brief Queues the back buffer for presentation and makes the next buffer current.
+         * Presenting happens asynchronously; only running out of free buffers blocks.
+         */
         virtual void Draw() = 0;
+
+        /**
+         * @brief Draw() of a frame that only differs from the previous one inside the damage
+         * rectangles, which is all a platform has to update on screen. Damage of frames that
+         * are never shown carries over to the next one.
+         */
+        virtual void Draw(const std::vector<DamageRect>& damage) = 0;
     };
 
-} // namespace Platform
+} // namespace Rasterizer
@@ -0,0 +1,149 @@
+#pragma once
+#include "Core.h"
+
+#include <atomic>
+
+namespace Rasterizer
+{
+
+    // Frames kept for the rolling statistics.
+    constexpr u32 c_profile_history = 120;
+    // Distinct counter names PROFILE_COUNT can register.
+    constexpr u32 c_max_profile_counters = 64;
+
+    struct ProfileEvent
+    {
+        const char* name;
+        u64 begin_ns;
+        u64 end_ns;
+        // Per-event value shown in the trace, e.g. the tile of a job; ~0u for none.
+        u32 index;
+        u32 thread;
+    };
+
+    /**
+     * @brief Frame-time statistics of one zone name over the last c_profile_history frames.
+     * Times are summed over all calls of a frame, across threads.
+     */
+    struct ProfileZoneStats
+    {
+        std::string name;
+        f64 last_ms;
+        f64 average_ms;
+        f64 min_ms;
+        f64 max_ms;
+        u32 last_calls;
+    };
+
+    struct ProfileCounterStats
+    {
+        std::string name;
+        u64 last;
+        f64 average;
+    };
+
+    /**
+     * @brief Process-wide CPU profiler: timed zones and per-frame counters from any thread.
+     *
+     * Recording is off until SetEnabled(true); disabled zones and counters cost one relaxed
+     * load. Building without RASTERIZER_PROFILING compiles the macros away entirely. Every
+     * thread appends to its own buffer; EndFrame() gathers the buffers into the last frame's
+     * events, which feed the rolling statistics and the Chrome trace export.
+     */
+    class Profiler
+    {
+    public:
+        static void SetEnabled(bool enabled) { s_enabled.store(enabled); }
+        static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Names the calling thread in traces, e.g. "worker 1".
+         */
+        static void SetThreadName(const char* name);
+
+        static u64 Now();
+        static void RecordZone(const char* name, u64 begin_ns, u64 end_ns, u32 index);
+
+        static u32 RegisterCounter(const char* name);
+        static void AddCounter(u32 counter, u64 value);
+
+        /**
+         * @brief Closes the current frame: collects recorded events and counters and updates
+         * the statistics. Zones still open at that point land in the next frame.
+         */
+        static void EndFrame();
+
+        /**
+         * @brief Events of the last frame closed by EndFrame(), sorted by start time.
+         */
+        static std::vector<ProfileEvent> GetFrameEvents();
+        static std::vector<ProfileZoneStats> GetZoneStats();
+        static std::vector<ProfileCounterStats> GetCounterStats();
+
+        /**
+         * @brief Writes the last frame in Chrome trace event JSON (chrome://tracing, Perfetto),
+         * with zones per thread and counters as counter tracks.
+         */
+        static bool WriteTrace(const std::string& path);
+
+    private:
+        static inline std::atomic<bool> s_enabled {false};
+    };
+
+    /**
+     * @brief Times its scope as a zone when the profiler is enabled.
+     */
+    class ProfileZone
+    {
+    public:
+        explicit ProfileZone(const char* name, u32 index = ~0u)
+            : m_name(Profiler::IsEnabled() ? name : nullptr), m_index(index)
+        {
+            if (m_name)
+            {
+                m_begin_ns = Profiler::Now();
+            }
+        }
+
+        ~ProfileZone()
+        {
+            if (m_name)
+            {
+                Profiler::RecordZone(m_name, m_begin_ns, Profiler::Now(), m_index);
+            }
+        }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+
+    private:
+        const char* m_name;
+        u32 m_index;
+        u64 m_begin_ns {0};
+    };
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef RASTERIZER_PROFILING
+#define PROFILE_ZONE(name) \
+    ::Rasterizer::ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_ZONE_INDEXED(name, index) \
+    ::Rasterizer::ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name, index)
+#define PROFILE_COUNT(name, value) \
+    do \
+    { \
+        if (::Rasterizer::Profiler::IsEnabled()) \
+        { \
+            static const ::Rasterizer::u32 s_profile_counter = \
+                ::Rasterizer::Profiler::RegisterCounter(name); \
+            ::Rasterizer::Profiler::AddCounter(s_profile_counter, value); \
+        } \
+    } while (0)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_ZONE_INDEXED(name, index) ((void)0)
+#define PROFILE_COUNT(name, value) ((void)0)
+#endif
+
+} // namespace Rasterizer
@@ -1 +1,15 @@
-#include "platform/platform.hpp"
\ No newline at end of file
+#pragma once
+#include "platform/platform.hpp"
+#include "platform/job_system.hpp"
+#include "platform/profiler.hpp"
+#include "math/math.hpp"
+#include "mesh/mesh.hpp"
+#include "mesh/mesh_file.hpp"
+#include "mesh/mesh_optimizer.hpp"
+#include "pipeline/command_buffer.hpp"
+#include "pipeline/deferred_lighting.hpp"
+#include "pipeline/pipeline.hpp"
+#include "pipeline/texture.hpp"
+#include "shader/shader_api.hpp"
+#include "shader/shader_manager.hpp"
+#include "log.hpp"
\ No newline at end of file
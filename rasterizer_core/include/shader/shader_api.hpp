@@ -0,0 +1,183 @@
+#pragma once
+#include "Core.h"
+
+/*
+ * Shared ABI between the engine and shader modules. Everything in this header crosses the
+ * DLL boundary, so it only uses plain C types: no std containers, no virtual functions.
+ * Changing a struct here requires rebuilding every shader module.
+ */
+
+#if defined(_WIN32)
+#define SHADER_EXPORT extern "C" __declspec(dllexport)
+#else
+#define SHADER_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+/*
+ * Pixels per fragment packet the module is compiled for, following the RASTERIZER_SIMD build
+ * option: 8 (two 2x2 quads) with AVX2, otherwise 4 (one 2x2 quad). Modules report it through
+ * FragmentShaderAPI::simd_width, so an AVX2 and a scalar build of one module are both valid.
+ */
+#if defined(RASTERIZER_SIMD_AVX2)
+#define SHADER_SIMD_WIDTH 8
+#else
+#define SHADER_SIMD_WIDTH 4
+#endif
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief Texture sampling entry points of the engine. Modules reach them through the
+     * TextureBinding in their uniforms rather than by linking against the engine's textures.
+     */
+    struct TextureSamplerAPI
+    {
+        /**
+         * @brief Bilinear samples of one packet, the mip level picked per 2x2 quad from the
+         * differences between its lanes. uvs holds u of every lane, then v of every lane (a Vec2
+         * packet input); colors receives r, g, b and a the same way (a Vec4 packet output).
+         * Width is the packet's simd_width, 4 or 8. Coordinates wrap.
+         */
+        void (*SamplePacket)(const void* texture, const f32* uvs, u32 width, f32* colors);
+        /**
+         * @brief One bilinear sample from the mip level nearest to lod, for per-pixel entry
+         * points that have no neighbours to take derivatives from. Writes r, g, b, a.
+         */
+        void (*Sample)(const void* texture, f32 u, f32 v, f32 lod, f32* color);
+    };
+
+    /**
+     * @brief A texture as shaders see it, passed as a Format::Texture uniform:
+     * api->SamplePacket(texture, ...). Valid as long as the engine's texture lives.
+     */
+    struct TextureBinding
+    {
+        const void* texture;
+        const TextureSamplerAPI* api;
+    };
+
+    enum class Format : u32
+    {
+        Unknown = 0,
+        Float,
+        Vec2,
+        Vec3,
+        Vec4,
+        Mat4,
+        RGBA8,
+        // A TextureBinding, for uniforms only.
+        Texture,
+    };
+
+    constexpr u32 FormatSize(Format format)
+    {
+        switch (format)
+        {
+        case Format::Float: return 4;
+        case Format::Vec2: return 8;
+        case Format::Vec3: return 12;
+        case Format::Vec4: return 16;
+        case Format::Mat4: return 64;
+        case Format::RGBA8: return 4;
+        case Format::Texture: return static_cast<u32>(sizeof(TextureBinding));
+        default: return 0;
+        }
+    }
+
+    /**
+     * @brief Number of f32 components of a float-based format, 0 for packed formats.
+     */
+    constexpr u32 FormatFloatCount(Format format)
+    {
+        switch (format)
+        {
+        case Format::Float: return 1;
+        case Format::Vec2: return 2;
+        case Format::Vec3: return 3;
+        case Format::Vec4: return 4;
+        case Format::Mat4: return 16;
+        default: return 0;
+        }
+    }
+
+    /**
+     * @brief One named entry of a shader's input, output or uniform struct.
+     */
+    struct ShaderParam
+    {
+        const char* name;
+        Format format;
+        u32 offset;
+    };
+
+    /**
+     * @brief Self-description a shader module publishes for its entry points.
+     *
+     * Vertex shaders: inputs are matched by name against the mesh VertexLayout. The first
+     * output must be the clip-space position (Vec4 at offset 0); the remaining outputs are
+     * varyings and must be float-based so they can be clipped and interpolated.
+     *
+     * Fragment shaders: inputs are matched by name against the vertex shader outputs, and
+     * each output is a Vec4 color written to the render target with the same index.
+     */
+    struct ShaderReflection
+    {
+        const ShaderParam* inputs;
+        u32 input_count;
+        u32 input_stride;
+
+        const ShaderParam* outputs;
+        u32 output_count;
+        u32 output_stride;
+
+        const ShaderParam* uniforms;
+        u32 uniform_count;
+        u32 uniform_size;
+    };
+
+    using VSMainFn = void (*)(const void* vertex_input, void* vertex_output, const void* uniforms);
+    /**
+     * @brief Shades count vertices in one call. Input vertex i starts at
+     * input + i * input_stride; output vertex i at output + i * reflection->output_stride.
+     */
+    using VSMainBatchFn = void (*)(const void* vertex_inputs, u32 input_stride, u32 count,
+        void* vertex_outputs, const void* uniforms);
+    using FSMainFn = void (*)(const void* fragment_input, void* fragment_output,
+        const void* uniforms);
+    /**
+     * @brief Shades one packet of simd_width pixels in SoA form: float component k of lane l
+     * lives at inputs[k * simd_width + l], input and output structs being seen as f32 arrays.
+     * Lanes are laid out as 2x2 quads (x, x+1, x at y+1, x+1 at y+1), quads left to right.
+     * Bit l of coverage_mask is set for lanes inside the triangle; the outputs of the other
+     * lanes are discarded. Those are helper lanes: their inputs are interpolated at their own
+     * pixel, possibly a little outside the triangle's range, so differences between the lanes
+     * of a quad are screen-space derivatives everywhere.
+     */
+    using FSMainPacketFn = void (*)(const f32* fragment_inputs, f32* fragment_outputs,
+        u32 coverage_mask, const void* uniforms);
+
+    struct VertexShaderAPI
+    {
+        VSMainFn VS_Main;
+        const ShaderReflection* reflection;
+        // Optional. When present the engine shades whole vertex batches through it instead of
+        // paying one call across the DLL boundary per vertex.
+        VSMainBatchFn VS_MainBatch;
+    };
+
+    struct FragmentShaderAPI
+    {
+        // May be null when FS_MainPacket is provided.
+        FSMainFn FS_Main;
+        const ShaderReflection* reflection;
+        // Optional packet entry point, preferred by the engine when present.
+        FSMainPacketFn FS_MainPacket;
+        // Lanes per FS_MainPacket call: 4 or 8, ignored without a packet entry point.
+        u32 simd_width;
+    };
+
+    using GetVertexShaderAPIFn = const VertexShaderAPI* (*)();
+    using GetFragmentShaderAPIFn = const FragmentShaderAPI* (*)();
+
+} // namespace Rasterizer
@@ -0,0 +1,125 @@
+#pragma once
+#include "Core.h"
+#include "shader/shader_api.hpp"
+#include "platform/directory_watcher.hpp"
+#include "platform/dynamic_library.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace Rasterizer
+{
+    class ShaderManager;
+    using ShaderManagerPtr = UniquePtr<ShaderManager>;
+
+    // Threads that can hold a shader module at the same time, see ShaderManager::RegisterReader.
+    constexpr u32 c_max_shader_readers = 8;
+
+    /**
+     * @brief Entry points of one loaded version of a shader module. version increases with
+     * every successful reload, so readers can tell when to reconfigure their pipeline.
+     */
+    struct ShaderLibrary
+    {
+        VertexShaderAPI vertex;
+        FragmentShaderAPI fragment;
+        u64 version;
+    };
+
+    /**
+     * @brief Loads a shader module and hot-reloads it when it is rebuilt, without ever
+     * blocking the threads that render with it.
+     *
+     * A background thread watches the module's directory. When the module changes, it copies
+     * it (so the linker can keep writing the original), loads the copy, validates its entry
+     * points and publishes it with one atomic pointer swap. A module failing validation is
+     * dropped with an error and the current one stays in use.
+     *
+     * Old versions are reclaimed by epochs: Acquire() records the epoch it started in, and a
+     * replaced version is only unloaded once every reader announced a later epoch or released.
+     * A reader must therefore keep the library acquired until the pipeline stopped using it:
+     *
+     *     const ShaderLibrary& shaders = manager->Acquire(reader);
+     *     if (shaders.version != configured_version) { pipeline.Configure(...); ... }
+     *     pipeline.DrawMesh(...);
+     *     pipeline.Flush();
+     *     manager->Release(reader);
+     */
+    class ShaderManager
+    {
+    public:
+        ShaderManager() = default;
+        // Stops the loader thread and unloads every version; no reader may hold one anymore.
+        ~ShaderManager();
+
+        ShaderManager(const ShaderManager&) = delete;
+        ShaderManager& operator=(const ShaderManager&) = delete;
+
+        /**
+         * @param module_path Shader module exporting GetVertexShaderAPI and GetFragmentShaderAPI.
+         * @return The manager, or null (with an error logged) if the module cannot be loaded
+         * or its directory cannot be watched.
+         */
+        static ShaderManagerPtr Create(const std::string& module_path);
+
+        /**
+         * @brief Reserves a reader slot for the calling thread, ~0u once all
+         * c_max_shader_readers are taken.
+         */
+        u32 RegisterReader();
+
+        /**
+         * @brief Pins the current module version for the reader. Wait-free; the reference
+         * stays valid until Release(reader).
+         */
+        const ShaderLibrary& Acquire(u32 reader);
+        void Release(u32 reader);
+
+        // Successful reloads since creation.
+        u64 GetReloadCount() const { return m_reloads.load(std::memory_order_relaxed); }
+
+    private:
+        struct Version
+        {
+            // Unloads the module, then deletes its copy.
+            ~Version();
+
+            ShaderLibrary library {};
+            DynamicLibraryPtr module {};
+            std::string copy_path {};
+            // Epoch in which the version was replaced; readers of earlier epochs may use it.
+            u64 retire_epoch {0};
+        };
+
+        struct alignas(64) ReaderSlot
+        {
+            // Epoch announced by Acquire(), 0 while the reader holds nothing.
+            std::atomic<u64> epoch {0};
+        };
+
+        UniquePtr<Version> Load();
+        void Run();
+        void Reclaim();
+
+    private:
+        std::string m_module_path {};
+        std::string m_module_name {};
+        std::string m_copy_prefix {};
+
+        // Owned, published to readers with one atomic swap.
+        std::atomic<Version*> m_current {nullptr};
+        std::atomic<u64> m_epoch {1};
+        ReaderSlot m_readers[c_max_shader_readers] {};
+        std::atomic<u32> m_reader_count {0};
+        std::atomic<u64> m_reloads {0};
+
+        // Only touched by the loader thread.
+        DirectoryWatcherPtr m_watcher {};
+        std::vector<UniquePtr<Version>> m_retired {};
+        u64 m_next_version {0};
+
+        std::atomic<bool> m_running {false};
+        std::thread m_thread {};
+    };
+
+} // namespace Rasterizer
@@ -0,0 +1,37 @@
+#include "log.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+
+namespace Rasterizer
+{
+
+    static std::mutex s_log_mutex;
+
+    void Log(LogLevel level, const char* format, ...)
+    {
+        const char* prefix = "[info] ";
+        FILE* stream = stdout;
+        if (level == LogLevel::Warning)
+        {
+            prefix = "[warning] ";
+            stream = stderr;
+        }
+        else if (level == LogLevel::Error)
+        {
+            prefix = "[error] ";
+            stream = stderr;
+        }
+
+        char message[1024];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(message, sizeof(message), format, args);
+        va_end(args);
+
+        std::lock_guard<std::mutex> lock(s_log_mutex);
+        fprintf(stream, "%s%s\n", prefix, message);
+    }
+
+} // namespace Rasterizer
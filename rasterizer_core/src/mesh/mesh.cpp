@@ -0,0 +1,145 @@
+#include "mesh/mesh.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace Rasterizer
+{
+
+    const VertexAttribute* VertexLayout::Find(const std::string& name) const
+    {
+        for (const VertexAttribute& attribute : attributes)
+        {
+            if (attribute.name == name)
+            {
+                return &attribute;
+            }
+        }
+        return nullptr;
+    }
+
+    static u64 HashLayout(const VertexLayout& layout)
+    {
+        // FNV-1a over the stride and every attribute.
+        u64 hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, size_t size)
+        {
+            const u8* bytes = static_cast<const u8*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+        mix(&layout.stride, sizeof(layout.stride));
+        for (const VertexAttribute& attribute : layout.attributes)
+        {
+            mix(attribute.name.data(), attribute.name.size() + 1);
+            mix(&attribute.format, sizeof(attribute.format));
+            mix(&attribute.offset, sizeof(attribute.offset));
+            mix(&attribute.stride, sizeof(attribute.stride));
+        }
+        return hash;
+    }
+
+    static bool IsSameLayout(const VertexLayout& a, const VertexLayout& b)
+    {
+        if (a.stride != b.stride || a.attributes.size() != b.attributes.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.attributes.size(); ++i)
+        {
+            const VertexAttribute& x = a.attributes[i];
+            const VertexAttribute& y = b.attributes[i];
+            if (x.name != y.name || x.format != y.format || x.offset != y.offset ||
+                x.stride != y.stride)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    u32 InternVertexLayout(const VertexLayout& layout)
+    {
+        // Grows with the distinct layouts only, typically a handful per application.
+        static std::mutex s_mutex;
+        static std::unordered_multimap<u64, u32> s_ids;
+        static std::vector<VertexLayout> s_layouts;
+
+        const u64 hash = HashLayout(layout);
+        std::lock_guard<std::mutex> lock(s_mutex);
+        const auto [begin, end] = s_ids.equal_range(hash);
+        for (auto it = begin; it != end; ++it)
+        {
+            if (IsSameLayout(s_layouts[it->second - 1], layout))
+            {
+                return it->second;
+            }
+        }
+        s_layouts.push_back(layout);
+        const u32 id = static_cast<u32>(s_layouts.size());
+        s_ids.emplace(hash, id);
+        return id;
+    }
+
+    bool VertexLayout::IsInterleaved() const
+    {
+        for (const VertexAttribute& attribute : attributes)
+        {
+            if (GetStride(attribute) != stride)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool VertexBuffer::IsInRange(const VertexAttribute& attribute) const
+    {
+        // A stream is part of every vertex, so it can be no wider than the whole vertex,
+        // which also keeps the end offset below from overflowing.
+        const size_t stride = layout.GetStride(attribute);
+        const size_t size = FormatSize(attribute.format);
+        if (size == 0 || size > stride || stride > layout.stride)
+        {
+            return false;
+        }
+        return vertex_count == 0 ||
+            attribute.offset + (vertex_count - 1) * stride + size <= GetSize();
+    }
+
+    VertexBuffer DeinterleaveVertices(const VertexBuffer& vertices)
+    {
+        VertexBuffer streams;
+        streams.vertex_count = vertices.vertex_count;
+        for (const VertexAttribute& attribute : vertices.layout.attributes)
+        {
+            const size_t size = FormatSize(attribute.format);
+            streams.layout.attributes.push_back({attribute.name, attribute.format,
+                streams.layout.stride * vertices.vertex_count, size});
+            streams.layout.stride += size;
+        }
+        streams.data.resize(streams.GetSize());
+        for (size_t a = 0; a < vertices.layout.attributes.size(); ++a)
+        {
+            const VertexAttribute& source = vertices.layout.attributes[a];
+            const VertexAttribute& destination = streams.layout.attributes[a];
+            u8* stream = streams.data.data() + destination.offset;
+            for (size_t i = 0; i < vertices.vertex_count; ++i)
+            {
+                std::memcpy(stream + i * destination.stride, vertices.GetAttribute(source, i),
+                    destination.stride);
+            }
+        }
+        return streams;
+    }
+
+    u32 Mesh::GetTriangleCount() const
+    {
+        const size_t corner_count = IsIndexed() ? indices.GetCount() : vertices.vertex_count;
+        return static_cast<u32>(corner_count / 3);
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,176 @@
+#include "mesh/mesh_file.hpp"
+#include "platform/mapped_file.hpp"
+#include "log.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace Rasterizer
+{
+
+    static u64 AlignFileOffset(u64 offset)
+    {
+        return (offset + c_mesh_file_alignment - 1) & ~(c_mesh_file_alignment - 1);
+    }
+
+    // True if [offset, offset + size) is aligned and inside a file of file_size bytes.
+    static bool IsBlobValid(u64 offset, u64 size, u64 file_size)
+    {
+        return offset % c_mesh_file_alignment == 0 && offset <= file_size &&
+            size <= file_size - offset;
+    }
+
+    bool SaveMeshFile(const std::string& path, const Mesh& mesh)
+    {
+        const VertexBuffer& vertices = mesh.vertices;
+        const VertexLayout& layout = vertices.layout;
+        MeshFileHeader header = {};
+        header.magic = c_mesh_file_magic;
+        header.version = c_mesh_file_version;
+        header.attribute_count = static_cast<u32>(layout.attributes.size());
+        header.vertex_stride = static_cast<u32>(layout.stride);
+        header.vertex_count = vertices.vertex_count;
+        header.index_count = mesh.indices.GetCount();
+        header.meshlet_count = mesh.meshlets.size();
+
+        const u64 vertex_bytes = header.vertex_count * header.vertex_stride;
+        const u64 index_bytes = header.index_count * sizeof(u32);
+        header.attributes_offset = AlignFileOffset(sizeof(MeshFileHeader));
+        header.vertices_offset = AlignFileOffset(header.attributes_offset +
+            header.attribute_count * sizeof(MeshFileAttribute));
+        header.indices_offset = AlignFileOffset(header.vertices_offset + vertex_bytes);
+        header.meshlets_offset = AlignFileOffset(header.indices_offset + index_bytes);
+
+        std::vector<MeshFileAttribute> attributes(header.attribute_count);
+        for (u32 i = 0; i < header.attribute_count; ++i)
+        {
+            const VertexAttribute& attribute = layout.attributes[i];
+            if (attribute.name.size() >= c_mesh_file_name_size)
+            {
+                LOG_ERROR("Attribute name '%s' is too long for a mesh file (at most %u chars)",
+                    attribute.name.c_str(), c_mesh_file_name_size - 1);
+                return false;
+            }
+            std::memcpy(attributes[i].name, attribute.name.c_str(), attribute.name.size() + 1);
+            attributes[i].format = static_cast<u32>(attribute.format);
+            attributes[i].offset = static_cast<u32>(attribute.offset);
+            attributes[i].stride = static_cast<u32>(attribute.stride);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            LOG_ERROR("Could not open '%s' for writing", path.c_str());
+            return false;
+        }
+        auto write_at = [&](u64 offset, const void* data, u64 size)
+        {
+            static const char s_padding[c_mesh_file_alignment] = {};
+            const u64 position = static_cast<u64>(file.tellp());
+            file.write(s_padding, static_cast<std::streamsize>(offset - position));
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+        write_at(0, &header, sizeof(header));
+        write_at(header.attributes_offset, attributes.data(),
+            attributes.size() * sizeof(MeshFileAttribute));
+        write_at(header.vertices_offset, vertices.GetData(), vertex_bytes);
+        write_at(header.indices_offset, mesh.indices.GetData(), index_bytes);
+        write_at(header.meshlets_offset, mesh.meshlets.data(),
+            mesh.meshlets.size() * sizeof(Meshlet));
+
+        if (!file)
+        {
+            LOG_ERROR("Could not write '%s'", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool LoadMeshFile(const std::string& path, Mesh& mesh)
+    {
+        MappedFilePtr file = MappedFile::Open(path);
+        if (!file)
+        {
+            return false;
+        }
+
+        const u8* data = file->GetData();
+        const u64 size = file->GetSize();
+        MeshFileHeader header;
+        if (size < sizeof(header))
+        {
+            LOG_ERROR("'%s' is not a mesh file: too small", path.c_str());
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != c_mesh_file_magic || header.version != c_mesh_file_version)
+        {
+            LOG_ERROR("'%s' is not a version %u mesh file", path.c_str(), c_mesh_file_version);
+            return false;
+        }
+
+        // Bounding the counts by the file size first keeps the blob sizes below from overflowing.
+        const bool counts_valid = header.attribute_count <= size / sizeof(MeshFileAttribute) &&
+            header.index_count <= size / sizeof(u32) &&
+            header.meshlet_count <= size / sizeof(Meshlet) &&
+            (header.vertex_stride ? header.vertex_count <= size / header.vertex_stride :
+                header.vertex_count == 0);
+        if (!counts_valid ||
+            !IsBlobValid(header.attributes_offset,
+                header.attribute_count * sizeof(MeshFileAttribute), size) ||
+            !IsBlobValid(header.vertices_offset, header.vertex_count * header.vertex_stride,
+                size) ||
+            !IsBlobValid(header.indices_offset, header.index_count * sizeof(u32), size) ||
+            !IsBlobValid(header.meshlets_offset, header.meshlet_count * sizeof(Meshlet), size))
+        {
+            LOG_ERROR("'%s' is truncated or corrupt", path.c_str());
+            return false;
+        }
+
+        Mesh loaded;
+        VertexLayout& layout = loaded.vertices.layout;
+        layout.stride = header.vertex_stride;
+        loaded.vertices.vertex_count = header.vertex_count;
+        const auto* attributes =
+            reinterpret_cast<const MeshFileAttribute*>(data + header.attributes_offset);
+        for (u32 i = 0; i < header.attribute_count; ++i)
+        {
+            const MeshFileAttribute& attribute = attributes[i];
+            const Format format = static_cast<Format>(attribute.format);
+            const size_t name_length = strnlen(attribute.name, c_mesh_file_name_size);
+            layout.attributes.push_back({std::string(attribute.name, name_length), format,
+                attribute.offset, attribute.stride});
+            if (name_length == c_mesh_file_name_size ||
+                !loaded.vertices.IsInRange(layout.attributes.back()))
+            {
+                LOG_ERROR("'%s' has an invalid vertex attribute %u", path.c_str(), i);
+                return false;
+            }
+        }
+
+        const auto* meshlets = reinterpret_cast<const Meshlet*>(data + header.meshlets_offset);
+        loaded.meshlets.assign(meshlets, meshlets + header.meshlet_count);
+        u64 meshlets_end = 0;
+        for (const Meshlet& meshlet : loaded.meshlets)
+        {
+            if (meshlet.first_index % 3 != 0 || meshlet.first_index < meshlets_end ||
+                meshlet.first_index > header.index_count ||
+                meshlet.triangle_count > (header.index_count - meshlet.first_index) / 3)
+            {
+                LOG_ERROR("'%s' has a meshlet that is misplaced in its index buffer",
+                    path.c_str());
+                return false;
+            }
+            meshlets_end = meshlet.first_index + u64 {meshlet.triangle_count} * 3;
+        }
+
+        loaded.vertices.external_data = data + header.vertices_offset;
+        loaded.indices.external_indices =
+            reinterpret_cast<const u32*>(data + header.indices_offset);
+        loaded.indices.external_count = header.index_count;
+        loaded.storage = std::move(file);
+        mesh = std::move(loaded);
+        return true;
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,353 @@
+#include "mesh/mesh_optimizer.hpp"
+#include "log.hpp"
+
+#include <cstring>
+
+namespace Rasterizer
+{
+
+    // Copies external vertex and index data into the mesh so it can be rewritten.
+    static void MakeOwned(Mesh& mesh)
+    {
+        VertexBuffer& vertices = mesh.vertices;
+        if (vertices.external_data)
+        {
+            vertices.data.assign(vertices.external_data,
+                vertices.external_data + vertices.GetSize());
+            vertices.external_data = nullptr;
+        }
+        IndexBuffer& indices = mesh.indices;
+        if (indices.external_indices)
+        {
+            indices.indices.assign(indices.external_indices,
+                indices.external_indices + indices.external_count);
+            indices.external_indices = nullptr;
+            indices.external_count = 0;
+        }
+        mesh.storage.reset();
+    }
+
+    void OptimizeVertexCache(std::vector<u32>& indices, size_t vertex_count, u32 cache_size)
+    {
+        const size_t triangle_count = indices.size() / 3;
+        std::vector<u32> output;
+        output.reserve(indices.size());
+        std::vector<u32> invalid;
+
+        // Triangles left to emit per vertex, then the vertex -> triangle adjacency.
+        std::vector<u32> live(vertex_count, 0);
+        std::vector<u8> emitted(triangle_count, 0);
+        for (size_t t = 0; t < triangle_count; ++t)
+        {
+            const u32* corners = indices.data() + t * 3;
+            if (corners[0] >= vertex_count || corners[1] >= vertex_count ||
+                corners[2] >= vertex_count)
+            {
+                invalid.insert(invalid.end(), corners, corners + 3);
+                emitted[t] = 1;
+                continue;
+            }
+            for (u32 c = 0; c < 3; ++c)
+            {
+                ++live[corners[c]];
+            }
+        }
+        std::vector<u32> adjacency_offsets(vertex_count + 1, 0);
+        for (size_t v = 0; v < vertex_count; ++v)
+        {
+            adjacency_offsets[v + 1] = adjacency_offsets[v] + live[v];
+        }
+        std::vector<u32> adjacency(adjacency_offsets[vertex_count]);
+        {
+            std::vector<u32> cursors(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (size_t t = 0; t < triangle_count; ++t)
+            {
+                for (u32 c = 0; c < 3 && !emitted[t]; ++c)
+                {
+                    adjacency[cursors[indices[t * 3 + c]]++] = static_cast<u32>(t);
+                }
+            }
+        }
+
+        // Time each vertex last entered the simulated FIFO cache.
+        std::vector<u32> cache_time(vertex_count, 0);
+        u32 timestamp = cache_size + 1;
+        std::vector<u32> dead_end;
+        std::vector<u32> candidates;
+        size_t cursor = 0;
+
+        // Next fanning vertex once the candidates are exhausted: the most recently used live
+        // vertex, or else the next live one in input order.
+        auto skip_dead_end = [&]() -> i64
+        {
+            while (!dead_end.empty())
+            {
+                const u32 vertex = dead_end.back();
+                dead_end.pop_back();
+                if (live[vertex] > 0)
+                {
+                    return vertex;
+                }
+            }
+            for (; cursor < vertex_count; ++cursor)
+            {
+                if (live[cursor] > 0)
+                {
+                    return static_cast<i64>(cursor);
+                }
+            }
+            return -1;
+        };
+
+        i64 fanning = skip_dead_end();
+        while (fanning >= 0)
+        {
+            candidates.clear();
+            const u32 vertex = static_cast<u32>(fanning);
+            for (u32 a = adjacency_offsets[vertex]; a < adjacency_offsets[vertex + 1]; ++a)
+            {
+                const u32 t = adjacency[a];
+                if (emitted[t])
+                {
+                    continue;
+                }
+                emitted[t] = 1;
+                for (u32 c = 0; c < 3; ++c)
+                {
+                    const u32 corner = indices[t * 3 + c];
+                    output.push_back(corner);
+                    dead_end.push_back(corner);
+                    candidates.push_back(corner);
+                    --live[corner];
+                    if (timestamp - cache_time[corner] > cache_size)
+                    {
+                        cache_time[corner] = timestamp++;
+                    }
+                }
+            }
+
+            // Prefer the candidate that has been in the cache longest but will still be there
+            // after its remaining triangles are emitted.
+            fanning = -1;
+            i64 best_priority = -1;
+            for (u32 candidate : candidates)
+            {
+                if (live[candidate] == 0)
+                {
+                    continue;
+                }
+                i64 priority = 0;
+                const u32 age = timestamp - cache_time[candidate];
+                if (age + 2 * live[candidate] <= cache_size)
+                {
+                    priority = age;
+                }
+                if (priority > best_priority)
+                {
+                    best_priority = priority;
+                    fanning = candidate;
+                }
+            }
+            if (fanning < 0)
+            {
+                fanning = skip_dead_end();
+            }
+        }
+
+        output.insert(output.end(), invalid.begin(), invalid.end());
+        output.insert(output.end(), indices.begin() + triangle_count * 3, indices.end());
+        indices = std::move(output);
+    }
+
+    void OptimizeVertexFetch(Mesh& mesh)
+    {
+        if (!mesh.IsIndexed())
+        {
+            return;
+        }
+        MakeOwned(mesh);
+
+        VertexBuffer& vertices = mesh.vertices;
+        std::vector<u32> remap(vertices.vertex_count, ~0u);
+        std::vector<u32> order;
+        for (u32& index : mesh.indices.indices)
+        {
+            if (index >= vertices.vertex_count)
+            {
+                index = ~0u;
+                continue;
+            }
+            if (remap[index] == ~0u)
+            {
+                remap[index] = static_cast<u32>(order.size());
+                order.push_back(index);
+            }
+            index = remap[index];
+        }
+
+        VertexBuffer reordered;
+        reordered.vertex_count = order.size();
+        if (vertices.layout.IsInterleaved())
+        {
+            const size_t stride = vertices.layout.stride;
+            reordered.layout = vertices.layout;
+            reordered.data.resize(reordered.GetSize());
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                std::memcpy(reordered.data.data() + i * stride, vertices.GetVertex(order[i]),
+                    stride);
+            }
+        }
+        else
+        {
+            // Streams are rebuilt tightly packed, one per attribute.
+            for (const VertexAttribute& attribute : vertices.layout.attributes)
+            {
+                const size_t size = FormatSize(attribute.format);
+                reordered.layout.attributes.push_back({attribute.name, attribute.format,
+                    reordered.layout.stride * order.size(), size});
+                reordered.layout.stride += size;
+            }
+            reordered.data.resize(reordered.GetSize());
+            for (size_t a = 0; a < vertices.layout.attributes.size(); ++a)
+            {
+                const VertexAttribute& source = vertices.layout.attributes[a];
+                const VertexAttribute& destination = reordered.layout.attributes[a];
+                for (size_t i = 0; i < order.size(); ++i)
+                {
+                    u8* element = reordered.data.data() + destination.offset +
+                        i * destination.stride;
+                    std::memcpy(element, vertices.GetAttribute(source, order[i]),
+                        destination.stride);
+                }
+            }
+        }
+        vertices = std::move(reordered);
+    }
+
+    bool BuildMeshlets(Mesh& mesh, u32 max_vertices, u32 max_triangles)
+    {
+        const VertexBuffer& vertices = mesh.vertices;
+        const VertexAttribute* position = vertices.layout.Find("POSITION");
+        if (!mesh.IsIndexed() || !position || position->format != Format::Vec3 ||
+            !vertices.IsInRange(*position))
+        {
+            LOG_ERROR("Meshlets need an indexed mesh with a Vec3 POSITION attribute");
+            return false;
+        }
+        max_vertices = std::max(max_vertices, 3u);
+        max_triangles = std::max(max_triangles, 1u);
+
+        auto read_position = [&](u32 index)
+        {
+            Vec3 p;
+            std::memcpy(&p, vertices.GetAttribute(*position, index), sizeof(Vec3));
+            return p;
+        };
+
+        const u32* indices = mesh.indices.GetData();
+        const u32 triangle_count = mesh.GetTriangleCount();
+        const size_t vertex_count = vertices.vertex_count;
+        std::vector<u32> marker(vertex_count, ~0u);
+        std::vector<u32> meshlet_vertices;
+        mesh.meshlets.clear();
+
+        auto close_meshlet = [&](u32 first_triangle, u32 end_triangle)
+        {
+            Meshlet meshlet = {};
+            meshlet.first_index = first_triangle * 3;
+            meshlet.triangle_count = end_triangle - first_triangle;
+
+            Vec3 lower = {1e30f, 1e30f, 1e30f};
+            Vec3 upper = {-1e30f, -1e30f, -1e30f};
+            for (u32 index : meshlet_vertices)
+            {
+                const Vec3 p = read_position(index);
+                lower = {std::min(lower.x, p.x), std::min(lower.y, p.y), std::min(lower.z, p.z)};
+                upper = {std::max(upper.x, p.x), std::max(upper.y, p.y), std::max(upper.z, p.z)};
+            }
+            meshlet.center = meshlet_vertices.empty() ? Vec3 {} : (lower + upper) * 0.5f;
+            for (u32 index : meshlet_vertices)
+            {
+                const Vec3 offset = read_position(index) - meshlet.center;
+                meshlet.radius = std::max(meshlet.radius, std::sqrt(Dot(offset, offset)));
+            }
+
+            // Counter-clockwise triangles are front facing, so Cross(p1 - p0, p2 - p0) is
+            // the outward normal.
+            std::vector<Vec3> normals;
+            Vec3 sum = {};
+            for (u32 t = first_triangle; t < end_triangle; ++t)
+            {
+                const u32* corners = indices + t * 3;
+                if (corners[0] >= vertex_count || corners[1] >= vertex_count ||
+                    corners[2] >= vertex_count)
+                {
+                    continue;
+                }
+                const Vec3 p0 = read_position(corners[0]);
+                const Vec3 normal = Cross(read_position(corners[1]) - p0,
+                    read_position(corners[2]) - p0);
+                if (Dot(normal, normal) > 0.0f)
+                {
+                    normals.push_back(Normalize(normal));
+                    sum = sum + normals.back();
+                }
+            }
+            meshlet.cone_cutoff = -1.0f;
+            if (Dot(sum, sum) > 1e-12f)
+            {
+                meshlet.cone_axis = Normalize(sum);
+                meshlet.cone_cutoff = 1.0f;
+                for (const Vec3& normal : normals)
+                {
+                    meshlet.cone_cutoff = std::min(meshlet.cone_cutoff,
+                        Dot(normal, meshlet.cone_axis));
+                }
+            }
+            mesh.meshlets.push_back(meshlet);
+            meshlet_vertices.clear();
+        };
+
+        u32 first_triangle = 0;
+        for (u32 t = 0; t < triangle_count; ++t)
+        {
+            const u32 id = static_cast<u32>(mesh.meshlets.size());
+            const u32* corners = indices + t * 3;
+            u32 new_vertices = 0;
+            for (u32 c = 0; c < 3; ++c)
+            {
+                const u32 index = corners[c];
+                const bool repeated = (c > 0 && index == corners[0]) ||
+                    (c > 1 && index == corners[1]);
+                if (index < vertex_count && marker[index] != id && !repeated)
+                {
+                    ++new_vertices;
+                }
+            }
+            if (t > first_triangle && (t - first_triangle == max_triangles ||
+                meshlet_vertices.size() + new_vertices > max_vertices))
+            {
+                close_meshlet(first_triangle, t);
+                first_triangle = t;
+            }
+
+            const u32 current = static_cast<u32>(mesh.meshlets.size());
+            for (u32 c = 0; c < 3; ++c)
+            {
+                const u32 index = corners[c];
+                if (index < vertex_count && marker[index] != current)
+                {
+                    marker[index] = current;
+                    meshlet_vertices.push_back(index);
+                }
+            }
+        }
+        if (triangle_count > first_triangle)
+        {
+            close_meshlet(first_triangle, triangle_count);
+        }
+        return true;
+    }
+
+} // namespace Rasterizer
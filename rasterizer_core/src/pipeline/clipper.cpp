@@ -0,0 +1,105 @@
+#include "pipeline/clipper.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rasterizer
+{
+
+    static f32 PlaneDistance(const f32* position, u32 plane, GuardBand guard_band)
+    {
+        const f32 x = position[0];
+        const f32 y = position[1];
+        const f32 z = position[2];
+        const f32 w = position[3];
+        switch (plane)
+        {
+        case 0: return guard_band.x * w + x;
+        case 1: return guard_band.x * w - x;
+        case 2: return guard_band.y * w + y;
+        case 3: return guard_band.y * w - y;
+        case 4: return z;
+        default: return w - z;
+        }
+    }
+
+    GuardBand ComputeGuardBand(u32 width, u32 height)
+    {
+        // NDC spans half the viewport on each side of the center.
+        return {std::max(c_guard_band_pixels * 2.0f / static_cast<f32>(width), 1.0f),
+            std::max(c_guard_band_pixels * 2.0f / static_cast<f32>(height), 1.0f)};
+    }
+
+    u32 ComputeOutcode(const f32* position, GuardBand guard_band)
+    {
+        u32 outcode = 0;
+        for (u32 plane = 0; plane < 6; ++plane)
+        {
+            if (PlaneDistance(position, plane, guard_band) < 0.0f)
+            {
+                outcode |= 1u << plane;
+            }
+        }
+        return outcode;
+    }
+
+    u32 ClipTriangle(const f32* v0, const f32* v1, const f32* v2, u32 vertex_floats, f32* out,
+        f32* scratch, GuardBand guard_band)
+    {
+        const size_t vertex_bytes = sizeof(f32) * vertex_floats;
+        std::memcpy(out, v0, vertex_bytes);
+        std::memcpy(out + vertex_floats, v1, vertex_bytes);
+        std::memcpy(out + 2 * vertex_floats, v2, vertex_bytes);
+
+        const u32 outcode = ComputeOutcode(v0, guard_band) | ComputeOutcode(v1, guard_band) |
+            ComputeOutcode(v2, guard_band);
+
+        f32* source = out;
+        f32* destination = scratch;
+        u32 count = 3;
+
+        for (u32 plane = 0; plane < 6 && count > 0; ++plane)
+        {
+            if ((outcode & (1u << plane)) == 0)
+            {
+                continue;
+            }
+
+            u32 written = 0;
+            for (u32 i = 0; i < count; ++i)
+            {
+                const f32* current = source + i * vertex_floats;
+                const f32* next = source + ((i + 1) % count) * vertex_floats;
+                const f32 d_current = PlaneDistance(current, plane, guard_band);
+                const f32 d_next = PlaneDistance(next, plane, guard_band);
+
+                if (d_current >= 0.0f)
+                {
+                    std::memcpy(destination + written * vertex_floats, current, vertex_bytes);
+                    ++written;
+                }
+
+                if ((d_current >= 0.0f) != (d_next >= 0.0f))
+                {
+                    const f32 t = d_current / (d_current - d_next);
+                    f32* result = destination + written * vertex_floats;
+                    for (u32 k = 0; k < vertex_floats; ++k)
+                    {
+                        result[k] = current[k] + (next[k] - current[k]) * t;
+                    }
+                    ++written;
+                }
+            }
+
+            count = written;
+            std::swap(source, destination);
+        }
+
+        if (source != out)
+        {
+            std::memcpy(out, source, vertex_bytes * count);
+        }
+        return count < 3 ? 0 : count;
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,60 @@
+#pragma once
+#include "Core.h"
+
+namespace Rasterizer
+{
+
+    // A triangle clipped by six planes gains at most one vertex per plane.
+    constexpr u32 c_max_clip_vertices = 9;
+
+    // Pixels the guard band reaches out from the viewport center along each axis. Clipped
+    // vertices stay within +-16K pixels of the origin, which keeps the float edge functions
+    // well below a pixel of error and inside a 16-bit integer grid.
+    constexpr f32 c_guard_band_pixels = 8192.0f;
+
+    enum ClipPlaneBits : u32
+    {
+        ClipLeft = 1 << 0,
+        ClipRight = 1 << 1,
+        ClipBottom = 1 << 2,
+        ClipTop = 1 << 3,
+        ClipNear = 1 << 4,
+        ClipFar = 1 << 5,
+    };
+
+    /**
+     * @brief Clip-space extent of the guard band: the side planes are |x| <= x * w and
+     * |y| <= y * w. {1, 1} is the viewport itself.
+     */
+    struct GuardBand
+    {
+        f32 x {1.0f};
+        f32 y {1.0f};
+    };
+
+    /**
+     * @brief Guard band of c_guard_band_pixels for a width x height viewport, never smaller
+     * than the viewport.
+     */
+    GuardBand ComputeGuardBand(u32 width, u32 height);
+
+    /**
+     * @brief Returns the set of planes a clip-space position lies outside of. The side planes
+     * are those of the guard band, so the default tests against the view frustum.
+     */
+    u32 ComputeOutcode(const f32* position, GuardBand guard_band = {});
+
+    /**
+     * @brief Sutherland-Hodgman clip of a triangle against the [-gx * w, gx * w] x
+     * [-gy * w, gy * w] x [0, w] volume of a guard band. Only the planes set in the
+     * guard-band outcodes of the vertices are clipped against. Vertices are vertex_floats
+     * floats long with the clip position first; all other floats are interpolated linearly
+     * along the clipped edges.
+     * @param out Receives the clipped convex polygon, c_max_clip_vertices vertices large.
+     * @param scratch Temporary storage of the same size as out.
+     * @return Number of vertices written to out, 0 if the triangle is entirely outside.
+     */
+    u32 ClipTriangle(const f32* v0, const f32* v1, const f32* v2, u32 vertex_floats, f32* out,
+        f32* scratch, GuardBand guard_band = {});
+
+} // namespace Rasterizer
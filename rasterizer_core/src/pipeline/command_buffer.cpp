@@ -0,0 +1,127 @@
+#include "pipeline/command_buffer.hpp"
+#include "platform/profiler.hpp"
+#include "log.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+namespace Rasterizer
+{
+
+    namespace
+    {
+        struct DrawCulledOperands
+        {
+            const Mesh* mesh;
+            MeshletCulling culling;
+        };
+
+        // Operands are packed without padding, so they are copied rather than dereferenced.
+        template <typename T>
+        T ReadOperands(const u8*& cursor)
+        {
+            T operands;
+            std::memcpy(&operands, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return operands;
+        }
+    }
+
+    template <typename T>
+    void CommandBuffer::Record(Opcode opcode, const T& operands)
+    {
+        STATIC_ASSERT(std::is_trivially_copyable_v<T>, "Command operands are copied bytewise");
+        const size_t offset = m_commands.size();
+        m_commands.resize(offset + 1 + sizeof(T));
+        m_commands[offset] = static_cast<u8>(opcode);
+        std::memcpy(m_commands.data() + offset + 1, &operands, sizeof(T));
+    }
+
+    void CommandBuffer::BindPipeline(Pipeline& pipeline)
+    {
+        Record(Opcode::BindPipeline, &pipeline);
+        m_pipeline_bound = true;
+    }
+
+    void CommandBuffer::BindUniforms(const UniformBlock& uniforms)
+    {
+        Record(Opcode::BindUniforms, uniforms);
+    }
+
+    void CommandBuffer::BindUniforms(const UniformBuffer& uniforms)
+    {
+        if (uniforms.GetVersion() != m_uniform_version)
+        {
+            void* data = m_uniforms.Allocate(uniforms.GetSize(), c_uniform_alignment);
+            std::memcpy(data, uniforms.GetData(), uniforms.GetSize());
+            m_uniform_version = uniforms.GetVersion();
+            m_uniform_copy = {data, uniforms.GetSize()};
+        }
+        BindUniforms(m_uniform_copy);
+    }
+
+    void CommandBuffer::Draw(const Mesh& mesh, const MeshletCulling* culling)
+    {
+        if (!m_pipeline_bound)
+        {
+            LOG_ERROR("Command buffer draw recorded without a pipeline bound, skipped");
+            return;
+        }
+        if (culling)
+        {
+            Record(Opcode::DrawCulled, DrawCulledOperands {&mesh, *culling});
+        }
+        else
+        {
+            Record(Opcode::Draw, &mesh);
+        }
+        ++m_draw_count;
+    }
+
+    void CommandBuffer::Reset()
+    {
+        m_commands.clear();
+        m_uniforms.Reset();
+        m_uniform_version = 0;
+        m_uniform_copy = {};
+        m_pipeline_bound = false;
+        m_draw_count = 0;
+    }
+
+    void SubmitCommandBuffers(const std::vector<const CommandBuffer*>& buffers)
+    {
+        PROFILE_ZONE("submit command buffers");
+        for (const CommandBuffer* buffer : buffers)
+        {
+            using Opcode = CommandBuffer::Opcode;
+            Pipeline* pipeline = nullptr;
+            UniformBlock uniforms = {};
+            const u8* cursor = buffer->m_commands.data();
+            const u8* end = cursor + buffer->m_commands.size();
+            while (cursor < end)
+            {
+                const Opcode opcode = static_cast<Opcode>(*cursor++);
+                switch (opcode)
+                {
+                case Opcode::BindPipeline:
+                    pipeline = ReadOperands<Pipeline*>(cursor);
+                    break;
+                case Opcode::BindUniforms:
+                    uniforms = ReadOperands<UniformBlock>(cursor);
+                    break;
+                case Opcode::Draw:
+                    // Draw() only records with a pipeline bound.
+                    pipeline->DrawMesh(*ReadOperands<const Mesh*>(cursor), uniforms);
+                    break;
+                case Opcode::DrawCulled:
+                {
+                    const DrawCulledOperands draw = ReadOperands<DrawCulledOperands>(cursor);
+                    pipeline->DrawMesh(*draw.mesh, uniforms, &draw.culling);
+                    break;
+                }
+                }
+            }
+        }
+    }
+
+} // namespace Rasterizer
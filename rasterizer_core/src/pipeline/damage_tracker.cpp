@@ -0,0 +1,178 @@
+#include "pipeline/damage_tracker.hpp"
+
+#include <bit>
+
+namespace Rasterizer
+{
+
+    void TileMask::Fill()
+    {
+        std::fill(m_words.begin(), m_words.end(), ~0ull);
+        if (m_tile_count % 64 != 0)
+        {
+            m_words.back() = (1ull << (m_tile_count % 64)) - 1;
+        }
+    }
+
+    bool TileMask::IsEmpty() const
+    {
+        return std::all_of(m_words.begin(), m_words.end(), [](u64 word) { return word == 0; });
+    }
+
+    u32 TileMask::Count() const
+    {
+        u32 count = 0;
+        for (u64 word : m_words)
+        {
+            count += static_cast<u32>(std::popcount(word));
+        }
+        return count;
+    }
+
+    TileMask& TileMask::operator|=(const TileMask& other)
+    {
+        for (size_t i = 0; i < m_words.size(); ++i)
+        {
+            m_words[i] |= other.m_words[i];
+        }
+        return *this;
+    }
+
+    void TileMask::GetRects(u32 tiles_x, u32 tile_size, u32 width, u32 height,
+        std::vector<DamageRect>& rects) const
+    {
+        const size_t first_rect = rects.size();
+        const u32 tiles_y = tiles_x ? m_tile_count / tiles_x : 0;
+        for (u32 tile_y = 0; tile_y < tiles_y; ++tile_y)
+        {
+            const u32 y = tile_y * tile_size;
+            const u32 rect_height = std::min(y + tile_size, height) - y;
+            for (u32 tile_x = 0; tile_x < tiles_x;)
+            {
+                if (!Test(tile_y * tiles_x + tile_x))
+                {
+                    ++tile_x;
+                    continue;
+                }
+                const u32 run_begin = tile_x;
+                while (tile_x < tiles_x && Test(tile_y * tiles_x + tile_x))
+                {
+                    ++tile_x;
+                }
+
+                const u32 x = run_begin * tile_size;
+                const DamageRect rect = {x, y, std::min(tile_x * tile_size, width) - x,
+                    rect_height};
+                auto above = std::find_if(rects.begin() + first_rect, rects.end(),
+                    [&rect](const DamageRect& other)
+                    {
+                        return other.x == rect.x && other.width == rect.width &&
+                            other.y + other.height == rect.y;
+                    });
+                if (above != rects.end())
+                {
+                    above->height += rect.height;
+                }
+                else
+                {
+                    rects.push_back(rect);
+                }
+            }
+        }
+    }
+
+    u64 HashBytes(const void* data, size_t size, u64 hash)
+    {
+        const u8* bytes = static_cast<const u8*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    void DamageTracker::Resize(u32 tiles_x, u32 tiles_y)
+    {
+        m_tile_count = tiles_x * tiles_y;
+        for (TileMask& damage : m_history)
+        {
+            damage.Resize(m_tile_count);
+        }
+        m_redraw.Resize(m_tile_count);
+        m_draw_count[0] = 0;
+        m_draw_count[1] = 0;
+        m_history_frames = 0;
+        m_invalidated = true;
+    }
+
+    TileMask& DamageTracker::AddDraw(u64 signature)
+    {
+        std::vector<DrawRecord>& draws = m_draws[m_current];
+        u32& count = m_draw_count[m_current];
+        if (count == draws.size())
+        {
+            draws.emplace_back();
+        }
+        DrawRecord& record = draws[count++];
+        record.signature = signature;
+        // Keeps the capacity of the mask, so steady frames do not allocate.
+        record.tiles.Resize(m_tile_count);
+        return record.tiles;
+    }
+
+    const TileMask& DamageTracker::EndFrame(u32 target_age)
+    {
+        const std::vector<DrawRecord>& current = m_draws[m_current];
+        const std::vector<DrawRecord>& previous = m_draws[m_current ^ 1];
+        const u32 current_count = m_draw_count[m_current];
+        const u32 previous_count = m_draw_count[m_current ^ 1];
+
+        ++m_frame;
+        TileMask& damage = m_history[m_frame % c_max_target_age];
+        damage.Clear();
+        if (m_invalidated)
+        {
+            damage.Fill();
+            m_invalidated = false;
+        }
+        else
+        {
+            for (u32 i = 0; i < std::max(current_count, previous_count); ++i)
+            {
+                if (i >= current_count)
+                {
+                    damage |= previous[i].tiles;
+                }
+                else if (i >= previous_count)
+                {
+                    damage |= current[i].tiles;
+                }
+                else if (current[i].signature != previous[i].signature ||
+                    current[i].tiles != previous[i].tiles)
+                {
+                    damage |= previous[i].tiles;
+                    damage |= current[i].tiles;
+                }
+            }
+        }
+        m_history_frames = std::min(m_history_frames + 1, c_max_target_age);
+
+        if (target_age == 0 || target_age > m_history_frames)
+        {
+            m_redraw.Fill();
+        }
+        else
+        {
+            m_redraw.Clear();
+            for (u32 frame = 0; frame < target_age; ++frame)
+            {
+                m_redraw |= m_history[(m_frame - frame) % c_max_target_age];
+            }
+        }
+
+        m_current ^= 1;
+        m_draw_count[m_current] = 0;
+        return m_redraw;
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,365 @@
+#include "pipeline/deferred_lighting.hpp"
+#include "pipeline/raster_kernel.hpp"
+#include "pipeline/simd.hpp"
+#include "platform/profiler.hpp"
+#include "log.hpp"
+
+#include <bit>
+#include <limits>
+
+namespace Rasterizer
+{
+
+    // CullLights() result of a tile without geometry.
+    static constexpr u32 c_background_tile = ~0u;
+    // Keeps the normalizations of zero vectors finite.
+    static constexpr f32 c_min_length_squared = 1e-12f;
+
+    DeferredLighting::DeferredLighting(JobSystemPtr jobs)
+        : m_jobs(std::move(jobs))
+    {
+        m_tile_lights.resize(m_jobs->GetWorkerCount());
+    }
+
+    DeferredLighting::~DeferredLighting()
+    {
+        Flush();
+    }
+
+    bool DeferredLighting::Shade(const GBuffer& gbuffer, const DepthTarget& depth,
+        const LightingDesc& desc, const std::vector<PointLight>& lights, RenderTarget& output,
+        JobCounter* dependency)
+    {
+        Flush();
+        if (depth.GetWidth() != gbuffer.GetWidth() || depth.GetHeight() != gbuffer.GetHeight() ||
+            output.GetWidth() != gbuffer.GetWidth() || output.GetHeight() != gbuffer.GetHeight())
+        {
+            LOG_ERROR("Deferred lighting failed: the G-buffer, depth target and output must "
+                "share one size");
+            return false;
+        }
+        if (depth.GetSampleCount() != 1)
+        {
+            LOG_ERROR("Deferred lighting failed: depth target has %u samples per pixel, 1 "
+                "expected", depth.GetSampleCount());
+            return false;
+        }
+        const u32 attachment = std::max(desc.albedo_attachment, desc.normal_attachment);
+        if (attachment >= gbuffer.GetAttachmentCount())
+        {
+            LOG_ERROR("Deferred lighting failed: G-buffer has %u attachments, attachment %u is "
+                "read", gbuffer.GetAttachmentCount(), attachment);
+            return false;
+        }
+
+        m_gbuffer = &gbuffer;
+        m_depth = &depth;
+        m_output = &output;
+        m_desc = desc;
+        m_inverse_projection = Inverse(desc.projection);
+
+        const size_t count = lights.size();
+        for (std::vector<f32>* component : {&m_light_x, &m_light_y, &m_light_z,
+            &m_light_radius, &m_light_r, &m_light_g, &m_light_b})
+        {
+            component->resize(count);
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            const PointLight& light = lights[i];
+            m_light_x[i] = light.position.x;
+            m_light_y[i] = light.position.y;
+            m_light_z[i] = light.position.z;
+            m_light_radius[i] = light.radius;
+            m_light_r[i] = light.color.x;
+            m_light_g[i] = light.color.y;
+            m_light_b[i] = light.color.z;
+        }
+        for (std::vector<u32>& tile_lights : m_tile_lights)
+        {
+            tile_lights.resize(count);
+        }
+
+        m_completion.Reset(1);
+        const Job job = {&DeferredLighting::DispatchJob, this, 0, "dispatch lighting",
+            &m_completion};
+        if (dependency)
+        {
+            m_jobs->RunAfter(*dependency, job);
+        }
+        else
+        {
+            m_jobs->Run(job);
+        }
+        return true;
+    }
+
+    void DeferredLighting::Flush()
+    {
+        m_jobs->Wait(m_completion);
+    }
+
+    void DeferredLighting::DispatchJob(void* data, u32, u32)
+    {
+        DeferredLighting& lighting = *static_cast<DeferredLighting*>(data);
+        const u32 tile_count = lighting.m_gbuffer->GetTilesX() * lighting.m_gbuffer->GetTilesY();
+        // Still held by this job, so the counter cannot reach zero before the last tile.
+        lighting.m_completion.Add(tile_count);
+        for (u32 tile = 0; tile < tile_count; ++tile)
+        {
+            lighting.m_jobs->Run({&DeferredLighting::ShadeTileJob, &lighting, tile, "light tile",
+                &lighting.m_completion});
+        }
+    }
+
+    void DeferredLighting::ShadeTileJob(void* data, u32 tile_index, u32 worker_index)
+    {
+        DeferredLighting& lighting = *static_cast<DeferredLighting*>(data);
+        lighting.ShadeTile(tile_index, lighting.m_tile_lights[worker_index]);
+    }
+
+    u32 DeferredLighting::CullLights(u32 tile_x, u32 tile_y, u32* lights) const
+    {
+        const DepthTarget& depth = *m_depth;
+        const f32 background = m_desc.background_depth;
+        const u32 x0 = tile_x * c_hiz_tile_size;
+        const u32 y0 = tile_y * c_hiz_tile_size;
+        const u32 x1 = std::min(x0 + c_hiz_tile_size, depth.GetWidth());
+        const u32 y1 = std::min(y0 + c_hiz_tile_size, depth.GetHeight());
+
+        // Depth bounds of the tile's geometry. A block range bounding geometry and background
+        // reaches the background depth, so those blocks are scanned for their geometry.
+        f32 min_depth = std::numeric_limits<f32>::max();
+        f32 max_depth = std::numeric_limits<f32>::lowest();
+        for (u32 block_y = y0 / c_hiz_block_size; block_y * c_hiz_block_size < y1; ++block_y)
+        {
+            for (u32 block_x = x0 / c_hiz_block_size; block_x * c_hiz_block_size < x1;
+                ++block_x)
+            {
+                const DepthRange& range = depth.GetBlockRange(block_x, block_y);
+                if (range.min >= background)
+                {
+                    continue;
+                }
+                min_depth = std::min(min_depth, range.min);
+                if (range.max < background)
+                {
+                    max_depth = std::max(max_depth, range.max);
+                    continue;
+                }
+                const u32 block_x1 = std::min((block_x + 1) * c_hiz_block_size, x1);
+                const u32 block_y1 = std::min((block_y + 1) * c_hiz_block_size, y1);
+                for (u32 y = block_y * c_hiz_block_size; y < block_y1; ++y)
+                {
+                    for (u32 x = block_x * c_hiz_block_size; x < block_x1; ++x)
+                    {
+                        const f32 value = depth.GetDepth(x, y);
+                        if (value < background)
+                        {
+                            max_depth = std::max(max_depth, value);
+                        }
+                    }
+                }
+            }
+        }
+        if (min_depth > max_depth)
+        {
+            return c_background_tile;
+        }
+
+        // The view-space box of the tile's frustum between those depths.
+        const f32 width = static_cast<f32>(depth.GetWidth());
+        const f32 height = static_cast<f32>(depth.GetHeight());
+        const f32 ndc_x[2] = {static_cast<f32>(x0) / width * 2.0f - 1.0f,
+            static_cast<f32>(x1) / width * 2.0f - 1.0f};
+        const f32 ndc_y[2] = {1.0f - static_cast<f32>(y0) / height * 2.0f,
+            1.0f - static_cast<f32>(y1) / height * 2.0f};
+        const f32 ndc_z[2] = {min_depth, max_depth};
+        Vec3 box_min = {std::numeric_limits<f32>::max(), std::numeric_limits<f32>::max(),
+            std::numeric_limits<f32>::max()};
+        Vec3 box_max = {std::numeric_limits<f32>::lowest(), std::numeric_limits<f32>::lowest(),
+            std::numeric_limits<f32>::lowest()};
+        for (u32 corner = 0; corner < 8; ++corner)
+        {
+            const Vec4 h = m_inverse_projection * Vec4 {ndc_x[corner & 1],
+                ndc_y[(corner >> 1) & 1], ndc_z[corner >> 2], 1.0f};
+            const Vec3 p = Vec3 {h.x, h.y, h.z} * (1.0f / h.w);
+            box_min = {std::min(box_min.x, p.x), std::min(box_min.y, p.y),
+                std::min(box_min.z, p.z)};
+            box_max = {std::max(box_max.x, p.x), std::max(box_max.y, p.y),
+                std::max(box_max.z, p.z)};
+        }
+
+        u32 count = 0;
+        for (u32 i = 0; i < static_cast<u32>(m_light_x.size()); ++i)
+        {
+            const f32 dx = std::max({box_min.x - m_light_x[i], 0.0f, m_light_x[i] - box_max.x});
+            const f32 dy = std::max({box_min.y - m_light_y[i], 0.0f, m_light_y[i] - box_max.y});
+            const f32 dz = std::max({box_min.z - m_light_z[i], 0.0f, m_light_z[i] - box_max.z});
+            if (dx * dx + dy * dy + dz * dz < m_light_radius[i] * m_light_radius[i])
+            {
+                lights[count++] = i;
+            }
+        }
+        return count;
+    }
+
+    void DeferredLighting::ShadeTile(u32 tile_index, std::vector<u32>& lights)
+    {
+        const GBuffer& gbuffer = *m_gbuffer;
+        const DepthTarget& depth = *m_depth;
+        RenderTarget& output = *m_output;
+        const LightingDesc& desc = m_desc;
+        const u32 tile_x = tile_index % gbuffer.GetTilesX();
+        const u32 tile_y = tile_index / gbuffer.GetTilesX();
+        const u32 x0 = tile_x * c_hiz_tile_size;
+        const u32 y0 = tile_y * c_hiz_tile_size;
+        const u32 x1 = std::min(x0 + c_hiz_tile_size, gbuffer.GetWidth());
+        const u32 y1 = std::min(y0 + c_hiz_tile_size, gbuffer.GetHeight());
+
+        const u32 light_count = CullLights(tile_x, tile_y, lights.data());
+        if (light_count == c_background_tile)
+        {
+            output.ClearRect(x0, y0, x1 - x0, y1 - y0, desc.background_color);
+            return;
+        }
+
+        const u32* tile = gbuffer.GetTile(tile_x, tile_y);
+        const u32* albedo_plane = tile + desc.albedo_attachment * c_tile_cache_pixels;
+        const u32* normal_plane = tile + desc.normal_attachment * c_tile_cache_pixels;
+        const Mat4& inverse = m_inverse_projection;
+        const u32* light_indices = lights.data();
+
+        // Pixel centers to NDC, per column and row.
+        const f32 scale_x = 2.0f / static_cast<f32>(gbuffer.GetWidth());
+        const f32 scale_y = -2.0f / static_cast<f32>(gbuffer.GetHeight());
+        const Float8 lane_x = Load8(c_lane_x);
+        const Float8 lane_y = Load8(c_lane_y);
+        const Float8 background = Broadcast8(desc.background_depth);
+        const Float8 zero = Broadcast8(0.0f);
+        const Float8 one = Broadcast8(1.0f);
+        const Float8 two = Broadcast8(2.0f);
+
+        alignas(32) f32 channels[4][c_simd_lanes];
+        alignas(32) f32 normal[4][c_simd_lanes];
+        alignas(32) u32 lit[c_simd_lanes];
+        // Two 4x2 blocks side by side, one row pair of a HiZ block.
+        alignas(32) u32 colors[2 * c_simd_lanes];
+        u64 lit_pixels = 0;
+
+        // Lights the 4x2 block at pixel (x, y) into pixels, background where not covered.
+        auto shade_quad_block = [&](u32 x, u32 y, u32* pixels)
+        {
+            const Float8 z = Load8(depth.GetQuadBlock(x, y));
+            const u32 coverage = LessMask(z, background);
+            std::fill_n(pixels, c_simd_lanes, desc.background_color);
+            if (coverage == 0)
+            {
+                return;
+            }
+            lit_pixels += std::popcount(coverage);
+
+            const Float8 ndc_x = MulAdd8(Broadcast8(static_cast<f32>(x) + 0.5f) + lane_x,
+                Broadcast8(scale_x), Broadcast8(-1.0f));
+            const Float8 ndc_y = MulAdd8(Broadcast8(static_cast<f32>(y) + 0.5f) + lane_y,
+                Broadcast8(scale_y), one);
+            auto unproject_row = [&](u32 row)
+            {
+                return MulAdd8(Broadcast8(inverse.m[row][0]), ndc_x,
+                    MulAdd8(Broadcast8(inverse.m[row][1]), ndc_y,
+                    MulAdd8(Broadcast8(inverse.m[row][2]), z, Broadcast8(inverse.m[row][3]))));
+            };
+            const Float8 inv_w = one / unproject_row(3);
+            const Float8 px = unproject_row(0) * inv_w;
+            const Float8 py = unproject_row(1) * inv_w;
+            const Float8 pz = unproject_row(2) * inv_w;
+
+            const u32 offset = TileCache::QuadBlockOffset(x - x0, y - y0);
+            UnpackColors8(normal_plane + offset, normal[0], normal[1], normal[2], normal[3]);
+            Float8 nx = MulAdd8(Load8(normal[0]), two, Broadcast8(-1.0f));
+            Float8 ny = MulAdd8(Load8(normal[1]), two, Broadcast8(-1.0f));
+            Float8 nz = MulAdd8(Load8(normal[2]), two, Broadcast8(-1.0f));
+            const Float8 inv_length = one / Sqrt8(MulAdd8(nx, nx, MulAdd8(ny, ny,
+                MulAdd8(nz, nz, Broadcast8(c_min_length_squared)))));
+            nx = nx * inv_length;
+            ny = ny * inv_length;
+            nz = nz * inv_length;
+
+            Float8 r = Broadcast8(desc.ambient.x);
+            Float8 g = Broadcast8(desc.ambient.y);
+            Float8 b = Broadcast8(desc.ambient.z);
+            for (u32 i = 0; i < light_count; ++i)
+            {
+                const u32 light = light_indices[i];
+                const Float8 lx = Broadcast8(m_light_x[light]) - px;
+                const Float8 ly = Broadcast8(m_light_y[light]) - py;
+                const Float8 lz = Broadcast8(m_light_z[light]) - pz;
+                const Float8 distance_squared = MulAdd8(lx, lx, MulAdd8(ly, ly,
+                    MulAdd8(lz, lz, Broadcast8(c_min_length_squared))));
+                const f32 inv_radius_squared = 1.0f / (m_light_radius[light] *
+                    m_light_radius[light]);
+                Float8 falloff = Max8(one - distance_squared * Broadcast8(inv_radius_squared),
+                    zero);
+                falloff = falloff * falloff;
+                // N.L over |L| is the cosine of the angle of incidence.
+                const Float8 n_dot_l = Max8(MulAdd8(nx, lx, MulAdd8(ny, ly, nz * lz)), zero);
+                const Float8 intensity = n_dot_l * falloff / Sqrt8(distance_squared);
+                r = MulAdd8(Broadcast8(m_light_r[light]), intensity, r);
+                g = MulAdd8(Broadcast8(m_light_g[light]), intensity, g);
+                b = MulAdd8(Broadcast8(m_light_b[light]), intensity, b);
+            }
+
+            UnpackColors8(albedo_plane + offset, channels[0], channels[1], channels[2],
+                channels[3]);
+            Store8(channels[0], Load8(channels[0]) * r);
+            Store8(channels[1], Load8(channels[1]) * g);
+            Store8(channels[2], Load8(channels[2]) * b);
+            Store8(channels[3], one);
+            PackColors8(channels[0], channels[1], channels[2], channels[3], lit);
+            StoreColors8(pixels, lit, coverage);
+        };
+
+        for (u32 block_y = y0 / c_hiz_block_size; block_y * c_hiz_block_size < y1; ++block_y)
+        {
+            for (u32 block_x = x0 / c_hiz_block_size; block_x * c_hiz_block_size < x1;
+                ++block_x)
+            {
+                const u32 block_x0 = block_x * c_hiz_block_size;
+                const u32 block_y0 = block_y * c_hiz_block_size;
+                const u32 columns = std::min(c_hiz_block_size, x1 - block_x0);
+                const u32 rows = std::min(c_hiz_block_size, y1 - block_y0);
+                if (depth.GetBlockRange(block_x, block_y).min >= desc.background_depth)
+                {
+                    output.ClearRect(block_x0, block_y0, columns, rows, desc.background_color);
+                    continue;
+                }
+                for (u32 y = block_y0; y < block_y0 + rows; y += 2)
+                {
+                    shade_quad_block(block_x0, y, colors);
+                    shade_quad_block(block_x0 + 4, y, colors + c_simd_lanes);
+                    if (columns == c_hiz_block_size && y + 2 <= y1)
+                    {
+                        QuadBlocksToRows8(colors, output.GetRow(y) + block_x0,
+                            output.GetRow(y + 1) + block_x0);
+                        continue;
+                    }
+                    // At the right or bottom edge of the target.
+                    for (u32 i = 0; i < 2 * c_simd_lanes; ++i)
+                    {
+                        const u32 lane = i % c_simd_lanes;
+                        const u32 x = block_x0 + (i / c_simd_lanes) * 4 +
+                            static_cast<u32>(c_lane_x[lane]);
+                        const u32 pixel_y = y + static_cast<u32>(c_lane_y[lane]);
+                        if (x < x1 && pixel_y < y1)
+                        {
+                            output.GetRow(pixel_y)[x] = colors[i];
+                        }
+                    }
+                }
+            }
+        }
+        PROFILE_COUNT("tile lights", light_count);
+        PROFILE_COUNT("lit pixels", lit_pixels);
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,114 @@
+#include "pipeline/depth_target.hpp"
+
+#include <limits>
+
+namespace Rasterizer
+{
+
+    DepthTarget::DepthTarget(u32 width, u32 height, u32 samples)
+        : m_samples(std::max(samples, 1u)), m_width(width), m_height(height)
+    {
+        m_blocks_x = (width + c_hiz_block_size - 1) / c_hiz_block_size;
+        m_blocks_y = (height + c_hiz_block_size - 1) / c_hiz_block_size;
+        m_tiles_x = (width + c_hiz_tile_size - 1) / c_hiz_tile_size;
+        m_tiles_y = (height + c_hiz_tile_size - 1) / c_hiz_tile_size;
+        m_padded_width = m_blocks_x * c_hiz_block_size;
+
+        m_plane_size = static_cast<size_t>(m_padded_width) * m_blocks_y * c_hiz_block_size;
+        m_depths.resize(m_plane_size * m_samples);
+        m_block_ranges.resize(static_cast<size_t>(m_blocks_x) * m_blocks_y);
+        m_tile_ranges.resize(static_cast<size_t>(m_tiles_x) * m_tiles_y);
+        Clear();
+    }
+
+    f32 DepthTarget::GetDepth(u32 x, u32 y, u32 sample) const
+    {
+        return m_depths[sample * m_plane_size + QuadBlockOffset(x, y)];
+    }
+
+    void DepthTarget::RefreshBlock(u32 block_x, u32 block_y)
+    {
+        const u32 x0 = block_x * c_hiz_block_size;
+        const u32 y0 = block_y * c_hiz_block_size;
+        const u32 x1 = std::min(x0 + c_hiz_block_size, m_width);
+        const u32 y1 = std::min(y0 + c_hiz_block_size, m_height);
+
+        DepthRange range = {std::numeric_limits<f32>::max(), std::numeric_limits<f32>::lowest()};
+        for (size_t plane = 0; plane < m_depths.size(); plane += m_plane_size)
+        {
+            for (u32 y = y0; y < y1; ++y)
+            {
+                for (u32 x = x0; x < x1; ++x)
+                {
+                    const f32 depth = m_depths[plane + QuadBlockOffset(x, y)];
+                    range.min = std::min(range.min, depth);
+                    range.max = std::max(range.max, depth);
+                }
+            }
+        }
+        m_block_ranges[block_y * m_blocks_x + block_x] = range;
+    }
+
+    void DepthTarget::RefreshTile(u32 tile_x, u32 tile_y)
+    {
+        constexpr u32 c_blocks_per_tile = c_hiz_tile_size / c_hiz_block_size;
+        const u32 block_x0 = tile_x * c_blocks_per_tile;
+        const u32 block_y0 = tile_y * c_blocks_per_tile;
+        const u32 block_x1 = std::min(block_x0 + c_blocks_per_tile, m_blocks_x);
+        const u32 block_y1 = std::min(block_y0 + c_blocks_per_tile, m_blocks_y);
+
+        DepthRange range = {std::numeric_limits<f32>::max(), std::numeric_limits<f32>::lowest()};
+        for (u32 block_y = block_y0; block_y < block_y1; ++block_y)
+        {
+            for (u32 block_x = block_x0; block_x < block_x1; ++block_x)
+            {
+                const DepthRange& block = m_block_ranges[block_y * m_blocks_x + block_x];
+                range.min = std::min(range.min, block.min);
+                range.max = std::max(range.max, block.max);
+            }
+        }
+        m_tile_ranges[tile_y * m_tiles_x + tile_x] = range;
+    }
+
+    void DepthTarget::Clear(f32 depth)
+    {
+        std::fill(m_depths.begin(), m_depths.end(), depth);
+        std::fill(m_block_ranges.begin(), m_block_ranges.end(), DepthRange {depth, depth});
+        std::fill(m_tile_ranges.begin(), m_tile_ranges.end(), DepthRange {depth, depth});
+    }
+
+    void DepthTarget::ClearRect(u32 x, u32 y, u32 width, u32 height, f32 depth)
+    {
+        // Whole blocks including their padding past the target, like Clear().
+        const u32 block_x0 = x / c_hiz_block_size;
+        const u32 block_y0 = y / c_hiz_block_size;
+        const u32 block_x1 = (x + width + c_hiz_block_size - 1) / c_hiz_block_size;
+        const u32 block_y1 = (y + height + c_hiz_block_size - 1) / c_hiz_block_size;
+        const u32 x0 = block_x0 * c_hiz_block_size;
+        const u32 x1 = block_x1 * c_hiz_block_size;
+        for (size_t plane = 0; plane < m_depths.size(); plane += m_plane_size)
+        {
+            // The 4x2 blocks of a row pair are consecutive.
+            for (u32 row = block_y0 * c_hiz_block_size; row < block_y1 * c_hiz_block_size;
+                row += 2)
+            {
+                std::fill_n(m_depths.data() + plane + QuadBlockOffset(x0, row), (x1 - x0) * 2,
+                    depth);
+            }
+        }
+        for (u32 block_y = block_y0; block_y < block_y1; ++block_y)
+        {
+            std::fill_n(m_block_ranges.data() + block_y * m_blocks_x + block_x0,
+                block_x1 - block_x0, DepthRange {depth, depth});
+        }
+        const u32 tile_x0 = x / c_hiz_tile_size;
+        const u32 tile_x1 = (x + width + c_hiz_tile_size - 1) / c_hiz_tile_size;
+        for (u32 tile_y = y / c_hiz_tile_size;
+            tile_y < (y + height + c_hiz_tile_size - 1) / c_hiz_tile_size; ++tile_y)
+        {
+            std::fill_n(m_tile_ranges.data() + tile_y * m_tiles_x + tile_x0, tile_x1 - tile_x0,
+                DepthRange {depth, depth});
+        }
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,26 @@
+#include "pipeline/gbuffer.hpp"
+
+namespace Rasterizer
+{
+
+    GBuffer::GBuffer(u32 width, u32 height, u32 attachment_count)
+        : m_width(width), m_height(height), m_attachment_count(attachment_count)
+    {
+        m_tiles_x = (width + c_hiz_tile_size - 1) / c_hiz_tile_size;
+        m_tiles_y = (height + c_hiz_tile_size - 1) / c_hiz_tile_size;
+        m_pixels.resize(TileOffset(0, m_tiles_y), 0);
+    }
+
+    u32 GBuffer::GetPixel(u32 attachment, u32 x, u32 y) const
+    {
+        const u32* tile = GetTile(x / c_hiz_tile_size, y / c_hiz_tile_size);
+        return tile[attachment * c_tile_cache_pixels +
+            TileCache::PixelOffset(x % c_hiz_tile_size, y % c_hiz_tile_size)];
+    }
+
+    void GBuffer::Clear(u32 value)
+    {
+        std::fill(m_pixels.begin(), m_pixels.end(), value);
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,149 @@
+#include "pipeline/input_layout.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rasterizer
+{
+
+    // Fixed-size copies compile to plain loads and stores.
+    template <u32 Size>
+    static void GatherElements(u8* destination, u32 destination_stride, const u8* source,
+        size_t source_stride, u32, const u32* indices, u32 count)
+    {
+        for (u32 i = 0; i < count; ++i)
+        {
+            std::memcpy(destination + static_cast<size_t>(i) * destination_stride,
+                source + indices[i] * source_stride, Size);
+        }
+    }
+
+    static void GatherBytes(u8* destination, u32 destination_stride, const u8* source,
+        size_t source_stride, u32 size, const u32* indices, u32 count)
+    {
+        for (u32 i = 0; i < count; ++i)
+        {
+            std::memcpy(destination + static_cast<size_t>(i) * destination_stride,
+                source + indices[i] * source_stride, size);
+        }
+    }
+
+    // Specialized gathers for fetches of 4 to 32 bytes, indexed by size / 4 - 1.
+    static constexpr GatherFn c_fixed_gathers[] = {
+        GatherElements<4>, GatherElements<8>, GatherElements<12>, GatherElements<16>,
+        GatherElements<20>, GatherElements<24>, GatherElements<28>, GatherElements<32>,
+    };
+
+    static GatherFn SelectGather(u32 size)
+    {
+        constexpr u32 fixed_count = sizeof(c_fixed_gathers) / sizeof(c_fixed_gathers[0]);
+        if (size % 4 == 0 && size >= 4 && size / 4 <= fixed_count)
+        {
+            return c_fixed_gathers[size / 4 - 1];
+        }
+        return GatherBytes;
+    }
+
+    UniquePtr<InputLayout> InputLayout::Create(const VertexLayout& layout,
+        const ShaderReflection& reflection)
+    {
+        UniquePtr<InputLayout> input_layout = MakeUnique<InputLayout>();
+        bool direct = layout.stride >= reflection.input_stride;
+        std::vector<AttributeFetch> fetches;
+        for (u32 i = 0; i < reflection.input_count; ++i)
+        {
+            const ShaderParam& input = reflection.inputs[i];
+            const VertexAttribute* attribute = layout.Find(input.name);
+            if (!attribute)
+            {
+                LOG_ERROR("Mesh missing required attribute %s for vertex shader", input.name);
+                return input_layout;
+            }
+            // The per-vertex bounds depend on the vertex count and are left to IsInRange().
+            const size_t stride = layout.GetStride(*attribute);
+            const u32 size = FormatSize(input.format);
+            if (attribute->format != input.format || size > stride || stride > layout.stride)
+            {
+                LOG_ERROR("Mesh attribute %s does not match the vertex shader input format",
+                    input.name);
+                return input_layout;
+            }
+            fetches.push_back({attribute->offset, static_cast<u32>(stride), input.offset, size,
+                nullptr});
+            direct = direct && attribute->offset == input.offset && stride == layout.stride;
+        }
+
+        // Merge fetches that continue each other in the same stream and in the input.
+        std::sort(fetches.begin(), fetches.end(),
+            [](const AttributeFetch& a, const AttributeFetch& b)
+            {
+                return a.destination_offset < b.destination_offset;
+            });
+        for (const AttributeFetch& fetch : fetches)
+        {
+            AttributeFetch* last = input_layout->m_fetches.empty() ? nullptr :
+                &input_layout->m_fetches.back();
+            if (last && last->source_stride == fetch.source_stride &&
+                last->source_offset + last->size == fetch.source_offset &&
+                last->destination_offset + last->size == fetch.destination_offset)
+            {
+                last->size += fetch.size;
+                continue;
+            }
+            input_layout->m_fetches.push_back(fetch);
+        }
+        for (AttributeFetch& fetch : input_layout->m_fetches)
+        {
+            fetch.gather = SelectGather(fetch.size);
+        }
+        input_layout->m_direct = direct;
+        input_layout->m_valid = true;
+        return input_layout;
+    }
+
+    bool InputLayout::IsInRange(const VertexBuffer& vertices) const
+    {
+        if (vertices.vertex_count == 0)
+        {
+            return true;
+        }
+        // Create() bounds every stride by the layout stride, so this cannot overflow.
+        const size_t size = vertices.GetSize();
+        for (const AttributeFetch& fetch : m_fetches)
+        {
+            if (fetch.source_offset > size ||
+                fetch.source_offset + (vertices.vertex_count - 1) * fetch.source_stride +
+                fetch.size > size)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const InputLayout& InputLayoutCache::Get(const VertexLayout& layout,
+        const ShaderReflection& reflection)
+    {
+        const Key key = {layout.GetId(), &reflection};
+        if (m_last && key == m_last_key)
+        {
+            return *m_last;
+        }
+        UniquePtr<InputLayout>& input_layout = m_layouts[key];
+        if (!input_layout)
+        {
+            input_layout = InputLayout::Create(layout, reflection);
+        }
+        m_last_key = key;
+        m_last = input_layout.get();
+        return *input_layout;
+    }
+
+    void InputLayoutCache::Clear()
+    {
+        m_layouts.clear();
+        m_last = nullptr;
+    }
+
+} // namespace Rasterizer
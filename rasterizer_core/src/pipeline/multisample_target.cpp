@@ -0,0 +1,102 @@
+#include "pipeline/multisample_target.hpp"
+
+#include "pipeline/simd.hpp"
+
+namespace Rasterizer
+{
+
+    MultisampleTarget::MultisampleTarget(RenderTarget& resolve_target)
+        : m_resolve_target(&resolve_target), m_width(resolve_target.GetWidth()),
+        m_height(resolve_target.GetHeight())
+    {
+        m_blocks_x = (m_width + c_msaa_block_size - 1) / c_msaa_block_size;
+        m_blocks_y = (m_height + c_msaa_block_size - 1) / c_msaa_block_size;
+        const size_t block_count = static_cast<size_t>(m_blocks_x) * m_blocks_y;
+        m_samples.resize(block_count * c_msaa_samples * c_msaa_block_pixels);
+        m_block_flags.resize(block_count);
+        Clear(0);
+    }
+
+    void MultisampleTarget::Decompress(u32 block_x, u32 block_y)
+    {
+        u8& flags = m_block_flags[BlockIndex(block_x, block_y)];
+        if (flags & c_block_compressed)
+        {
+            u32* samples = GetBlockSamples(block_x, block_y);
+            for (u32 sample = 1; sample < c_msaa_samples; ++sample)
+            {
+                std::copy_n(samples, c_msaa_block_pixels, samples + sample * c_msaa_block_pixels);
+            }
+        }
+        flags = c_block_unresolved;
+    }
+
+    u32 MultisampleTarget::Resolve(u32 x0, u32 y0, u32 x1, u32 y1)
+    {
+        STATIC_ASSERT(c_msaa_block_size == c_simd_lanes, "A block row resolves as one vector");
+        STATIC_ASSERT(c_msaa_samples == 4, "Resolve averages four samples");
+        u32 resolved = 0;
+        alignas(32) u32 row[c_msaa_block_size];
+        for (u32 block_y = y0 / c_msaa_block_size; block_y <= y1 / c_msaa_block_size; ++block_y)
+        {
+            const u32 py = block_y * c_msaa_block_size;
+            const u32 rows = std::min(c_msaa_block_size, m_height - py);
+            for (u32 block_x = x0 / c_msaa_block_size; block_x <= x1 / c_msaa_block_size;
+                ++block_x)
+            {
+                u8& flags = m_block_flags[BlockIndex(block_x, block_y)];
+                if (!(flags & c_block_unresolved))
+                {
+                    continue;
+                }
+                flags &= ~c_block_unresolved;
+                ++resolved;
+
+                const u32 px = block_x * c_msaa_block_size;
+                const u32 columns = std::min(c_msaa_block_size, m_width - px);
+                const u32* samples = GetBlockSamples(block_x, block_y);
+                for (u32 y = 0; y < rows; ++y)
+                {
+                    const u32* plane_row = samples + y * c_msaa_block_size;
+                    const u32* resolved_row = plane_row;
+                    if (!(flags & c_block_compressed))
+                    {
+                        AverageColors8(plane_row, plane_row + c_msaa_block_pixels,
+                            plane_row + 2 * c_msaa_block_pixels,
+                            plane_row + 3 * c_msaa_block_pixels, row);
+                        resolved_row = row;
+                    }
+                    std::copy_n(resolved_row, columns, m_resolve_target->GetRow(py + y) + px);
+                }
+            }
+        }
+        return resolved;
+    }
+
+    void MultisampleTarget::Clear(u32 color)
+    {
+        for (size_t block = 0; block < m_block_flags.size(); ++block)
+        {
+            std::fill_n(m_samples.data() + block * c_msaa_samples * c_msaa_block_pixels,
+                c_msaa_block_pixels, color);
+        }
+        std::fill(m_block_flags.begin(), m_block_flags.end(), c_block_compressed);
+        m_resolve_target->Clear(color);
+    }
+
+    void MultisampleTarget::ClearRect(u32 x, u32 y, u32 width, u32 height, u32 color)
+    {
+        for (u32 block_y = y / c_msaa_block_size;
+            block_y < (y + height + c_msaa_block_size - 1) / c_msaa_block_size; ++block_y)
+        {
+            for (u32 block_x = x / c_msaa_block_size;
+                block_x < (x + width + c_msaa_block_size - 1) / c_msaa_block_size; ++block_x)
+            {
+                std::fill_n(GetBlockSamples(block_x, block_y), c_msaa_block_pixels, color);
+                m_block_flags[BlockIndex(block_x, block_y)] = c_block_compressed;
+            }
+        }
+        m_resolve_target->ClearRect(x, y, width, height, color);
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,1335 @@
+#include "pipeline/pipeline.hpp"
+#include "pipeline/clipper.hpp"
+#include "platform/profiler.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace Rasterizer
+{
+
+    /**
+     * @brief Output of one geometry job. Only its own shade and bin jobs write it; raster
+     * jobs read it once the whole draw is binned. The arrays live in the frame arenas of the
+     * workers that ran those jobs.
+     */
+    struct Pipeline::GeometryChunk
+    {
+        // triangle_count records of m_triangle_stride bytes, see TriangleSetup.
+        u8* triangles {nullptr};
+        u32 triangle_count {0};
+        // The triangles of tile t are bin_triangles[bin_offsets[t]] up to bin_offsets[t + 1].
+        u32* bin_offsets {nullptr};
+        u32* bin_triangles {nullptr};
+        JobCounter shaded {};
+
+        TriangleSetup& GetTriangle(u32 index, u32 stride)
+        {
+            return *reinterpret_cast<TriangleSetup*>(
+                triangles + static_cast<size_t>(index) * stride);
+        }
+        const TriangleSetup& GetTriangle(u32 index, u32 stride) const
+        {
+            return *reinterpret_cast<const TriangleSetup*>(
+                triangles + static_cast<size_t>(index) * stride);
+        }
+    };
+
+    /**
+     * @brief Everything one queued draw needs while its jobs are in flight.
+     */
+    struct Pipeline::DrawContext
+    {
+        Pipeline* pipeline {nullptr};
+        const Mesh* mesh {nullptr};
+        // The block passed to DrawMesh(), immutable until Flush().
+        const void* uniforms {nullptr};
+        // Owned by the pipeline's cache, which is only cleared while no draw is queued.
+        const InputLayout* input_layout {nullptr};
+        // Model-space frustum planes, normalized with the inside positive, and the eye of
+        // the draw's MeshletCulling; only used when cull_meshlets is set.
+        bool cull_meshlets {false};
+        Vec4 frustum_planes[6] {};
+        Vec3 camera_position {};
+        u32 triangle_count {0};
+        // Hash of the draw's inputs for incremental rendering, see DamageTracker.
+        u64 signature {0};
+
+        std::vector<UniquePtr<GeometryChunk>> chunks {};
+        u32 chunk_count {0};
+        JobCounter binned {};
+        // Released once DispatchTilesJob() filled in tile_last.
+        JobCounter dispatched {};
+
+        // Per tile, released once this draw finished the tile.
+        UniquePtr<JobCounter[]> tile_done {};
+        // Per tile, the tile_done of the latest draw of the frame up to this one that touches
+        // the tile, null if none does. Untouched tiles get no job and pass the previous on.
+        UniquePtr<JobCounter*[]> tile_last {};
+        u32 tile_count {0};
+        DrawContext* previous {nullptr};
+    };
+
+    /**
+     * @brief Per-worker temporaries. A job runs on one worker from start to end, so scratch
+     * indexed by the executing worker is never shared.
+     */
+    struct Pipeline::WorkerScratch
+    {
+        // One vertex batch: gathered shader inputs, shaded outputs, the output vertex of every
+        // triangle corner, and per-triangle validity.
+        std::vector<f32> vs_input {};
+        std::vector<f32> vertices {};
+        std::vector<u32> corner_vertices {};
+        std::vector<u8> triangle_valid {};
+        // Mesh index of every vertex of the batch.
+        std::vector<u32> batch_indices {};
+        // Post-transform vertex cache of the batch: mesh index and output vertex per entry.
+        std::vector<u32> cache_indices {};
+        std::vector<u32> cache_vertices {};
+        std::vector<f32> clip_output {};
+        std::vector<f32> clip_scratch {};
+        // Fragment inputs and outputs of one c_simd_lanes block, see FragmentLane().
+        std::vector<f32> fs_input {};
+        std::vector<f32> fs_output {};
+        // Binning of one chunk: per triangle either its only tile, or c_bin_spilled and the
+        // count of its tiles, which follow those of earlier triangles in bin_spill.
+        std::vector<u32> bin_codes {};
+        std::vector<u32> bin_spill {};
+        // Consecutive micro triangles of the tile being rasterized.
+        std::vector<const TriangleSetup*> micro_triangles {};
+        // Colors of the tile being rasterized.
+        TileCache tile_cache {};
+
+        // Transient storage of the jobs run by this worker, released by Flush().
+        FrameArena arena {};
+    };
+
+    // Byte alignment of the triangle records in a chunk.
+    static constexpr size_t c_triangle_alignment = 16;
+    // Marks a bin code as a count of spilled tiles rather than a tile index.
+    static constexpr u32 c_bin_spilled = 1u << 31;
+    // Micro triangles a tile collects before handing them to the micro triangle kernel.
+    static constexpr u32 c_micro_triangle_batch = 64;
+
+    /**
+     * @brief The edge equations of a triangle for excluding tiles, the pixel of a rectangle
+     * furthest inside each picked by the signs of its steps. They are the raster kernels'
+     * integers, so the test is exact.
+     */
+    struct TileEdges
+    {
+        EdgeEquation edges[3];
+
+        explicit TileEdges(const TriangleSetup& triangle) { SetupEdges(triangle, edges); }
+
+        /**
+         * @brief False if no pixel center of [x0, x1] x [y0, y1] is inside the triangle.
+         */
+        bool Overlap(i32 x0, i32 y0, i32 x1, i32 y1) const
+        {
+            for (const EdgeEquation& edge : edges)
+            {
+                if (edge.At(edge.step_x >= 0 ? x1 : x0, edge.step_y >= 0 ? y1 : y0) < 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    enum class MeshletVisibility
+    {
+        Visible,
+        OutsideFrustum,
+        ConeCulled,
+    };
+
+    /**
+     * @brief Conservative cluster test: the bounding sphere against the frustum planes, then
+     * the normal cone against the eye. A cone of half angle a around the axis has all of its
+     * triangles facing away from the eye if the axis is within 90 - a degrees of the view
+     * direction to every point of the sphere.
+     */
+    static MeshletVisibility TestMeshlet(const Meshlet& meshlet, const Vec4* planes,
+        const Vec3& camera_position, CullMode cull_mode)
+    {
+        for (u32 i = 0; i < 6; ++i)
+        {
+            const Vec4& plane = planes[i];
+            const f32 distance = plane.x * meshlet.center.x + plane.y * meshlet.center.y +
+                plane.z * meshlet.center.z + plane.w;
+            if (distance < -meshlet.radius)
+            {
+                return MeshletVisibility::OutsideFrustum;
+            }
+        }
+
+        if (cull_mode == CullMode::None || meshlet.cone_cutoff <= 0.0f)
+        {
+            return MeshletVisibility::Visible;
+        }
+        const f32 sin_angle = std::sqrt(std::max(0.0f,
+            1.0f - meshlet.cone_cutoff * meshlet.cone_cutoff));
+        const Vec3 view = meshlet.center - camera_position;
+        const f32 distance = std::sqrt(Dot(view, view));
+        // Growing the sphere by its radius bounds both the view direction and the distance.
+        const f32 bound = distance * sin_angle + meshlet.radius * (1.0f + sin_angle);
+        const f32 along_axis = Dot(view, meshlet.cone_axis);
+        const bool culled = cull_mode == CullMode::Back ? along_axis > bound :
+            -along_axis > bound;
+        return culled ? MeshletVisibility::ConeCulled : MeshletVisibility::Visible;
+    }
+
+    static const ShaderParam* FindParam(const ShaderParam* params, u32 count, const char* name)
+    {
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (std::strcmp(params[i].name, name) == 0)
+            {
+                return &params[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // Kernels of the fragment shader entry points of a module, called through pointers.
+    static RasterKernels SelectModuleRasterizer(const RasterPermutation& permutation)
+    {
+        switch (permutation.fs_width)
+        {
+        case 1: return SelectRasterizer<ScalarFragmentStage>(permutation);
+        case 4: return SelectRasterizer<PacketFragmentStage<4>>(permutation);
+        case 8: return SelectRasterizer<PacketFragmentStage<8>>(permutation);
+        default: return {};
+        }
+    }
+
+    static size_t FloatsFor(u32 bytes)
+    {
+        return std::max<size_t>((bytes + sizeof(f32) - 1) / sizeof(f32), 1);
+    }
+
+    Pipeline::Pipeline(JobSystemPtr jobs)
+        : m_jobs(std::move(jobs))
+    {
+        m_scratch.resize(m_jobs->GetWorkerCount());
+    }
+
+    Pipeline::~Pipeline()
+    {
+        Flush();
+    }
+
+    bool Pipeline::Configure(const VertexShaderAPI& vs, const FragmentShaderAPI& fs,
+        const std::vector<RenderTarget*>& targets, DepthTarget* depth_target,
+        const PipelineState& state, RasterizerSelector inline_shader)
+    {
+        return ConfigureTargets(vs, fs, targets, {}, nullptr, depth_target, state,
+            inline_shader);
+    }
+
+    bool Pipeline::Configure(const VertexShaderAPI& vs, const FragmentShaderAPI& fs,
+        const std::vector<MultisampleTarget*>& targets, DepthTarget* depth_target,
+        const PipelineState& state, RasterizerSelector inline_shader)
+    {
+        std::vector<RenderTarget*> resolve_targets;
+        for (MultisampleTarget* target : targets)
+        {
+            resolve_targets.push_back(target ? &target->GetResolveTarget() : nullptr);
+        }
+        return ConfigureTargets(vs, fs, resolve_targets, targets, nullptr, depth_target, state,
+            inline_shader);
+    }
+
+    bool Pipeline::Configure(const VertexShaderAPI& vs, const FragmentShaderAPI& fs,
+        GBuffer& gbuffer, DepthTarget* depth_target, const PipelineState& state,
+        RasterizerSelector inline_shader)
+    {
+        return ConfigureTargets(vs, fs, {}, {}, &gbuffer, depth_target, state, inline_shader);
+    }
+
+    bool Pipeline::ConfigureTargets(const VertexShaderAPI& vs, const FragmentShaderAPI& fs,
+        const std::vector<RenderTarget*>& targets,
+        const std::vector<MultisampleTarget*>& multisample_targets, GBuffer* gbuffer,
+        DepthTarget* depth_target, const PipelineState& state, RasterizerSelector inline_shader)
+    {
+        Flush();
+        m_configured = false;
+
+        if (!vs.VS_Main || !vs.reflection || !(fs.FS_Main || fs.FS_MainPacket) || !fs.reflection)
+        {
+            LOG_ERROR("Pipeline configuration failed: shader entry point or reflection missing");
+            return false;
+        }
+        if (fs.FS_MainPacket && fs.simd_width != 4 && fs.simd_width != 8)
+        {
+            LOG_ERROR("Pipeline configuration failed: fragment shader packet width %u is not "
+                "supported (4 or 8)", fs.simd_width);
+            return false;
+        }
+
+        const ShaderReflection& vs_reflection = *vs.reflection;
+        const ShaderReflection& fs_reflection = *fs.reflection;
+
+        if (vs_reflection.output_count == 0 || vs_reflection.outputs[0].format != Format::Vec4 ||
+            vs_reflection.outputs[0].offset != 0)
+        {
+            LOG_ERROR("Pipeline configuration failed: vertex shader output 0 must be the "
+                "clip-space position (Vec4 at offset 0)");
+            return false;
+        }
+        for (u32 i = 0; i < vs_reflection.output_count; ++i)
+        {
+            const ShaderParam& output = vs_reflection.outputs[i];
+            if (FormatFloatCount(output.format) == 0 || output.offset % sizeof(f32) != 0)
+            {
+                LOG_ERROR("Pipeline configuration failed: vertex shader output '%s' is not a "
+                    "float-based format", output.name);
+                return false;
+            }
+        }
+
+        const u32 target_count = gbuffer ? gbuffer->GetAttachmentCount() :
+            static_cast<u32>(targets.size());
+        if (target_count == 0)
+        {
+            LOG_ERROR("Pipeline configuration failed: no render target bound");
+            return false;
+        }
+        if (fs_reflection.output_count != target_count)
+        {
+            LOG_ERROR("Pipeline configuration failed: fragment shader writes %u outputs but %u "
+                "render targets are bound", fs_reflection.output_count, target_count);
+            return false;
+        }
+        for (u32 i = 0; i < fs_reflection.output_count; ++i)
+        {
+            if (fs_reflection.outputs[i].format != Format::Vec4)
+            {
+                LOG_ERROR("Pipeline configuration failed: fragment shader output '%s' is not a "
+                    "Vec4 color", fs_reflection.outputs[i].name);
+                return false;
+            }
+        }
+        for (RenderTarget* target : targets)
+        {
+            if (!target || target->GetWidth() != targets[0]->GetWidth() ||
+                target->GetHeight() != targets[0]->GetHeight())
+            {
+                LOG_ERROR("Pipeline configuration failed: render targets must be non-null and "
+                    "share one size");
+                return false;
+            }
+        }
+        const u32 width = gbuffer ? gbuffer->GetWidth() : targets[0]->GetWidth();
+        const u32 height = gbuffer ? gbuffer->GetHeight() : targets[0]->GetHeight();
+
+        if (depth_target && (depth_target->GetWidth() != width ||
+            depth_target->GetHeight() != height))
+        {
+            LOG_ERROR("Pipeline configuration failed: depth target size does not match the "
+                "render targets");
+            return false;
+        }
+        const bool multisample = !multisample_targets.empty();
+        const u32 samples = multisample ? c_msaa_samples : 1;
+        if (depth_target && depth_target->GetSampleCount() != samples)
+        {
+            LOG_ERROR("Pipeline configuration failed: depth target has %u samples per pixel, "
+                "the render targets %u", depth_target->GetSampleCount(), samples);
+            return false;
+        }
+
+        std::vector<u32> varying_sources;
+        std::vector<u32> varying_destinations;
+        for (u32 i = 0; i < fs_reflection.input_count; ++i)
+        {
+            const ShaderParam& input = fs_reflection.inputs[i];
+            const ShaderParam* output = FindParam(vs_reflection.outputs,
+                vs_reflection.output_count, input.name);
+            if (!output)
+            {
+                LOG_ERROR("Pipeline linking failed: VS does not provide '%s' needed by FS",
+                    input.name);
+                return false;
+            }
+            if (output->format != input.format || input.offset % sizeof(f32) != 0)
+            {
+                LOG_ERROR("Pipeline linking failed: '%s' has mismatching formats between VS "
+                    "and FS", input.name);
+                return false;
+            }
+            for (u32 c = 0; c < FormatFloatCount(input.format); ++c)
+            {
+                varying_sources.push_back(output->offset / sizeof(f32) + c);
+                varying_destinations.push_back(input.offset / sizeof(f32) + c);
+            }
+        }
+
+        UniformLayout uniform_layout;
+        if (!uniform_layout.Build(vs_reflection, fs_reflection))
+        {
+            return false;
+        }
+
+        const RasterPermutation permutation = {depth_target && state.depth_test,
+            depth_target && state.depth_write, fs.FS_MainPacket ? fs.simd_width : 1,
+            target_count, multisample};
+        const RasterKernels kernels = inline_shader ? inline_shader(permutation) :
+            SelectModuleRasterizer(permutation);
+        if (!kernels.triangle)
+        {
+            LOG_ERROR("Pipeline configuration failed: the inlined fragment shader is not %u "
+                "lanes wide like its FragmentShaderAPI", permutation.fs_width);
+            return false;
+        }
+
+        // The layouts only depend on the vertex shader; keep them when just the targets or
+        // the fragment shader change.
+        if (vs.reflection != m_vs.reflection || vs.VS_Main != m_vs.VS_Main)
+        {
+            m_input_layouts.Clear();
+        }
+        m_vs = vs;
+        m_fs = fs;
+        m_targets = targets;
+        m_multisample_targets = multisample_targets;
+        m_gbuffer = gbuffer;
+        m_depth = depth_target;
+        m_state = state;
+        m_uniform_layout = std::move(uniform_layout);
+        m_varying_sources = std::move(varying_sources);
+        m_varying_destinations = std::move(varying_destinations);
+        m_vertex_floats = static_cast<u32>(
+            std::max<size_t>(FloatsFor(vs_reflection.output_stride), 4));
+        const size_t triangle_bytes = sizeof(TriangleSetup) +
+            m_varying_sources.size() * sizeof(PlaneEquation);
+        m_triangle_stride = static_cast<u32>((triangle_bytes + c_triangle_alignment - 1) &
+            ~(c_triangle_alignment - 1));
+
+        m_color_offsets.clear();
+        for (u32 i = 0; i < fs_reflection.output_count; ++i)
+        {
+            m_color_offsets.push_back(fs_reflection.outputs[i].offset / sizeof(f32));
+        }
+        m_fs_input_floats = static_cast<u32>(FloatsFor(fs_reflection.input_stride));
+        m_fs_output_floats = static_cast<u32>(FloatsFor(fs_reflection.output_stride));
+        m_raster = {m_varying_destinations.data(),
+            static_cast<u32>(m_varying_destinations.size()), m_fs_input_floats,
+            m_fs_output_floats, m_color_offsets.data(), m_targets.data(), target_count,
+            multisample ? m_multisample_targets.data() : nullptr, m_depth, m_fs.FS_Main,
+            m_fs.FS_MainPacket};
+        m_kernels = kernels;
+
+        m_width = width;
+        m_height = height;
+        m_tiles_x = (m_width + c_tile_size - 1) / c_tile_size;
+        m_tiles_y = (m_height + c_tile_size - 1) / c_tile_size;
+        const GuardBand guard_band = ComputeGuardBand(m_width, m_height);
+        m_guard_band_x = guard_band.x;
+        m_guard_band_y = guard_band.y;
+        // New targets or shaders invalidate every pixel of the previous frames.
+        m_damage.Resize(m_tiles_x, m_tiles_y);
+        m_damage_rects = {{0, 0, m_width, m_height}};
+
+        for (WorkerScratch& scratch : m_scratch)
+        {
+            scratch.vs_input.assign(
+                3 * c_vertex_batch_triangles * FloatsFor(vs_reflection.input_stride), 0.0f);
+            scratch.vertices.assign(3 * c_vertex_batch_triangles * m_vertex_floats, 0.0f);
+            scratch.corner_vertices.assign(3 * c_vertex_batch_triangles, 0);
+            scratch.triangle_valid.assign(c_vertex_batch_triangles, 0);
+            scratch.batch_indices.assign(3 * c_vertex_batch_triangles, 0);
+            scratch.cache_indices.assign(c_vertex_cache_entries, 0);
+            scratch.cache_vertices.assign(c_vertex_cache_entries, 0);
+            scratch.clip_output.assign(c_max_clip_vertices * m_vertex_floats, 0.0f);
+            scratch.clip_scratch.assign(c_max_clip_vertices * m_vertex_floats, 0.0f);
+            scratch.fs_input.assign(c_simd_lanes * m_fs_input_floats, 0.0f);
+            scratch.fs_output.assign(c_simd_lanes * m_fs_output_floats, 0.0f);
+            scratch.bin_codes.assign(c_triangles_per_chunk * (c_max_clip_vertices - 2), 0);
+            scratch.micro_triangles.assign(c_micro_triangle_batch, nullptr);
+            scratch.tile_cache.Resize(multisample || gbuffer ? 0 : target_count);
+        }
+
+        m_configured = true;
+        return true;
+    }
+
+    void Pipeline::SetIncremental(const IncrementalDesc* desc)
+    {
+        Flush();
+        m_incremental = desc != nullptr;
+        m_incremental_desc = desc ? *desc : IncrementalDesc {};
+        m_damage.Invalidate();
+        m_damage_rects = {{0, 0, m_width, m_height}};
+    }
+
+    UniformBlock Pipeline::UploadUniforms(const UniformBuffer& uniforms)
+    {
+        if (uniforms.GetVersion() != m_uploaded_version)
+        {
+            void* data = m_uniform_ring.Allocate(uniforms.GetSize(), c_uniform_alignment);
+            std::memcpy(data, uniforms.GetData(), uniforms.GetSize());
+            m_uploaded_version = uniforms.GetVersion();
+            m_uploaded_block = {data, uniforms.GetSize()};
+        }
+        return m_uploaded_block;
+    }
+
+    void Pipeline::DrawMesh(const Mesh& mesh, const UniformBlock& uniforms,
+        const MeshletCulling* culling)
+    {
+        PROFILE_ZONE("draw mesh");
+        if (!m_configured)
+        {
+            return;
+        }
+        if (m_incremental && m_submitted)
+        {
+            LOG_ERROR("Draw after Submit() skipped, the frame ends with Flush()");
+            return;
+        }
+
+        if (uniforms.size < m_uniform_layout.GetSize())
+        {
+            LOG_ERROR("Uniform buffer holds %zu bytes but the shaders expect %zu",
+                uniforms.size, m_uniform_layout.GetSize());
+            return;
+        }
+
+        const u32 triangle_count = mesh.GetTriangleCount();
+        if (triangle_count == 0)
+        {
+            return;
+        }
+
+        // Contexts and chunks hold job counters, so they are pooled across frames rather than
+        // taken from the arena; the pools only grow while the workload does.
+        if (m_draw_count == m_draws.size())
+        {
+            m_draws.push_back(MakeUnique<DrawContext>());
+            ++m_pool_allocations;
+        }
+        DrawContext& draw = *m_draws[m_draw_count];
+        const InputLayout& input_layout = m_input_layouts.Get(mesh.vertices.layout,
+            *m_vs.reflection);
+        if (!input_layout.IsValid())
+        {
+            // The mismatch was logged when the layout was created.
+            return;
+        }
+        if (!input_layout.IsInRange(mesh.vertices))
+        {
+            LOG_ERROR("Mesh vertex attributes extend past its %zu vertices",
+                mesh.vertices.vertex_count);
+            return;
+        }
+
+        const u32 tile_count = m_tiles_x * m_tiles_y;
+        draw.pipeline = this;
+        draw.mesh = &mesh;
+        draw.uniforms = uniforms.data;
+        draw.input_layout = &input_layout;
+        draw.cull_meshlets = culling && !mesh.meshlets.empty();
+        if (draw.cull_meshlets)
+        {
+            // Clip-space bounds -w <= x, y <= w and 0 <= z <= w as model-space planes
+            // (Gribb and Hartmann), from the rows of the transform.
+            const auto& m = culling->model_view_projection.m;
+            auto row = [&m](u32 r, f32 sign)
+            {
+                return Vec4 {m[r][0] * sign, m[r][1] * sign, m[r][2] * sign, m[r][3] * sign};
+            };
+            auto add = [](const Vec4& a, const Vec4& b)
+            {
+                return Vec4 {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+            };
+            const Vec4 w = row(3, 1.0f);
+            const Vec4 planes[6] = {
+                add(w, row(0, 1.0f)), add(w, row(0, -1.0f)),
+                add(w, row(1, 1.0f)), add(w, row(1, -1.0f)),
+                row(2, 1.0f), add(w, row(2, -1.0f)),
+            };
+            for (u32 i = 0; i < 6; ++i)
+            {
+                // A degenerate plane keeps a zero normal and never rejects anything.
+                const f32 length = std::sqrt(planes[i].x * planes[i].x +
+                    planes[i].y * planes[i].y + planes[i].z * planes[i].z);
+                const f32 scale = length > 0.0f ? 1.0f / length : 0.0f;
+                draw.frustum_planes[i] = {planes[i].x * scale, planes[i].y * scale,
+                    planes[i].z * scale, length > 0.0f ? planes[i].w * scale : 0.0f};
+            }
+            draw.camera_position = culling->camera_position;
+        }
+        draw.triangle_count = triangle_count;
+        if (m_incremental)
+        {
+            // What the draw's pixels depend on besides the state Configure() bound.
+            u64 signature = HashBytes(uniforms.data, uniforms.size);
+            auto hash = [&signature](const auto& value)
+            {
+                signature = HashBytes(&value, sizeof(value), signature);
+            };
+            hash(draw.input_layout);
+            hash(mesh.vertices.GetData());
+            hash(mesh.vertices.vertex_count);
+            hash(mesh.indices.GetData());
+            hash(triangle_count);
+            hash(draw.cull_meshlets);
+            if (draw.cull_meshlets)
+            {
+                hash(culling->model_view_projection);
+                hash(culling->camera_position);
+            }
+            draw.signature = signature;
+        }
+        draw.chunk_count = (triangle_count + c_triangles_per_chunk - 1) / c_triangles_per_chunk;
+        draw.previous = m_draw_count > 0 ? m_draws[m_draw_count - 1].get() : nullptr;
+        if (draw.tile_count != tile_count)
+        {
+            draw.tile_done = MakeUnique<JobCounter[]>(tile_count);
+            draw.tile_last = MakeUnique<JobCounter*[]>(tile_count);
+            draw.tile_count = tile_count;
+            m_pool_allocations += 2;
+        }
+        while (draw.chunks.size() < draw.chunk_count)
+        {
+            draw.chunks.push_back(MakeUnique<GeometryChunk>());
+            ++m_pool_allocations;
+        }
+        ++m_draw_count;
+        PROFILE_COUNT("draws", 1);
+        PROFILE_COUNT("triangles submitted", triangle_count);
+
+        // Arm every counter before the first job can possibly finish. Dispatching also waits
+        // for the previous draw's dispatch, which tells which draw each tile has to follow;
+        // in incremental mode the first draw waits for the damage job instead.
+        draw.binned.Reset(draw.chunk_count + (draw.previous || m_incremental ? 1 : 0));
+        if (m_incremental)
+        {
+            // Submit() holds the frame open until its last draw is queued.
+            if (draw.previous)
+            {
+                m_frame_binned.Add(draw.chunk_count);
+            }
+            else
+            {
+                m_frame_binned.Reset(draw.chunk_count + 1);
+            }
+        }
+        draw.dispatched.Reset(1);
+        m_completion.Add(1);
+        m_jobs->RunAfter(draw.binned, {&Pipeline::DispatchTilesJob, &draw, 0, "dispatch tiles",
+            &m_completion});
+        if (draw.previous)
+        {
+            m_jobs->RunAfter(draw.previous->dispatched, {&Pipeline::ReleaseJob, nullptr, 0,
+                "release dispatch", &draw.binned});
+        }
+
+        for (u32 chunk_index = 0; chunk_index < draw.chunk_count; ++chunk_index)
+        {
+            GeometryChunk& chunk = *draw.chunks[chunk_index];
+            chunk.shaded.Reset(1);
+            m_jobs->RunAfter(chunk.shaded, {&Pipeline::BinChunkJob, &draw, chunk_index, "bin",
+                &draw.binned});
+            m_jobs->Run({&Pipeline::ShadeChunkJob, &draw, chunk_index, "vertex shade",
+                &chunk.shaded});
+        }
+    }
+
+    void Pipeline::Submit(u32 target_age)
+    {
+        if (!m_incremental || !m_configured || m_submitted)
+        {
+            return;
+        }
+        m_submitted = true;
+        m_target_age = target_age;
+        if (m_draw_count == 0)
+        {
+            // Nothing to wait for; the tiles of the previous frame's draws are cleared.
+            SelectRedrawTiles();
+            return;
+        }
+        m_jobs->RunAfter(m_frame_binned, {&Pipeline::DamageJob, this, 0, "damage",
+            &m_draws[0]->binned});
+        m_jobs->Signal(m_frame_binned);
+    }
+
+    void Pipeline::Flush()
+    {
+        PROFILE_ZONE("flush");
+        if (m_draw_count > 0)
+        {
+            Submit();
+        }
+        m_jobs->Wait(m_completion);
+        m_draw_count = 0;
+        m_submitted = false;
+        m_redraw = nullptr;
+
+        size_t arena_bytes = m_submit_arena.GetUsed();
+        m_submit_arena.Reset();
+        for (WorkerScratch& scratch : m_scratch)
+        {
+            arena_bytes += scratch.arena.GetUsed();
+            scratch.arena.Reset();
+        }
+        PROFILE_COUNT("frame arena bytes", arena_bytes);
+        PROFILE_COUNT("uniform ring bytes", m_uniform_ring.GetUsed());
+        m_uniform_ring.Reset();
+        m_uploaded_version = 0;
+    }
+
+    PipelineMemoryStats Pipeline::GetMemoryStats() const
+    {
+        PipelineMemoryStats stats = {0, m_pool_allocations};
+        stats.arena_capacity = m_submit_arena.GetCapacity();
+        stats.system_allocations += m_submit_arena.GetBlockAllocations();
+        stats.arena_capacity += m_uniform_ring.GetCapacity();
+        stats.system_allocations += m_uniform_ring.GetBlockAllocations();
+        for (const WorkerScratch& scratch : m_scratch)
+        {
+            stats.arena_capacity += scratch.arena.GetCapacity();
+            stats.system_allocations += scratch.arena.GetBlockAllocations();
+        }
+        return stats;
+    }
+
+    void Pipeline::ShadeChunkJob(void* data, u32 chunk_index, u32 worker_index)
+    {
+        DrawContext& draw = *static_cast<DrawContext*>(data);
+        Pipeline& pipeline = *draw.pipeline;
+        const u32 first = chunk_index * c_triangles_per_chunk;
+        const u32 end = std::min(first + c_triangles_per_chunk, draw.triangle_count);
+        pipeline.ShadeChunk(draw, *draw.chunks[chunk_index], pipeline.m_scratch[worker_index],
+            first, end);
+    }
+
+    void Pipeline::BinChunkJob(void* data, u32 chunk_index, u32 worker_index)
+    {
+        DrawContext& draw = *static_cast<DrawContext*>(data);
+        Pipeline& pipeline = *draw.pipeline;
+        pipeline.BinChunk(*draw.chunks[chunk_index], pipeline.m_scratch[worker_index]);
+        if (pipeline.m_incremental)
+        {
+            pipeline.m_jobs->Signal(pipeline.m_frame_binned);
+        }
+    }
+
+    void Pipeline::ReleaseJob(void*, u32, u32)
+    {
+    }
+
+    void Pipeline::DispatchTilesJob(void* data, u32, u32)
+    {
+        DrawContext& draw = *static_cast<DrawContext*>(data);
+        Pipeline& pipeline = *draw.pipeline;
+        const TileMask* redraw = pipeline.m_redraw;
+        u32 tiles_dispatched = 0;
+        for (u32 tile = 0; tile < draw.tile_count; ++tile)
+        {
+            JobCounter* previous = draw.previous ? draw.previous->tile_last[tile] : nullptr;
+            // Tiles incremental rendering keeps count as untouched.
+            bool touched = false;
+            for (u32 chunk_index = 0; chunk_index < draw.chunk_count && !touched &&
+                (!redraw || redraw->Test(tile)); ++chunk_index)
+            {
+                const GeometryChunk& chunk = *draw.chunks[chunk_index];
+                touched = chunk.bin_offsets[tile + 1] > chunk.bin_offsets[tile];
+            }
+            if (!touched)
+            {
+                draw.tile_last[tile] = previous;
+                continue;
+            }
+
+            // Later draws only find this counter through tile_last, published below.
+            draw.tile_done[tile].Reset(1);
+            draw.tile_last[tile] = &draw.tile_done[tile];
+            pipeline.m_completion.Add(1);
+            ++tiles_dispatched;
+            const Job job = {&Pipeline::RasterizeTileJob, &draw, tile, "raster tile",
+                &pipeline.m_completion};
+            if (previous)
+            {
+                pipeline.m_jobs->RunAfter(*previous, job);
+            }
+            else
+            {
+                pipeline.m_jobs->Run(job);
+            }
+        }
+        PROFILE_COUNT("tiles dispatched", tiles_dispatched);
+        pipeline.m_jobs->Signal(draw.dispatched);
+    }
+
+    void Pipeline::RasterizeTileJob(void* data, u32 tile_index, u32 worker_index)
+    {
+        DrawContext& draw = *static_cast<DrawContext*>(data);
+        Pipeline& pipeline = *draw.pipeline;
+        pipeline.RasterizeTile(draw, tile_index, pipeline.m_scratch[worker_index]);
+        pipeline.m_jobs->Signal(draw.tile_done[tile_index]);
+    }
+
+    void Pipeline::DamageJob(void* data, u32, u32)
+    {
+        static_cast<Pipeline*>(data)->SelectRedrawTiles();
+    }
+
+    void Pipeline::ShadeChunk(DrawContext& draw, GeometryChunk& chunk, WorkerScratch& scratch,
+        u32 first_triangle, u32 end_triangle)
+    {
+        // Clipping turns a triangle into at most c_max_clip_vertices - 2 triangles. Reserve
+        // for that and give the unused tail back once the chunk is set up.
+        const size_t max_triangles = static_cast<size_t>(end_triangle - first_triangle) *
+            (c_max_clip_vertices - 2);
+        chunk.triangles = static_cast<u8*>(
+            scratch.arena.Allocate(max_triangles * m_triangle_stride, c_triangle_alignment));
+        chunk.triangle_count = 0;
+
+        u32 vertices_shaded = 0;
+        u32 triangles_shaded = 0;
+        if (draw.cull_meshlets)
+        {
+            // Meshlets are sorted and disjoint: start at the first one ending in the chunk.
+            // One straddling two chunks is tested by both but counted by the first.
+            const std::vector<Meshlet>& meshlets = draw.mesh->meshlets;
+            auto meshlet = std::upper_bound(meshlets.begin(), meshlets.end(), first_triangle,
+                [](u32 triangle, const Meshlet& m)
+                {
+                    return triangle < m.first_index / 3 + m.triangle_count;
+                });
+            u32 cursor = first_triangle;
+            u32 meshlets_tested = 0;
+            u32 frustum_culled = 0;
+            u32 cone_culled = 0;
+            for (; meshlet != meshlets.end() && meshlet->first_index / 3 < end_triangle;
+                ++meshlet)
+            {
+                const u32 meshlet_first = meshlet->first_index / 3;
+                const u32 begin = std::max(meshlet_first, first_triangle);
+                const u32 end = std::min(meshlet_first + meshlet->triangle_count, end_triangle);
+                if (cursor < begin)
+                {
+                    vertices_shaded += ShadeTriangles(draw, chunk, scratch, cursor, begin);
+                    triangles_shaded += begin - cursor;
+                }
+                cursor = end;
+
+                const MeshletVisibility visibility = TestMeshlet(*meshlet,
+                    draw.frustum_planes, draw.camera_position, m_state.cull_mode);
+                if (meshlet_first >= first_triangle)
+                {
+                    ++meshlets_tested;
+                    frustum_culled += visibility == MeshletVisibility::OutsideFrustum;
+                    cone_culled += visibility == MeshletVisibility::ConeCulled;
+                }
+                if (visibility == MeshletVisibility::Visible)
+                {
+                    vertices_shaded += ShadeTriangles(draw, chunk, scratch, begin, end);
+                    triangles_shaded += end - begin;
+                }
+            }
+            if (cursor < end_triangle)
+            {
+                vertices_shaded += ShadeTriangles(draw, chunk, scratch, cursor, end_triangle);
+                triangles_shaded += end_triangle - cursor;
+            }
+            PROFILE_COUNT("meshlets tested", meshlets_tested);
+            PROFILE_COUNT("meshlets frustum culled", frustum_culled);
+            PROFILE_COUNT("meshlets cone culled", cone_culled);
+            PROFILE_COUNT("triangles meshlet culled",
+                (end_triangle - first_triangle) - triangles_shaded);
+        }
+        else
+        {
+            vertices_shaded = ShadeTriangles(draw, chunk, scratch, first_triangle, end_triangle);
+            triangles_shaded = end_triangle - first_triangle;
+        }
+
+        scratch.arena.Shrink(chunk.triangles,
+            static_cast<size_t>(chunk.triangle_count) * m_triangle_stride);
+        PROFILE_COUNT("vertices shaded", vertices_shaded);
+        PROFILE_COUNT("vertex cache hits", 3 * triangles_shaded - vertices_shaded);
+        PROFILE_COUNT("triangles set up", chunk.triangle_count);
+    }
+
+    u32 Pipeline::ShadeTriangles(const DrawContext& draw, GeometryChunk& chunk,
+        WorkerScratch& scratch, u32 first_triangle, u32 end_triangle)
+    {
+        const GuardBand guard_band = {m_guard_band_x, m_guard_band_y};
+        u32 vertices_shaded = 0;
+        u32 triangles_clipped = 0;
+        for (u32 batch = first_triangle; batch < end_triangle; batch += c_vertex_batch_triangles)
+        {
+            const u32 batch_count = std::min(c_vertex_batch_triangles, end_triangle - batch);
+            vertices_shaded += ShadeVertexBatch(draw, scratch, batch, batch_count);
+
+            for (u32 triangle = 0; triangle < batch_count; ++triangle)
+            {
+                if (!scratch.triangle_valid[triangle])
+                {
+                    continue;
+                }
+
+                const u32* corners = scratch.corner_vertices.data() + triangle * 3;
+                const f32* v0 = scratch.vertices.data() + corners[0] * m_vertex_floats;
+                const f32* v1 = scratch.vertices.data() + corners[1] * m_vertex_floats;
+                const f32* v2 = scratch.vertices.data() + corners[2] * m_vertex_floats;
+                const u32 outcode0 = ComputeOutcode(v0);
+                const u32 outcode1 = ComputeOutcode(v1);
+                const u32 outcode2 = ComputeOutcode(v2);
+
+                if (outcode0 & outcode1 & outcode2)
+                {
+                    continue;
+                }
+                // Triangles crossing only the screen edges are scissored by the setup bounds
+                // and the tiles; only near, far and guard band crossings are clipped.
+                const u32 outcodes = outcode0 | outcode1 | outcode2;
+                const bool clip = (outcodes & (ClipNear | ClipFar)) != 0 || (outcodes != 0 &&
+                    (ComputeOutcode(v0, guard_band) | ComputeOutcode(v1, guard_band) |
+                    ComputeOutcode(v2, guard_band)) != 0);
+                if (!clip)
+                {
+                    SetupTriangle(chunk, v0, v1, v2);
+                    continue;
+                }
+
+                ++triangles_clipped;
+                f32* polygon = scratch.clip_output.data();
+                const u32 polygon_count = ClipTriangle(v0, v1, v2, m_vertex_floats, polygon,
+                    scratch.clip_scratch.data(), guard_band);
+                for (u32 i = 1; i + 1 < polygon_count; ++i)
+                {
+                    SetupTriangle(chunk, polygon, polygon + i * m_vertex_floats,
+                        polygon + (i + 1) * m_vertex_floats);
+                }
+            }
+        }
+        PROFILE_COUNT("triangles clipped", triangles_clipped);
+        return vertices_shaded;
+    }
+
+    u32 Pipeline::ShadeVertexBatch(const DrawContext& draw, WorkerScratch& scratch,
+        u32 first_triangle, u32 triangle_count)
+    {
+        const Mesh& mesh = *draw.mesh;
+        const VertexBuffer& vertex_buffer = mesh.vertices;
+        const void* uniforms = draw.uniforms;
+        u32* corner_vertices = scratch.corner_vertices.data();
+
+        const u8* inputs = nullptr;
+        u32 input_stride = 0;
+        u32 vertex_count = 0;
+        if (draw.input_layout->IsDirect() && !mesh.IsIndexed())
+        {
+            // Non-indexed corners are consecutive vertices, GetTriangleCount() keeps them in range.
+            inputs = vertex_buffer.GetVertex(static_cast<size_t>(first_triangle) * 3);
+            input_stride = static_cast<u32>(vertex_buffer.layout.stride);
+            vertex_count = triangle_count * 3;
+            std::fill_n(scratch.triangle_valid.begin(), triangle_count, u8 {1});
+            for (u32 corner = 0; corner < vertex_count; ++corner)
+            {
+                corner_vertices[corner] = corner;
+            }
+        }
+        else
+        {
+            const bool indexed = mesh.IsIndexed();
+            const u32* indices = mesh.indices.GetData();
+            u8* gathered = reinterpret_cast<u8*>(scratch.vs_input.data());
+            input_stride = static_cast<u32>(FloatsFor(m_vs.reflection->input_stride) * sizeof(f32));
+
+            // Indexed corners go through a direct-mapped cache of the batch's vertices, so a
+            // vertex shared by several triangles of the batch is fetched and shaded once. A
+            // collision only costs a duplicate shade, never a wrong vertex.
+            u32* cache_indices = scratch.cache_indices.data();
+            u32* cache_vertices = scratch.cache_vertices.data();
+            u32* batch_indices = scratch.batch_indices.data();
+            if (indexed)
+            {
+                std::fill_n(cache_indices, c_vertex_cache_entries, ~0u);
+            }
+
+            for (u32 triangle = 0; triangle < triangle_count; ++triangle)
+            {
+                scratch.triangle_valid[triangle] = 1;
+                for (u32 corner = 0; corner < 3; ++corner)
+                {
+                    const u32 corner_index = (first_triangle + triangle) * 3 + corner;
+                    const u32 index = indexed ? indices[corner_index] : corner_index;
+                    if (index >= vertex_buffer.vertex_count)
+                    {
+                        scratch.triangle_valid[triangle] = 0;
+                        continue;
+                    }
+
+                    if (indexed)
+                    {
+                        // Fibonacci hashing spreads the row strides of grid-like meshes.
+                        const u32 entry = (index * 2654435769u) >> (32 - c_vertex_cache_bits);
+                        if (cache_indices[entry] == index)
+                        {
+                            corner_vertices[triangle * 3 + corner] = cache_vertices[entry];
+                            continue;
+                        }
+                        cache_indices[entry] = index;
+                        cache_vertices[entry] = vertex_count;
+                    }
+                    batch_indices[vertex_count] = index;
+                    corner_vertices[triangle * 3 + corner] = vertex_count++;
+                }
+            }
+
+            // Only the attributes the shader lists are touched.
+            draw.input_layout->Gather(vertex_buffer.GetData(), batch_indices, vertex_count,
+                gathered, input_stride);
+            inputs = gathered;
+        }
+
+        f32* outputs = scratch.vertices.data();
+        if (m_vs.VS_MainBatch)
+        {
+            m_vs.VS_MainBatch(inputs, input_stride, vertex_count, outputs, uniforms);
+            return vertex_count;
+        }
+        for (u32 i = 0; i < vertex_count; ++i)
+        {
+            m_vs.VS_Main(inputs + i * input_stride, outputs + i * m_vertex_floats, uniforms);
+        }
+        return vertex_count;
+    }
+
+    void Pipeline::SetupTriangle(GeometryChunk& chunk, const f32* v0, const f32* v1,
+        const f32* v2)
+    {
+        const f32* vertices[3] = {v0, v1, v2};
+        // Written in place at the end of the chunk, only counted once it is accepted.
+        TriangleSetup& setup = chunk.GetTriangle(chunk.triangle_count, m_triangle_stride);
+        f32 z[3];
+        f32 inv_w[3];
+        for (u32 i = 0; i < 3; ++i)
+        {
+            const f32* position = vertices[i];
+            inv_w[i] = 1.0f / position[3];
+            const f32 x = (position[0] * inv_w[i] + 1.0f) * 0.5f * static_cast<f32>(m_width);
+            const f32 y = (1.0f - position[1] * inv_w[i]) * 0.5f * static_cast<f32>(m_height);
+            // Also rejects NaNs.
+            if (!(std::abs(x) <= c_max_snapped_pixels && std::abs(y) <= c_max_snapped_pixels))
+            {
+                return;
+            }
+            // nearbyint inlines to a single rounding instruction, lrint is a library call.
+            setup.x[i] = static_cast<i32>(
+                std::nearbyint(x * static_cast<f32>(c_subpixel_scale)));
+            setup.y[i] = static_cast<i32>(
+                std::nearbyint(y * static_cast<f32>(c_subpixel_scale)));
+            z[i] = position[2] * inv_w[i];
+        }
+
+        // Exact on the snapped positions, so triangles that snap to a line are dropped here.
+        i64 area = static_cast<i64>(setup.x[1] - setup.x[0]) * (setup.y[2] - setup.y[0]) -
+            static_cast<i64>(setup.y[1] - setup.y[0]) * (setup.x[2] - setup.x[0]);
+        if (area == 0)
+        {
+            return;
+        }
+
+        // The viewport flips Y, so counter-clockwise triangles end up with a negative area.
+        const bool front_facing = area < 0;
+        if ((m_state.cull_mode == CullMode::Back && !front_facing) ||
+            (m_state.cull_mode == CullMode::Front && front_facing))
+        {
+            return;
+        }
+        if (area < 0)
+        {
+            std::swap(vertices[1], vertices[2]);
+            std::swap(setup.x[1], setup.x[2]);
+            std::swap(setup.y[1], setup.y[2]);
+            std::swap(z[1], z[2]);
+            std::swap(inv_w[1], inv_w[2]);
+            area = -area;
+        }
+        setup.min_z = std::min({z[0], z[1], z[2]});
+        setup.max_z = std::max({z[0], z[1], z[2]});
+        setup.min_inv_w = std::min({inv_w[0], inv_w[1], inv_w[2]});
+
+        // Pixel centers sit at +0.5, so only pixels whose center lies inside the bounds count.
+        constexpr i32 half = c_subpixel_scale / 2;
+        const i32 min_x = std::min({setup.x[0], setup.x[1], setup.x[2]});
+        const i32 max_x = std::max({setup.x[0], setup.x[1], setup.x[2]});
+        const i32 min_y = std::min({setup.y[0], setup.y[1], setup.y[2]});
+        const i32 max_y = std::max({setup.y[0], setup.y[1], setup.y[2]});
+        setup.min_x = std::max((min_x - half + c_subpixel_scale - 1) >> c_subpixel_bits, 0);
+        setup.min_y = std::max((min_y - half + c_subpixel_scale - 1) >> c_subpixel_bits, 0);
+        setup.max_x = std::min((max_x - half) >> c_subpixel_bits, static_cast<i32>(m_width) - 1);
+        setup.max_y = std::min((max_y - half) >> c_subpixel_bits,
+            static_cast<i32>(m_height) - 1);
+        if (setup.min_x > setup.max_x || setup.min_y > setup.max_y)
+        {
+            return;
+        }
+
+        // Only the varyings the fragment shader reads get a plane.
+        const f32 inv_area = static_cast<f32>(c_subpixel_scale * c_subpixel_scale) /
+            static_cast<f32>(area);
+        const f32 dx[2] = {FixedToPixels(setup.x[1] - setup.x[0]),
+            FixedToPixels(setup.x[2] - setup.x[0])};
+        const f32 dy[2] = {FixedToPixels(setup.y[1] - setup.y[0]),
+            FixedToPixels(setup.y[2] - setup.y[0])};
+        setup.z = ComputePlane(z, dx, dy, inv_area);
+        setup.inv_w = ComputePlane(inv_w, dx, dy, inv_area);
+        PlaneEquation* varyings = setup.GetVaryings();
+        for (u32 source : m_varying_sources)
+        {
+            const f32 values[3] = {vertices[0][source] * inv_w[0],
+                vertices[1][source] * inv_w[1], vertices[2][source] * inv_w[2]};
+            *varyings++ = ComputePlane(values, dx, dy, inv_area);
+        }
+        ++chunk.triangle_count;
+    }
+
+    void Pipeline::BinChunk(GeometryChunk& chunk, WorkerScratch& scratch)
+    {
+        const u32 tile_count = m_tiles_x * m_tiles_y;
+        u32* offsets = scratch.arena.Allocate<u32>(tile_count + 1);
+        std::fill_n(offsets, tile_count + 1, 0u);
+
+        // Find and count the tiles of every triangle once, keeping them compactly for the
+        // scatter below instead of reading the setup records a second time. Most triangles
+        // fit one tile; larger ones only keep the tiles their edges do not exclude.
+        u32* codes = scratch.bin_codes.data();
+        std::vector<u32>& spill = scratch.bin_spill;
+        spill.clear();
+        for (u32 triangle_index = 0; triangle_index < chunk.triangle_count; ++triangle_index)
+        {
+            const TriangleSetup& setup = chunk.GetTriangle(triangle_index, m_triangle_stride);
+            const u32 tile_x0 = static_cast<u32>(setup.min_x) / c_tile_size;
+            const u32 tile_x1 = static_cast<u32>(setup.max_x) / c_tile_size;
+            const u32 tile_y0 = static_cast<u32>(setup.min_y) / c_tile_size;
+            const u32 tile_y1 = static_cast<u32>(setup.max_y) / c_tile_size;
+            if (tile_x0 == tile_x1 && tile_y0 == tile_y1)
+            {
+                const u32 tile = tile_y0 * m_tiles_x + tile_x0;
+                codes[triangle_index] = tile;
+                ++offsets[tile];
+                continue;
+            }
+
+            const TileEdges edges(setup);
+            const size_t first_spilled = spill.size();
+            for (u32 ty = tile_y0; ty <= tile_y1; ++ty)
+            {
+                const i32 y0 = std::max(static_cast<i32>(ty * c_tile_size), setup.min_y);
+                const i32 y1 = std::min(static_cast<i32>((ty + 1) * c_tile_size) - 1,
+                    setup.max_y);
+                for (u32 tx = tile_x0; tx <= tile_x1; ++tx)
+                {
+                    const i32 x0 = std::max(static_cast<i32>(tx * c_tile_size), setup.min_x);
+                    const i32 x1 = std::min(static_cast<i32>((tx + 1) * c_tile_size) - 1,
+                        setup.max_x);
+                    if (edges.Overlap(x0, y0, x1, y1))
+                    {
+                        const u32 tile = ty * m_tiles_x + tx;
+                        spill.push_back(tile);
+                        ++offsets[tile];
+                    }
+                }
+            }
+            codes[triangle_index] = c_bin_spilled |
+                static_cast<u32>(spill.size() - first_spilled);
+        }
+
+        // Turn the counts into start offsets, then scatter the triangles.
+        u32 total = 0;
+        for (u32 tile = 0; tile < tile_count; ++tile)
+        {
+            const u32 count = offsets[tile];
+            offsets[tile] = total;
+            total += count;
+        }
+        offsets[tile_count] = total;
+
+        u32* triangles = scratch.arena.Allocate<u32>(total);
+        const u32* spilled = spill.data();
+        for (u32 triangle_index = 0; triangle_index < chunk.triangle_count; ++triangle_index)
+        {
+            const u32 code = codes[triangle_index];
+            if (!(code & c_bin_spilled))
+            {
+                triangles[offsets[code]++] = triangle_index;
+                continue;
+            }
+            for (u32 i = 0; i < (code & ~c_bin_spilled); ++i)
+            {
+                triangles[offsets[*spilled++]++] = triangle_index;
+            }
+        }
+        // Scattering advanced every offset to the start of the next tile; shift them back.
+        std::memmove(offsets + 1, offsets, tile_count * sizeof(u32));
+        offsets[0] = 0;
+
+        chunk.bin_offsets = offsets;
+        chunk.bin_triangles = triangles;
+    }
+
+    void Pipeline::RasterizeTile(const DrawContext& draw, u32 tile_index, WorkerScratch& scratch)
+    {
+        const i32 tile_x0 = static_cast<i32>((tile_index % m_tiles_x) * c_tile_size);
+        const i32 tile_y0 = static_cast<i32>((tile_index / m_tiles_x) * c_tile_size);
+        const i32 tile_x1 = std::min(tile_x0 + static_cast<i32>(c_tile_size),
+            static_cast<i32>(m_width)) - 1;
+        const i32 tile_y1 = std::min(tile_y0 + static_cast<i32>(c_tile_size),
+            static_cast<i32>(m_height)) - 1;
+
+        const u32 tile_x = tile_index % m_tiles_x;
+        const u32 tile_y = tile_index / m_tiles_x;
+        const bool depth_test = m_depth && m_state.depth_test;
+        u64 triangles_binned = 0;
+        u64 hiz_tile_rejected = 0;
+        RasterScratch raster = {scratch.fs_input.data(), scratch.fs_output.data(),
+            &scratch.tile_cache, 0, 0};
+        if (m_gbuffer)
+        {
+            scratch.tile_cache.BeginInPlace(m_gbuffer->GetTile(tile_x, tile_y),
+                static_cast<u32>(tile_x0), static_cast<u32>(tile_y0));
+        }
+        else
+        {
+            scratch.tile_cache.Begin(m_targets.data(), static_cast<u32>(tile_x0),
+                static_cast<u32>(tile_y0));
+        }
+        const RasterKernels kernels = m_kernels;
+
+        // Micro triangles are batched until a larger triangle must be drawn after them.
+        const TriangleSetup** micro_triangles = scratch.micro_triangles.data();
+        u32 micro_count = 0;
+        u64 micro_total = 0;
+        auto flush_micro_triangles = [&]()
+        {
+            if (micro_count > 0 && kernels.micro_triangles(m_raster, micro_triangles,
+                micro_count, tile_x0, tile_y0, tile_x1, tile_y1, raster, draw.uniforms))
+            {
+                m_depth->RefreshTile(tile_x, tile_y);
+            }
+            micro_total += micro_count;
+            micro_count = 0;
+        };
+
+        // Chunks cover consecutive triangle ranges, so walking them in order keeps API order.
+        const void* uniforms = draw.uniforms;
+        for (u32 chunk_index = 0; chunk_index < draw.chunk_count; ++chunk_index)
+        {
+            const GeometryChunk& chunk = *draw.chunks[chunk_index];
+            const u32 bin_begin = chunk.bin_offsets[tile_index];
+            const u32 bin_end = chunk.bin_offsets[tile_index + 1];
+            triangles_binned += bin_end - bin_begin;
+            for (u32 bin = bin_begin; bin < bin_end; ++bin)
+            {
+                const TriangleSetup& triangle =
+                    chunk.GetTriangle(chunk.bin_triangles[bin], m_triangle_stride);
+                if (depth_test && triangle.min_z >= m_depth->GetTileRange(tile_x, tile_y).max)
+                {
+                    ++hiz_tile_rejected;
+                    continue;
+                }
+                if (kernels.micro_triangles &&
+                    IsMicroTriangle(triangle, tile_x0, tile_y0, tile_x1, tile_y1))
+                {
+                    micro_triangles[micro_count++] = &triangle;
+                    if (micro_count == c_micro_triangle_batch)
+                    {
+                        flush_micro_triangles();
+                    }
+                    continue;
+                }
+                flush_micro_triangles();
+                if (kernels.triangle(m_raster, triangle, tile_x0, tile_y0, tile_x1, tile_y1,
+                    raster, uniforms))
+                {
+                    m_depth->RefreshTile(tile_x, tile_y);
+                }
+            }
+        }
+        flush_micro_triangles();
+        const u32 cached_blocks = scratch.tile_cache.Flush();
+
+        u64 msaa_blocks_resolved = 0;
+        for (MultisampleTarget* target : m_multisample_targets)
+        {
+            msaa_blocks_resolved += target->Resolve(static_cast<u32>(tile_x0),
+                static_cast<u32>(tile_y0), static_cast<u32>(tile_x1), static_cast<u32>(tile_y1));
+        }
+
+        PROFILE_COUNT("tile triangles", triangles_binned);
+        PROFILE_COUNT("hiz tile rejects", hiz_tile_rejected);
+        PROFILE_COUNT("micro triangles", micro_total);
+        PROFILE_COUNT("hiz block rejects", raster.hiz_blocks_rejected);
+        PROFILE_COUNT("fragments shaded", raster.fragments_shaded);
+        PROFILE_COUNT("tile cache blocks", cached_blocks);
+        PROFILE_COUNT("msaa blocks resolved", msaa_blocks_resolved);
+    }
+
+    void Pipeline::SelectRedrawTiles()
+    {
+        const u32 tile_count = m_tiles_x * m_tiles_y;
+        for (u32 draw_index = 0; draw_index < m_draw_count; ++draw_index)
+        {
+            const DrawContext& draw = *m_draws[draw_index];
+            TileMask& tiles = m_damage.AddDraw(draw.signature);
+            for (u32 chunk_index = 0; chunk_index < draw.chunk_count; ++chunk_index)
+            {
+                const u32* offsets = draw.chunks[chunk_index]->bin_offsets;
+                for (u32 tile = 0; tile < tile_count; ++tile)
+                {
+                    if (offsets[tile + 1] > offsets[tile])
+                    {
+                        tiles.Set(tile);
+                    }
+                }
+            }
+        }
+        const TileMask& redraw = m_damage.EndFrame(m_target_age);
+        m_redraw = &redraw;
+
+        // Redrawn tiles start from the clear values, as the whole frame would. A G-buffer is
+        // only read where the depth was written, so is left as it is.
+        const IncrementalDesc& desc = m_incremental_desc;
+        m_redraw_rects.clear();
+        redraw.GetRects(m_tiles_x, c_tile_size, m_width, m_height, m_redraw_rects);
+        for (const DamageRect& rect : m_redraw_rects)
+        {
+            if (m_multisample_targets.empty())
+            {
+                for (RenderTarget* target : m_targets)
+                {
+                    target->ClearRect(rect.x, rect.y, rect.width, rect.height, desc.clear_color);
+                }
+            }
+            for (MultisampleTarget* target : m_multisample_targets)
+            {
+                target->ClearRect(rect.x, rect.y, rect.width, rect.height, desc.clear_color);
+            }
+            if (m_depth)
+            {
+                m_depth->ClearRect(rect.x, rect.y, rect.width, rect.height, desc.clear_depth);
+            }
+        }
+
+        const TileMask& damage = m_damage.GetDamage();
+        m_damage_rects.clear();
+        damage.GetRects(m_tiles_x, c_tile_size, m_width, m_height, m_damage_rects);
+        PROFILE_COUNT("tiles damaged", damage.Count());
+        PROFILE_COUNT("tiles redrawn", redraw.Count());
+    }
+
+} // namespace Rasterizer
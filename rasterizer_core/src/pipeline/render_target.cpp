@@ -0,0 +1,31 @@
+#include "pipeline/render_target.hpp"
+
+namespace Rasterizer
+{
+
+    RenderTarget::RenderTarget(u32 width, u32 height)
+        : m_width(width), m_height(height), m_pitch(width)
+    {
+        m_storage.resize(static_cast<size_t>(width) * height, 0);
+        m_pixels = m_storage.data();
+    }
+
+    RenderTarget::RenderTarget(u32* pixels, u32 width, u32 height, u32 pitch)
+        : m_pixels(pixels), m_width(width), m_height(height), m_pitch(pitch)
+    {
+    }
+
+    void RenderTarget::Clear(u32 color)
+    {
+        ClearRect(0, 0, m_width, m_height, color);
+    }
+
+    void RenderTarget::ClearRect(u32 x, u32 y, u32 width, u32 height, u32 color)
+    {
+        for (u32 row = y; row < y + height; ++row)
+        {
+            std::fill_n(GetRow(row) + x, width, color);
+        }
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,328 @@
+#include "pipeline/texture.hpp"
+#include "pipeline/simd.hpp"
+
+#include <bit>
+#include <cmath>
+
+namespace Rasterizer
+{
+
+    // Lanes of one 2x2 quad; a quad samples one mip level.
+    constexpr u32 c_quad_lanes = 4;
+
+    // Rounded per-channel average of four BGRA8 texels.
+    static u32 AverageTexels(u32 a, u32 b, u32 c, u32 d)
+    {
+        u32 result = 0;
+        for (u32 shift = 0; shift < 32; shift += 8)
+        {
+            const u32 sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) +
+                ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+            result |= ((sum + 2) / 4) << shift;
+        }
+        return result;
+    }
+
+    Texture::Texture(u32 width, u32 height, const u32* texels)
+    {
+        u32 level_width = std::max(width, 1u);
+        u32 level_height = std::max(height, 1u);
+        u32 texel_count = 0;
+        for (;;)
+        {
+            const u32 tiles_x = (level_width + c_texture_tile_size - 1) / c_texture_tile_size;
+            const u32 tiles_y = (level_height + c_texture_tile_size - 1) / c_texture_tile_size;
+            m_levels.push_back({texel_count, level_width, level_height, tiles_x});
+            texel_count += tiles_x * tiles_y * c_texture_tile_texels;
+            if (level_width == 1 && level_height == 1)
+            {
+                break;
+            }
+            level_width = std::max(level_width / 2, 1u);
+            level_height = std::max(level_height / 2, 1u);
+        }
+
+        // A tile is one cache line, so aligning the first one aligns them all.
+        constexpr size_t tile_bytes = c_texture_tile_texels * sizeof(u32);
+        m_storage.assign(texel_count + c_texture_tile_texels, 0);
+        const size_t misalignment = reinterpret_cast<uintptr_t>(m_storage.data()) % tile_bytes;
+        m_texels = m_storage.data() +
+            (misalignment ? (tile_bytes - misalignment) / sizeof(u32) : 0);
+
+        const TextureLevel& base = m_levels[0];
+        for (u32 y = 0; y < std::min(height, base.height); ++y)
+        {
+            for (u32 x = 0; x < std::min(width, base.width); ++x)
+            {
+                m_texels[TexelOffset(base, x, y)] = texels[static_cast<size_t>(y) * width + x];
+            }
+        }
+        for (u32 l = 1; l < m_levels.size(); ++l)
+        {
+            const TextureLevel& source = m_levels[l - 1];
+            const TextureLevel& level = m_levels[l];
+            for (u32 y = 0; y < level.height; ++y)
+            {
+                const u32 y0 = std::min(2 * y, source.height - 1);
+                const u32 y1 = std::min(2 * y + 1, source.height - 1);
+                for (u32 x = 0; x < level.width; ++x)
+                {
+                    const u32 x0 = std::min(2 * x, source.width - 1);
+                    const u32 x1 = std::min(2 * x + 1, source.width - 1);
+                    m_texels[TexelOffset(level, x, y)] = AverageTexels(
+                        m_texels[TexelOffset(source, x0, y0)],
+                        m_texels[TexelOffset(source, x1, y0)],
+                        m_texels[TexelOffset(source, x0, y1)],
+                        m_texels[TexelOffset(source, x1, y1)]);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Mip level nearest to log2 of the quad's footprint: the longer of its one pixel
+     * steps right (lane 1) and down (lane 2), in base level texels.
+     */
+    static u32 SelectLevel(const Texture& texture, const f32* u, const f32* v)
+    {
+        const f32 width = static_cast<f32>(texture.GetWidth());
+        const f32 height = static_cast<f32>(texture.GetHeight());
+        const f32 dudx = (u[1] - u[0]) * width;
+        const f32 dvdx = (v[1] - v[0]) * height;
+        const f32 dudy = (u[2] - u[0]) * width;
+        const f32 dvdy = (v[2] - v[0]) * height;
+        const f32 rho_squared = std::max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+        // round(log2(rho)) = floor(floor(log2(2 * rho^2)) / 2), the inner floor being the
+        // float's exponent. Zero and denormals have the lowest exponent, NaN and infinity the
+        // highest, which the clamp maps to the first or last level.
+        const u32 bits = std::bit_cast<u32>(2.0f * rho_squared);
+        const i32 exponent = static_cast<i32>((bits >> 23) & 0xFF) - 127;
+        const i32 last = static_cast<i32>(texture.GetLevelCount()) - 1;
+        return static_cast<u32>(std::clamp(exponent / 2, 0, last));
+    }
+
+    // Wraps a texel coordinate into [0, size). NaN and values float precision leaves outside
+    // land on a valid texel too.
+    static u32 WrapTexel(f32 coordinate, u32 size)
+    {
+        const f32 size_f = static_cast<f32>(size);
+        const f32 wrapped = coordinate - std::floor(coordinate / size_f) * size_f;
+        if (!(wrapped >= 0.0f))
+        {
+            return 0;
+        }
+        return wrapped < size_f ? static_cast<u32>(wrapped) : size - 1;
+    }
+
+    /**
+     * @brief Bilinear sample of one level with wrapping, writing r, g, b and a stride floats
+     * apart. The reference of SampleBilinear8.
+     */
+    static void SampleBilinear(const u32* texels, const TextureLevel& level, f32 u, f32 v,
+        f32* color, u32 stride)
+    {
+        const f32 position_x = u * static_cast<f32>(level.width) - 0.5f;
+        const f32 position_y = v * static_cast<f32>(level.height) - 0.5f;
+        const f32 floor_x = std::floor(position_x);
+        const f32 floor_y = std::floor(position_y);
+        const f32 weight_x = position_x - floor_x;
+        const f32 weight_y = position_y - floor_y;
+        const u32 x0 = WrapTexel(floor_x, level.width);
+        const u32 y0 = WrapTexel(floor_y, level.height);
+        const u32 x1 = x0 + 1 == level.width ? 0 : x0 + 1;
+        const u32 y1 = y0 + 1 == level.height ? 0 : y0 + 1;
+        const u32 texel00 = texels[Texture::TexelOffset(level, x0, y0)];
+        const u32 texel10 = texels[Texture::TexelOffset(level, x1, y0)];
+        const u32 texel01 = texels[Texture::TexelOffset(level, x0, y1)];
+        const u32 texel11 = texels[Texture::TexelOffset(level, x1, y1)];
+
+        // BGRA8 bytes in r, g, b, a order.
+        constexpr u32 shifts[4] = {16, 8, 0, 24};
+        for (u32 c = 0; c < 4; ++c)
+        {
+            auto channel = [&](u32 texel)
+            {
+                return static_cast<f32>((texel >> shifts[c]) & 0xFF);
+            };
+            const f32 top = channel(texel00) + (channel(texel10) - channel(texel00)) * weight_x;
+            const f32 bottom = channel(texel01) +
+                (channel(texel11) - channel(texel01)) * weight_x;
+            color[c * stride] = (top + (bottom - top) * weight_y) * (1.0f / 255.0f);
+        }
+    }
+
+#if defined(RASTERIZER_SIMD_AVX2)
+
+    /**
+     * @brief TextureLevel of the level each lane samples, one per quad of a packet.
+     */
+    struct LaneLevels
+    {
+        __m256i offset;
+        __m256i width;
+        __m256i height;
+        __m256i tiles_x;
+    };
+
+    // Built in registers: lane-wise stores reloaded as a vector would stall store forwarding.
+    static LaneLevels SplatLevels(const TextureLevel& low, const TextureLevel& high)
+    {
+        auto splat = [](u32 low_value, u32 high_value)
+        {
+            return _mm256_set_m128i(_mm_set1_epi32(static_cast<i32>(high_value)),
+                _mm_set1_epi32(static_cast<i32>(low_value)));
+        };
+        return {splat(low.offset, high.offset), splat(low.width, high.width),
+            splat(low.height, high.height), splat(low.tiles_x, high.tiles_x)};
+    }
+
+    /**
+     * @brief SampleBilinear() of c_simd_lanes lanes: the four texels of every footprint are
+     * fetched with one gather each. Returns r, g, b and a of every lane.
+     */
+    static void SampleBilinear8(const u32* texels, const LaneLevels& levels, __m256 u,
+        __m256 v, __m256* colors)
+    {
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i three = _mm256_set1_epi32(3);
+        const __m256 half = _mm256_set1_ps(0.5f);
+
+        // First texel of the footprint along one axis wrapped into the level, the second one
+        // wrapping to 0 past the edge, and the weight of the second. NaN and out of range
+        // floats convert to INT_MIN, which the clamp maps to texel 0.
+        auto wrap = [&](__m256 coordinate, __m256i size, __m256i& first, __m256i& second,
+            __m256& weight)
+        {
+            const __m256 size_f = _mm256_cvtepi32_ps(size);
+            const __m256 position = _mm256_fmsub_ps(coordinate, size_f, half);
+            const __m256 floor = _mm256_floor_ps(position);
+            weight = _mm256_sub_ps(position, floor);
+            const __m256 wrapped = _mm256_fnmadd_ps(
+                _mm256_floor_ps(_mm256_div_ps(floor, size_f)), size_f, floor);
+            first = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvttps_epi32(wrapped),
+                _mm256_setzero_si256()), _mm256_sub_epi32(size, one));
+            second = _mm256_add_epi32(first, one);
+            second = _mm256_andnot_si256(_mm256_cmpeq_epi32(second, size), second);
+        };
+        __m256i x0, x1, y0, y1;
+        __m256 weight_x, weight_y;
+        wrap(u, levels.width, x0, x1, weight_x);
+        wrap(v, levels.height, y0, y1, weight_y);
+
+        // Texel offset split into its row part, tile row and row inside the tile, and its
+        // column part, tile column and column inside the tile.
+        auto row = [&](__m256i y)
+        {
+            const __m256i tile_row = _mm256_mullo_epi32(_mm256_srli_epi32(y, 2), levels.tiles_x);
+            return _mm256_add_epi32(levels.offset, _mm256_slli_epi32(_mm256_add_epi32(
+                _mm256_slli_epi32(tile_row, 2), _mm256_and_si256(y, three)), 2));
+        };
+        auto column = [&](__m256i x)
+        {
+            return _mm256_add_epi32(_mm256_slli_epi32(_mm256_srli_epi32(x, 2), 4),
+                _mm256_and_si256(x, three));
+        };
+        const __m256i row0 = row(y0);
+        const __m256i row1 = row(y1);
+        const __m256i column0 = column(x0);
+        const __m256i column1 = column(x1);
+        auto gather = [&](__m256i row_offset, __m256i column_offset)
+        {
+            return _mm256_i32gather_epi32(reinterpret_cast<const int*>(texels),
+                _mm256_add_epi32(row_offset, column_offset), 4);
+        };
+        const __m256i texel00 = gather(row0, column0);
+        const __m256i texel10 = gather(row0, column1);
+        const __m256i texel01 = gather(row1, column0);
+        const __m256i texel11 = gather(row1, column1);
+
+        // BGRA8 bytes in r, g, b, a order.
+        constexpr i32 shifts[4] = {16, 8, 0, 24};
+        const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+        const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+        for (u32 c = 0; c < 4; ++c)
+        {
+            const __m128i shift = _mm_cvtsi32_si128(shifts[c]);
+            auto channel = [&](__m256i texel)
+            {
+                return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(texel, shift),
+                    byte_mask));
+            };
+            const __m256 c00 = channel(texel00);
+            const __m256 c01 = channel(texel01);
+            const __m256 top = _mm256_fmadd_ps(_mm256_sub_ps(channel(texel10), c00), weight_x,
+                c00);
+            const __m256 bottom = _mm256_fmadd_ps(_mm256_sub_ps(channel(texel11), c01),
+                weight_x, c01);
+            colors[c] = _mm256_mul_ps(_mm256_fmadd_ps(_mm256_sub_ps(bottom, top), weight_y, top),
+                scale);
+        }
+    }
+
+#endif
+
+    static void SamplePacket(const void* texture_handle, const f32* uvs, u32 width,
+        f32* colors)
+    {
+        const Texture& texture = *static_cast<const Texture*>(texture_handle);
+        const f32* u = uvs;
+        const f32* v = uvs + width;
+
+#if defined(RASTERIZER_SIMD_AVX2)
+        // Four lane packets fill both halves of the registers with their one quad.
+        __m256 colors8[4];
+        if (width == c_simd_lanes)
+        {
+            const TextureLevel& low = texture.GetLevel(SelectLevel(texture, u, v));
+            const TextureLevel& high = texture.GetLevel(SelectLevel(texture, u + c_quad_lanes,
+                v + c_quad_lanes));
+            SampleBilinear8(texture.GetTexels(), SplatLevels(low, high), _mm256_loadu_ps(u),
+                _mm256_loadu_ps(v), colors8);
+            for (u32 c = 0; c < 4; ++c)
+            {
+                _mm256_storeu_ps(colors + c * c_simd_lanes, colors8[c]);
+            }
+        }
+        else if (width == c_quad_lanes)
+        {
+            const TextureLevel& level = texture.GetLevel(SelectLevel(texture, u, v));
+            SampleBilinear8(texture.GetTexels(), SplatLevels(level, level),
+                _mm256_broadcast_ps(reinterpret_cast<const __m128*>(u)),
+                _mm256_broadcast_ps(reinterpret_cast<const __m128*>(v)), colors8);
+            for (u32 c = 0; c < 4; ++c)
+            {
+                _mm_storeu_ps(colors + c * c_quad_lanes, _mm256_castps256_ps128(colors8[c]));
+            }
+        }
+#else
+        // Without gathers the lanes are sampled one at a time.
+        for (u32 first = 0; first + c_quad_lanes <= width; first += c_quad_lanes)
+        {
+            const TextureLevel& level = texture.GetLevel(SelectLevel(texture, u + first,
+                v + first));
+            for (u32 lane = first; lane < first + c_quad_lanes; ++lane)
+            {
+                SampleBilinear(texture.GetTexels(), level, u[lane], v[lane], colors + lane,
+                    width);
+            }
+        }
+#endif
+    }
+
+    static void Sample(const void* texture_handle, f32 u, f32 v, f32 lod, f32* color)
+    {
+        const Texture& texture = *static_cast<const Texture*>(texture_handle);
+        const f32 last = static_cast<f32>(texture.GetLevelCount() - 1);
+        // NaN fails the comparison and samples the base level.
+        const u32 level = lod > 0.0f ? static_cast<u32>(std::min(lod + 0.5f, last)) : 0;
+        SampleBilinear(texture.GetTexels(), texture.GetLevel(level), u, v, color, 1);
+    }
+
+    static constexpr TextureSamplerAPI c_sampler_api = {SamplePacket, Sample};
+
+    TextureBinding Texture::GetBinding() const
+    {
+        return {this, &c_sampler_api};
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,114 @@
+#include "pipeline/tile_cache.hpp"
+
+#include "pipeline/simd.hpp"
+
+#include <bit>
+
+namespace Rasterizer
+{
+
+    void TileCache::Resize(u32 target_count)
+    {
+        m_pixels.assign(static_cast<size_t>(target_count) * c_tile_cache_pixels, 0);
+        m_tile = m_pixels.data();
+        m_targets = nullptr;
+        m_target_count = target_count;
+        m_cached = 0;
+    }
+
+    void TileCache::Begin(RenderTarget* const* targets, u32 x0, u32 y0)
+    {
+        m_tile = m_pixels.data();
+        m_targets = targets;
+        m_x0 = x0;
+        m_y0 = y0;
+        m_cached = 0;
+    }
+
+    void TileCache::BeginInPlace(u32* pixels, u32 x0, u32 y0)
+    {
+        m_tile = pixels;
+        m_targets = nullptr;
+        m_x0 = x0;
+        m_y0 = y0;
+        m_cached = ~0ull;
+    }
+
+    void TileCache::Load(u32 block)
+    {
+        STATIC_ASSERT(c_hiz_block_size == c_simd_lanes, "A row pair converts as two blocks");
+        m_cached |= 1ull << block;
+        const u32 x0 = m_x0 + (block % c_blocks_per_row) * c_hiz_block_size;
+        const u32 y0 = m_y0 + (block / c_blocks_per_row) * c_hiz_block_size;
+        for (u32 t = 0; t < m_target_count; ++t)
+        {
+            RenderTarget& target = *m_targets[t];
+            u32* pixels = m_pixels.data() + t * c_tile_cache_pixels + block * c_block_pixels;
+            if (x0 + c_hiz_block_size <= target.GetWidth() &&
+                y0 + c_hiz_block_size <= target.GetHeight())
+            {
+                for (u32 y = 0; y < c_hiz_block_size; y += 2)
+                {
+                    RowsToQuadBlocks8(target.GetRow(y0 + y) + x0, target.GetRow(y0 + y + 1) + x0,
+                        pixels + y * c_hiz_block_size);
+                }
+                continue;
+            }
+            // At the right or bottom edge: only the pixels inside the target, which are also
+            // the only ones the kernels write.
+            const u32 columns = std::min(c_hiz_block_size, target.GetWidth() - x0);
+            const u32 rows = std::min(c_hiz_block_size, target.GetHeight() - y0);
+            for (u32 y = 0; y < rows; ++y)
+            {
+                for (u32 x = 0; x < columns; ++x)
+                {
+                    pixels[BlockPixel(x, y)] = target.GetRow(y0 + y)[x0 + x];
+                }
+            }
+        }
+    }
+
+    u32 TileCache::Flush()
+    {
+        if (!m_targets)
+        {
+            m_cached = 0;
+            return 0;
+        }
+        const u32 flushed = static_cast<u32>(std::popcount(m_cached));
+        for (u64 cached = m_cached; cached; cached &= cached - 1)
+        {
+            const u32 block = static_cast<u32>(std::countr_zero(cached));
+            const u32 x0 = m_x0 + (block % c_blocks_per_row) * c_hiz_block_size;
+            const u32 y0 = m_y0 + (block / c_blocks_per_row) * c_hiz_block_size;
+            for (u32 t = 0; t < m_target_count; ++t)
+            {
+                RenderTarget& target = *m_targets[t];
+                const u32* pixels =
+                    m_pixels.data() + t * c_tile_cache_pixels + block * c_block_pixels;
+                if (x0 + c_hiz_block_size <= target.GetWidth() &&
+                    y0 + c_hiz_block_size <= target.GetHeight())
+                {
+                    for (u32 y = 0; y < c_hiz_block_size; y += 2)
+                    {
+                        QuadBlocksToRows8(pixels + y * c_hiz_block_size,
+                            target.GetRow(y0 + y) + x0, target.GetRow(y0 + y + 1) + x0);
+                    }
+                    continue;
+                }
+                const u32 columns = std::min(c_hiz_block_size, target.GetWidth() - x0);
+                const u32 rows = std::min(c_hiz_block_size, target.GetHeight() - y0);
+                for (u32 y = 0; y < rows; ++y)
+                {
+                    for (u32 x = 0; x < columns; ++x)
+                    {
+                        target.GetRow(y0 + y)[x0 + x] = pixels[BlockPixel(x, y)];
+                    }
+                }
+            }
+        }
+        m_cached = 0;
+        return flushed;
+    }
+
+} // namespace Rasterizer
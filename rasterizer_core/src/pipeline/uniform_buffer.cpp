@@ -0,0 +1,66 @@
+#include "pipeline/uniform_buffer.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Rasterizer
+{
+
+    u64 UniformBuffer::NextVersion()
+    {
+        // Starts at 1 so 0 can mean "nothing uploaded".
+        static std::atomic<u64> s_next_version {1};
+        return s_next_version.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool UniformLayout::Build(const ShaderReflection& vs, const ShaderReflection& fs)
+    {
+        m_entries.clear();
+        m_size = std::max(vs.uniform_size, fs.uniform_size);
+        for (const ShaderReflection* reflection : {&vs, &fs})
+        {
+            for (u32 i = 0; i < reflection->uniform_count; ++i)
+            {
+                const ShaderParam& uniform = reflection->uniforms[i];
+                const UniformSlot slot = {uniform.offset, uniform.format};
+                const UniformSlot existing = Find(uniform.name, false);
+                if (!existing.IsValid())
+                {
+                    m_entries.push_back({uniform.name, slot});
+                }
+                else if (existing.offset != slot.offset || existing.format != slot.format)
+                {
+                    LOG_ERROR("Pipeline configuration failed: uniform '%s' has mismatching "
+                        "formats or offsets between VS and FS", uniform.name);
+                    m_entries.clear();
+                    m_size = 0;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    UniformSlot UniformLayout::Find(const char* name) const
+    {
+        return Find(name, true);
+    }
+
+    UniformSlot UniformLayout::Find(const char* name, bool warn) const
+    {
+        for (const Entry& entry : m_entries)
+        {
+            if (entry.name == name)
+            {
+                return entry.slot;
+            }
+        }
+        if (warn)
+        {
+            LOG_WARNING("The bound shaders declare no uniform '%s'", name);
+        }
+        return {};
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,77 @@
+#include "platform/Headless/platform_headless.hpp"
+#include "log.hpp"
+
+#include <cstdio>
+
+namespace Rasterizer::Headless
+{
+
+    Window::Window(const std::string& title, int width, int height, const HeadlessDesc& headless)
+        : m_title(title), m_width(std::max(width, 0)), m_height(std::max(height, 0)),
+        m_desc(headless)
+    {
+        m_framebuffer.resize(static_cast<size_t>(m_width) * m_height, 0xFF000000);
+    }
+
+    bool Window::IsOpen()
+    {
+        return m_is_open;
+    }
+
+    const std::string& Window::GetTitle()
+    {
+        return m_title;
+    }
+
+    int Window::GetWidth()
+    {
+        return m_width;
+    }
+
+    int Window::GetHeight()
+    {
+        return m_height;
+    }
+
+    void* Window::GetWindowHandle()
+    {
+        return nullptr;
+    }
+
+    Surface Window::GetSurface()
+    {
+        const u32 width = static_cast<u32>(m_width);
+        const u32 height = static_cast<u32>(m_height);
+        return {m_framebuffer.data(), width, height, width, SurfaceFormat::BGRA8,
+            m_frame_index > 0 ? 1u : 0u};
+    }
+
+    void Window::Draw()
+    {
+        if (!m_desc.dump_path.empty())
+        {
+            char path[1024];
+            std::snprintf(path, sizeof(path), m_desc.dump_path.c_str(), m_frame_index);
+            const u32 width = static_cast<u32>(m_width);
+            const u32 height = static_cast<u32>(m_height);
+            if (!WriteImage(path, m_desc.dump_format, m_framebuffer.data(), width, height, width))
+            {
+                // Keep rendering, but stop trying to write into an unusable location.
+                LOG_ERROR("Frame dumping of '%s' disabled", m_title.c_str());
+                m_desc.dump_path.clear();
+            }
+        }
+
+        ++m_frame_index;
+        if (m_desc.frame_count != 0 && m_frame_index >= m_desc.frame_count)
+        {
+            m_is_open = false;
+        }
+    }
+
+    void Window::Draw(const std::vector<DamageRect>&)
+    {
+        Draw();
+    }
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "platform/platform.hpp"
+#include <vector>
+
+namespace Rasterizer::Headless
+{
+
+    /**
+     * @brief Window rendering into plain memory. Draw() optionally writes the frame to disk
+     * and otherwise costs nothing, there are no events to poll. The single framebuffer keeps
+     * the previous frame, so damage is not needed and ignored.
+     */
+    class Window : public IWindow
+    {
+    public:
+        Window(const std::string& title, int width, int height, const HeadlessDesc& headless);
+
+        virtual void PollEvents() override {}
+        virtual bool IsOpen() override;
+
+        virtual const std::string& GetTitle() override;
+        virtual int GetWidth() override;
+        virtual int GetHeight() override;
+        virtual void* GetWindowHandle() override;
+        virtual Surface GetSurface() override;
+        virtual void Draw() override;
+        virtual void Draw(const std::vector<DamageRect>& damage) override;
+
+    private:
+        std::string m_title {};
+        int m_width {0};
+        int m_height {0};
+        HeadlessDesc m_desc {};
+        u32 m_frame_index {0};
+        bool m_is_open {true};
+
+        std::vector<u32> m_framebuffer {};
+    };
+
+}
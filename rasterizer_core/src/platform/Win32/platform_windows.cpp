@@ -2,6 +2,8 @@
 #include "platform/Win32/platform_windows.hpp"
 #include "platform_windows.hpp"
 
+#include <dwmapi.h>
+
 namespace Rasterizer::Windows
 {
 
@@ -18,8 +20,10 @@ namespace Rasterizer::Windows
         }
     }
 
-    Window::Window(const std::string& title, int width, int height)
-        : m_title(title), m_width(width), m_height(height)
+    Window::Window(const std::string& title, int width, int height,
+        const SwapchainDesc& swapchain)
+        : m_title(title), m_width(width), m_height(height),
+        m_present_mode(swapchain.present_mode)
     {
         // Define the window class
         const char CLASS_NAME[] = "Window Class";
@@ -32,6 +36,10 @@ namespace Rasterizer::Windows
         // Register the window class
         RegisterClass(&wc);
 
+        // Size the window so its client area matches the framebuffer and blits need no scaling
+        RECT rect = {0, 0, m_width, m_height};
+        AdjustWindowRect(&rect, WS_OVERLAPPEDWINDOW, FALSE);
+
         // Create the window
         HWND hwnd = CreateWindowEx(
             0,                            // Optional window styles
@@ -39,7 +47,8 @@ namespace Rasterizer::Windows
             m_title.c_str(),              // Window title
             WS_OVERLAPPEDWINDOW,          // Window style
             CW_USEDEFAULT, CW_USEDEFAULT, // Position
-            m_width, m_height,            // Size
+            rect.right - rect.left,       // Width
+            rect.bottom - rect.top,       // Height
             NULL,                         // Parent window
             NULL,                         // Menu
             GetModuleHandle(NULL),        // Instance handle
@@ -57,18 +66,52 @@ namespace Rasterizer::Windows
         m_window_handle.handle = hwnd;
         m_is_open = (m_window_handle.handle != nullptr);
 
-        m_framebuffer.resize(m_width * m_height, 0xFF0000FF); // Initialize framebuffer with zeros
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = m_width;
+        bmi.bmiHeader.biHeight = -m_height; // Negative to flip Y so it's top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB; // no compression
+
+        const u32 buffer_count = std::clamp(swapchain.buffer_count, 2u, 3u);
+        m_buffers.resize(buffer_count);
+        HDC window_dc = GetDC(hwnd);
+        for (u32 i = 0; i < buffer_count; ++i)
+        {
+            Buffer& buffer = m_buffers[i];
+            void* bits = nullptr;
+            buffer.bitmap = CreateDIBSection(window_dc, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+            buffer.pixels = static_cast<u32*>(bits);
+            buffer.dc = CreateCompatibleDC(window_dc);
+            buffer.previous_bitmap = SelectObject(buffer.dc, buffer.bitmap);
+            std::fill(buffer.pixels, buffer.pixels + m_width * m_height, 0xFF0000FF);
+            if (i != m_back_buffer)
+            {
+                m_free.push_back(i);
+            }
+        }
+        ReleaseDC(hwnd, window_dc);
 
-        m_bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-        m_bmi.bmiHeader.biWidth = m_width;
-        m_bmi.bmiHeader.biHeight = -m_height; // Negative to flip Y so it's top-down
-        m_bmi.bmiHeader.biPlanes = 1;
-        m_bmi.bmiHeader.biBitCount = 32;
-        m_bmi.bmiHeader.biCompression = BI_RGB; // no compression
+        m_present_thread = std::thread(&Window::PresentLoop, this);
     }
 
     Window::~Window()
     {
+        {
+            std::lock_guard<std::mutex> lock(m_swap_mutex);
+            m_stopping = true;
+        }
+        m_swap_changed.notify_all();
+        m_present_thread.join();
+
+        for (Buffer& buffer : m_buffers)
+        {
+            SelectObject(buffer.dc, buffer.previous_bitmap);
+            DeleteDC(buffer.dc);
+            DeleteObject(buffer.bitmap);
+        }
+
         if (m_window_handle.handle)
         {
             DestroyWindow(static_cast<HWND>(m_window_handle.handle));
@@ -114,13 +157,122 @@ namespace Rasterizer::Windows
         return &m_window_handle;
     }
 
+    Surface Window::GetSurface()
+    {
+        const u32 width = static_cast<u32>(m_width);
+        const u32 height = static_cast<u32>(m_height);
+        // 32-bit DIB rows are always DWORD aligned, so the pitch is the width.
+        const Buffer& buffer = m_buffers[m_back_buffer];
+        const u32 age = buffer.frame ? static_cast<u32>(m_frame_count + 1 - buffer.frame) : 0;
+        return {buffer.pixels, width, height, width, SurfaceFormat::BGRA8, age};
+    }
+
     void Window::Draw()
     {
+        Queue(nullptr);
+    }
+
+    void Window::Draw(const std::vector<DamageRect>& damage)
+    {
+        Queue(&damage);
+    }
+
+    void Window::Queue(const std::vector<DamageRect>* damage)
+    {
+        std::unique_lock<std::mutex> lock(m_swap_mutex);
+        Buffer& back = m_buffers[m_back_buffer];
+        back.frame = ++m_frame_count;
+        back.full_damage = !damage;
+        back.damage.clear();
+        if (damage)
+        {
+            back.damage.insert(back.damage.end(), damage->begin(), damage->end());
+        }
+        if (m_present_mode == PresentMode::Mailbox && !m_queued.empty())
+        {
+            // The waiting frame was never shown; the new one takes its place, and has to
+            // update what the waiting one would have.
+            const Buffer& dropped = m_buffers[m_queued.back()];
+            back.full_damage |= dropped.full_damage;
+            back.damage.insert(back.damage.end(), dropped.damage.begin(), dropped.damage.end());
+            m_free.push_back(m_queued.back());
+            m_queued.pop_back();
+        }
+        m_queued.push_back(m_back_buffer);
+        m_swap_changed.notify_all();
+
+        m_swap_changed.wait(lock, [this]() { return !m_free.empty(); });
+        m_back_buffer = m_free.front();
+        m_free.pop_front();
+    }
+
+    void Window::PresentLoop()
+    {
+        while (true)
+        {
+            u32 buffer_index = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_swap_mutex);
+                m_swap_changed.wait(lock, [this]() { return m_stopping || !m_queued.empty(); });
+                if (m_stopping)
+                {
+                    return;
+                }
+            }
+
+            // Wait for the compositor's next frame outside the lock, so a mailbox frame
+            // submitted meanwhile still replaces the queued one.
+            if (m_present_mode != PresentMode::Immediate)
+            {
+                DwmFlush();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_swap_mutex);
+                buffer_index = m_queued.front();
+                m_queued.pop_front();
+            }
+
+            Blit(buffer_index);
+
+            {
+                std::lock_guard<std::mutex> lock(m_swap_mutex);
+                m_free.push_back(buffer_index);
+            }
+            m_swap_changed.notify_all();
+        }
+    }
+
+    void Window::Blit(u32 buffer_index)
+    {
+        const Buffer& buffer = m_buffers[buffer_index];
         HDC hdc = GetDC(m_window_handle.handle);
-        StretchDIBits(hdc,
-            0, 0, m_width, m_height,
-            0, 0, m_width, m_height,
-            m_framebuffer.data(), &m_bmi, DIB_RGB_COLORS, SRCCOPY);
+
+        RECT client = {};
+        GetClientRect(m_window_handle.handle, &client);
+        const bool stretched = client.right != m_width || client.bottom != m_height;
+        if (!stretched && m_presented && !buffer.full_damage)
+        {
+            // Only the regions that changed since the frame on screen.
+            for (const DamageRect& rect : buffer.damage)
+            {
+                BitBlt(hdc, static_cast<int>(rect.x), static_cast<int>(rect.y),
+                    static_cast<int>(rect.width), static_cast<int>(rect.height), buffer.dc,
+                    static_cast<int>(rect.x), static_cast<int>(rect.y), SRCCOPY);
+            }
+        }
+        else if (!stretched)
+        {
+            BitBlt(hdc, 0, 0, m_width, m_height, buffer.dc, 0, 0, SRCCOPY);
+        }
+        else
+        {
+            StretchBlt(hdc, 0, 0, client.right, client.bottom,
+                buffer.dc, 0, 0, m_width, m_height, SRCCOPY);
+        }
+        // Make sure GDI is done reading before the buffer is rendered into again.
+        GdiFlush();
+        m_presented = !stretched;
 
         ReleaseDC(m_window_handle.handle, hdc);
     }
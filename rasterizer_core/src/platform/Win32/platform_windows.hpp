@@ -1,6 +1,10 @@
 #ifdef WIN32
 #pragma once
 #include "platform/platform.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace Rasterizer::Windows
@@ -14,7 +18,8 @@ namespace Rasterizer::Windows
     class Window : public IWindow
     {
     public:
-        Window(const std::string& title, int width, int height);
+        Window(const std::string& title, int width, int height,
+            const SwapchainDesc& swapchain = {});
         ~Window() override;
 
         virtual void PollEvents() override;
@@ -24,19 +29,52 @@ namespace Rasterizer::Windows
         virtual int GetWidth() override;
         virtual int GetHeight() override;
         virtual void* GetWindowHandle() override;
-        virtual void Draw();
+        virtual Surface GetSurface() override;
+        virtual void Draw() override;
+        virtual void Draw(const std::vector<DamageRect>& damage) override;
     private:
+        // Both Draw()s; damage is null when the whole frame changed.
+        void Queue(const std::vector<DamageRect>* damage);
+        void PresentLoop();
+        void Blit(u32 buffer_index);
 
     private:
-        const std::string& m_title {""};
+        std::string m_title {};
         int m_width {0};
         int m_height {0};
         bool m_is_open {false};
         WindowHandle m_window_handle {};
 
-        std::vector<u32> m_framebuffer {};
-        BITMAPINFO m_bmi = {};
+        // GDI DIB section the rasterizer writes into, selected into its own memory DC so
+        // presenting is a single BitBlt.
+        struct Buffer
+        {
+            HBITMAP bitmap {nullptr};
+            HDC dc {nullptr};
+            HGDIOBJ previous_bitmap {nullptr};
+            u32* pixels {nullptr};
+            // Number of the frame last rendered into the buffer, 0 if none was.
+            u64 frame {0};
+            // What that frame changed since the one shown before it, all of it if full_damage.
+            std::vector<DamageRect> damage {};
+            bool full_damage {true};
+        };
+
+        // Swapchain: the back buffer belongs to the render thread, queued buffers wait for the
+        // present thread, free buffers are ready to become the next back buffer.
+        std::vector<Buffer> m_buffers {};
+        PresentMode m_present_mode {PresentMode::Vsync};
+        u32 m_back_buffer {0};
+        u64 m_frame_count {0};
+        std::deque<u32> m_queued {};
+        std::deque<u32> m_free {};
+        std::mutex m_swap_mutex {};
+        std::condition_variable m_swap_changed {};
+        bool m_stopping {false};
+        std::thread m_present_thread {};
+        // Present thread only: the window shows nothing to keep before the first blit.
+        bool m_presented {false};
     };
 
 }
-#endif // WIN32
\ No newline at end of file
+#endif // WIN32
@@ -0,0 +1,202 @@
+#include "platform/directory_watcher.hpp"
+#include "log.hpp"
+
+#if defined(__linux__) && !defined(WIN32)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif !defined(WIN32)
+#include <thread>
+#endif
+
+namespace Rasterizer
+{
+
+    DirectoryWatcherPtr DirectoryWatcher::Create(const std::string& directory)
+    {
+        DirectoryWatcherPtr watcher = MakeUnique<DirectoryWatcher>();
+        watcher->m_directory = directory;
+        if (!watcher->Watch(directory))
+        {
+            return nullptr;
+        }
+        return watcher;
+    }
+
+#if defined(WIN32)
+
+    bool DirectoryWatcher::Watch(const std::string& directory)
+    {
+        m_handle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (m_handle == INVALID_HANDLE_VALUE)
+        {
+            LOG_ERROR("Could not watch '%s' (error %lu)", directory.c_str(), GetLastError());
+            return false;
+        }
+        m_overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+        return m_overlapped.hEvent && Issue();
+    }
+
+    bool DirectoryWatcher::Issue()
+    {
+        ResetEvent(m_overlapped.hEvent);
+        const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+            FILE_NOTIFY_CHANGE_SIZE;
+        if (!ReadDirectoryChangesW(m_handle, m_buffer, sizeof(m_buffer), FALSE, filter, nullptr,
+            &m_overlapped, nullptr))
+        {
+            LOG_ERROR("Could not watch '%s' (error %lu)", m_directory.c_str(), GetLastError());
+            return false;
+        }
+        return true;
+    }
+
+    bool DirectoryWatcher::Wait(u32 timeout_ms, std::vector<std::string>& changed)
+    {
+        if (WaitForSingleObject(m_overlapped.hEvent, timeout_ms) != WAIT_OBJECT_0)
+        {
+            return false;
+        }
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(m_handle, &m_overlapped, &bytes, FALSE) || bytes == 0)
+        {
+            // The buffer overflowed.
+            changed.emplace_back();
+        }
+        else
+        {
+            const u8* record = m_buffer;
+            for (;;)
+            {
+                const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(record);
+                const int length = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+                const int size = WideCharToMultiByte(CP_UTF8, 0, info->FileName, length,
+                    nullptr, 0, nullptr, nullptr);
+                std::string name(static_cast<size_t>(size), '\0');
+                WideCharToMultiByte(CP_UTF8, 0, info->FileName, length, name.data(), size,
+                    nullptr, nullptr);
+                changed.push_back(std::move(name));
+                if (info->NextEntryOffset == 0)
+                {
+                    break;
+                }
+                record += info->NextEntryOffset;
+            }
+        }
+        Issue();
+        return true;
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+        if (m_handle != INVALID_HANDLE_VALUE)
+        {
+            CancelIo(m_handle);
+            CloseHandle(m_handle);
+        }
+        if (m_overlapped.hEvent)
+        {
+            CloseHandle(m_overlapped.hEvent);
+        }
+    }
+
+#elif defined(__linux__)
+
+    bool DirectoryWatcher::Watch(const std::string& directory)
+    {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        // Linkers and copies finish with a close after writing, renames arrive as moves.
+        if (m_fd < 0 ||
+            inotify_add_watch(m_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            LOG_ERROR("Could not watch '%s'", directory.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool DirectoryWatcher::Wait(u32 timeout_ms, std::vector<std::string>& changed)
+    {
+        pollfd descriptor = {m_fd, POLLIN, 0};
+        if (poll(&descriptor, 1, static_cast<int>(timeout_ms)) <= 0)
+        {
+            return false;
+        }
+        alignas(inotify_event) char buffer[4096];
+        bool any = false;
+        for (;;)
+        {
+            const ssize_t bytes = read(m_fd, buffer, sizeof(buffer));
+            if (bytes <= 0)
+            {
+                return any;
+            }
+            for (ssize_t offset = 0; offset < bytes;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    changed.emplace_back();
+                }
+                else if (event->len > 0)
+                {
+                    changed.emplace_back(event->name);
+                }
+                any = true;
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+    }
+
+#else
+
+    bool DirectoryWatcher::Watch(const std::string& directory)
+    {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            m_write_times[entry.path().filename().string()] = entry.last_write_time(error);
+        }
+        if (error)
+        {
+            LOG_ERROR("Could not watch '%s'", directory.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool DirectoryWatcher::Wait(u32 timeout_ms, std::vector<std::string>& changed)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        bool any = false;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(m_directory, error))
+        {
+            const auto time = entry.last_write_time(error);
+            auto [known, inserted] =
+                m_write_times.try_emplace(entry.path().filename().string(), time);
+            if (inserted || known->second != time)
+            {
+                known->second = time;
+                changed.push_back(known->first);
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    DirectoryWatcher::~DirectoryWatcher() = default;
+
+#endif
+
+} // namespace Rasterizer
@@ -0,0 +1,72 @@
+#include "platform/dynamic_library.hpp"
+#include "log.hpp"
+
+#ifndef WIN32
+#include <dlfcn.h>
+#endif
+
+namespace Rasterizer
+{
+
+#ifdef WIN32
+
+    DynamicLibraryPtr DynamicLibrary::Open(const std::string& path)
+    {
+        HMODULE handle = LoadLibraryA(path.c_str());
+        if (!handle)
+        {
+            LOG_ERROR("Could not load '%s' (error %lu)", path.c_str(), GetLastError());
+            return nullptr;
+        }
+        DynamicLibraryPtr library = MakeUnique<DynamicLibrary>();
+        library->m_handle = handle;
+        library->m_path = path;
+        return library;
+    }
+
+    void* DynamicLibrary::GetSymbol(const char* name) const
+    {
+        return reinterpret_cast<void*>(GetProcAddress(m_handle, name));
+    }
+
+    DynamicLibrary::~DynamicLibrary()
+    {
+        if (m_handle)
+        {
+            FreeLibrary(m_handle);
+        }
+    }
+
+#else
+
+    DynamicLibraryPtr DynamicLibrary::Open(const std::string& path)
+    {
+        // Local symbols keep two versions of the same module from binding to each other.
+        void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle)
+        {
+            LOG_ERROR("Could not load '%s': %s", path.c_str(), dlerror());
+            return nullptr;
+        }
+        DynamicLibraryPtr library = MakeUnique<DynamicLibrary>();
+        library->m_handle = handle;
+        library->m_path = path;
+        return library;
+    }
+
+    void* DynamicLibrary::GetSymbol(const char* name) const
+    {
+        return dlsym(m_handle, name);
+    }
+
+    DynamicLibrary::~DynamicLibrary()
+    {
+        if (m_handle)
+        {
+            dlclose(m_handle);
+        }
+    }
+
+#endif
+
+} // namespace Rasterizer
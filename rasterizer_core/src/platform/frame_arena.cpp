@@ -0,0 +1,41 @@
+#include "platform/frame_arena.hpp"
+
+namespace Rasterizer
+{
+
+    void FrameArena::Reset()
+    {
+        if (m_blocks.size() > 1)
+        {
+            // The frame did not fit: replace the chain by one block large enough for all of it.
+            const size_t capacity = GetCapacity();
+            m_blocks.clear();
+            m_blocks.push_back({MakeUnique<u8[]>(capacity), capacity});
+            ++m_block_allocations;
+        }
+        m_offset = 0;
+        m_used = 0;
+        m_last = nullptr;
+    }
+
+    size_t FrameArena::GetCapacity() const
+    {
+        size_t capacity = 0;
+        for (const Block& block : m_blocks)
+        {
+            capacity += block.size;
+        }
+        return capacity;
+    }
+
+    void FrameArena::AddBlock(size_t min_size)
+    {
+        // Doubling keeps the number of blocks a growing frame needs logarithmic. Blocks are
+        // zeroed on purpose: their pages get faulted in here rather than while rasterizing.
+        const size_t size = std::max({m_block_size, min_size, GetCapacity()});
+        m_blocks.push_back({MakeUnique<u8[]>(size), size});
+        m_offset = 0;
+        ++m_block_allocations;
+    }
+
+} // namespace Rasterizer
@@ -0,0 +1,146 @@
+#include "platform/image_writer.hpp"
+#include "log.hpp"
+
+#include <array>
+#include <cstdio>
+
+namespace Rasterizer
+{
+
+    static const std::array<u32, 256>& CrcTable()
+    {
+        static const std::array<u32, 256> s_table = []()
+        {
+            std::array<u32, 256> table {};
+            for (u32 i = 0; i < 256; ++i)
+            {
+                u32 c = i;
+                for (u32 bit = 0; bit < 8; ++bit)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                table[i] = c;
+            }
+            return table;
+        }();
+        return s_table;
+    }
+
+    static u32 UpdateCrc(u32 crc, const u8* data, size_t size)
+    {
+        const std::array<u32, 256>& table = CrcTable();
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    static void AppendU32(std::vector<u8>& out, u32 value)
+    {
+        out.insert(out.end(), {static_cast<u8>(value >> 24), static_cast<u8>(value >> 16),
+            static_cast<u8>(value >> 8), static_cast<u8>(value)});
+    }
+
+    static void AppendChunk(std::vector<u8>& out, const char* type, const std::vector<u8>& data)
+    {
+        AppendU32(out, static_cast<u32>(data.size()));
+        const size_t type_offset = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        const u32 crc = UpdateCrc(0xFFFFFFFFu, out.data() + type_offset, data.size() + 4);
+        AppendU32(out, crc ^ 0xFFFFFFFFu);
+    }
+
+    /**
+     * @brief PNG file of the image, the zlib stream made of uncompressed deflate blocks.
+     */
+    static std::vector<u8> EncodePNG(const u32* pixels, u32 width, u32 height, u32 pitch)
+    {
+        // Every scanline starts with filter type 0 (none), followed by RGBA bytes.
+        std::vector<u8> scanlines;
+        scanlines.reserve((static_cast<size_t>(width) * 4 + 1) * height);
+        for (u32 y = 0; y < height; ++y)
+        {
+            scanlines.push_back(0);
+            const u32* row = pixels + static_cast<size_t>(y) * pitch;
+            for (u32 x = 0; x < width; ++x)
+            {
+                const u32 p = row[x];
+                scanlines.insert(scanlines.end(), {static_cast<u8>(p >> 16),
+                    static_cast<u8>(p >> 8), static_cast<u8>(p), static_cast<u8>(p >> 24)});
+            }
+        }
+
+        constexpr size_t c_max_stored_block = 65535;
+        std::vector<u8> zlib = {0x78, 0x01};
+        u32 adler_a = 1;
+        u32 adler_b = 0;
+        size_t offset = 0;
+        do
+        {
+            const size_t size = std::min(c_max_stored_block, scanlines.size() - offset);
+            const bool last = offset + size == scanlines.size();
+            const u16 length = static_cast<u16>(size);
+            const u16 inverse_length = static_cast<u16>(~length);
+            zlib.insert(zlib.end(), {static_cast<u8>(last ? 1 : 0), static_cast<u8>(length),
+                static_cast<u8>(length >> 8), static_cast<u8>(inverse_length),
+                static_cast<u8>(inverse_length >> 8)});
+            zlib.insert(zlib.end(), scanlines.begin() + offset,
+                scanlines.begin() + offset + size);
+            for (size_t i = offset; i < offset + size; ++i)
+            {
+                adler_a = (adler_a + scanlines[i]) % 65521;
+                adler_b = (adler_b + adler_a) % 65521;
+            }
+            offset += size;
+        } while (offset < scanlines.size());
+        AppendU32(zlib, (adler_b << 16) | adler_a);
+
+        std::vector<u8> header;
+        AppendU32(header, width);
+        AppendU32(header, height);
+        // 8 bits per channel, color type 6 (RGBA), default compression, filter, no interlace.
+        header.insert(header.end(), {8, 6, 0, 0, 0});
+
+        std::vector<u8> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        AppendChunk(png, "IHDR", header);
+        AppendChunk(png, "IDAT", zlib);
+        AppendChunk(png, "IEND", {});
+        return png;
+    }
+
+    bool WriteImage(const std::string& path, ImageFormat format, const u32* pixels, u32 width,
+        u32 height, u32 pitch)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            LOG_ERROR("Could not open '%s' for writing", path.c_str());
+            return false;
+        }
+
+        bool written = true;
+        if (format == ImageFormat::PNG)
+        {
+            const std::vector<u8> png = EncodePNG(pixels, width, height, pitch);
+            written = std::fwrite(png.data(), 1, png.size(), file) == png.size();
+        }
+        else
+        {
+            for (u32 y = 0; y < height && written; ++y)
+            {
+                const u32* row = pixels + static_cast<size_t>(y) * pitch;
+                written = std::fwrite(row, sizeof(u32), width, file) == width;
+            }
+        }
+
+        if (std::fclose(file) != 0 || !written)
+        {
+            LOG_ERROR("Failed to write image '%s'", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+} // namespace Rasterizer
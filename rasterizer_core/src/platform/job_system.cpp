@@ -0,0 +1,220 @@
+#include "platform/job_system.hpp"
+#include "platform/profiler.hpp"
+
+namespace Rasterizer
+{
+
+    static thread_local const JobSystem* s_current_system = nullptr;
+    static thread_local u32 s_worker_index = 0;
+
+    JobSystem::JobSystem(u32 worker_count)
+        : m_worker_count(std::max(worker_count, 1u))
+    {
+        for (u32 i = 0; i < m_worker_count; ++i)
+        {
+            m_queues.push_back(MakeUnique<WorkerQueue>());
+        }
+
+        s_current_system = this;
+        s_worker_index = 0;
+        Profiler::SetThreadName("worker 0");
+
+        m_threads.reserve(m_worker_count - 1);
+        for (u32 i = 1; i < m_worker_count; ++i)
+        {
+            m_threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+        if (s_current_system == this)
+        {
+            s_current_system = nullptr;
+        }
+    }
+
+    JobSystemPtr JobSystem::Create(u32 worker_count)
+    {
+        if (worker_count == 0)
+        {
+            worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        return MakeShared<JobSystem>(worker_count);
+    }
+
+    void JobSystem::Run(const Job& job)
+    {
+        Push(job);
+    }
+
+    void JobSystem::RunAfter(JobCounter& dependency, const Job& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(dependency.m_mutex);
+            if (dependency.m_value.load(std::memory_order_acquire) != 0)
+            {
+                dependency.m_waiting.push_back(job);
+                return;
+            }
+        }
+        Push(job);
+    }
+
+    void JobSystem::Signal(JobCounter& counter)
+    {
+        u32 value = counter.m_value.load(std::memory_order_relaxed);
+        while (value > 1)
+        {
+            if (counter.m_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel))
+            {
+                return;
+            }
+        }
+
+        // The transition to zero happens under the lock so Wait() can tell when the last
+        // signaller stopped touching the counter, and RunAfter() never misses a release.
+        std::vector<Job> released;
+        {
+            std::lock_guard<std::mutex> lock(counter.m_mutex);
+            counter.m_value.fetch_sub(1, std::memory_order_acq_rel);
+            released.swap(counter.m_waiting);
+        }
+        for (const Job& job : released)
+        {
+            Push(job);
+        }
+    }
+
+    void JobSystem::Wait(const JobCounter& counter)
+    {
+        const u32 worker_index = GetCurrentWorkerIndex();
+        Job job;
+        while (!counter.IsDone())
+        {
+            if (worker_index < m_worker_count && TryPop(worker_index, job))
+            {
+                Execute(worker_index, job);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // The counter may be destroyed right after this returns; wait for the signaller.
+        std::lock_guard<std::mutex> lock(counter.m_mutex);
+    }
+
+    void JobSystem::Push(const Job& job)
+    {
+        u32 worker_index = GetCurrentWorkerIndex();
+        if (worker_index >= m_worker_count)
+        {
+            worker_index = 0;
+        }
+
+        {
+            WorkerQueue& queue = *m_queues[worker_index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(job);
+        }
+
+        m_queued.fetch_add(1);
+        if (m_sleepers.load() > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            }
+            m_wake.notify_one();
+        }
+    }
+
+    bool JobSystem::TryPop(u32 worker_index, Job& job)
+    {
+        if (m_queued.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+
+        {
+            WorkerQueue& own = *m_queues[worker_index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty())
+            {
+                job = own.jobs.back();
+                own.jobs.pop_back();
+                m_queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (u32 i = 1; i < m_worker_count; ++i)
+        {
+            WorkerQueue& victim = *m_queues[(worker_index + i) % m_worker_count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty())
+            {
+                job = victim.jobs.front();
+                victim.jobs.pop_front();
+                m_queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void JobSystem::Execute(u32 worker_index, const Job& job)
+    {
+        {
+            PROFILE_ZONE_INDEXED(job.name, job.index);
+            job.function(job.data, job.index, worker_index);
+        }
+
+        if (job.signal)
+        {
+            Signal(*job.signal);
+        }
+    }
+
+    void JobSystem::WorkerLoop(u32 worker_index)
+    {
+        s_current_system = this;
+        s_worker_index = worker_index;
+        Profiler::SetThreadName(("worker " + std::to_string(worker_index)).c_str());
+
+        Job job;
+        while (true)
+        {
+            if (TryPop(worker_index, job))
+            {
+                Execute(worker_index, job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleepers.fetch_add(1);
+            m_wake.wait(lock, [this]() { return m_stopping || m_queued.load() > 0; });
+            m_sleepers.fetch_sub(1);
+            if (m_stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    u32 JobSystem::GetCurrentWorkerIndex() const
+    {
+        return s_current_system == this ? s_worker_index : ~0u;
+    }
+
+} // namespace Rasterizer
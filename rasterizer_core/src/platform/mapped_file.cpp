@@ -0,0 +1,118 @@
+#include "platform/mapped_file.hpp"
+#include "log.hpp"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Rasterizer
+{
+
+    MappedFilePtr MappedFile::Open(const std::string& path)
+    {
+        MappedFilePtr file = MakeShared<MappedFile>();
+        if (!file->Map(path))
+        {
+            return nullptr;
+        }
+        return file;
+    }
+
+#ifdef WIN32
+
+    bool MappedFile::Map(const std::string& path)
+    {
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+        {
+            LOG_ERROR("Could not open '%s' (error %lu)", path.c_str(), GetLastError());
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        {
+            LOG_ERROR("Could not map '%s': empty or unreadable file", path.c_str());
+            return false;
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+        {
+            LOG_ERROR("Could not map '%s' (error %lu)", path.c_str(), GetLastError());
+            return false;
+        }
+        m_data = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data)
+        {
+            LOG_ERROR("Could not map '%s' (error %lu)", path.c_str(), GetLastError());
+            return false;
+        }
+        return true;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_data)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping)
+        {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+        }
+    }
+
+#else
+
+    bool MappedFile::Map(const std::string& path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            LOG_ERROR("Could not open '%s'", path.c_str());
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            LOG_ERROR("Could not map '%s': empty or unreadable file", path.c_str());
+            close(fd);
+            return false;
+        }
+        m_size = static_cast<size_t>(info.st_size);
+
+        // The mapping stays valid after closing the descriptor.
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            LOG_ERROR("Could not map '%s'", path.c_str());
+            m_size = 0;
+            return false;
+        }
+        m_data = static_cast<const u8*>(data);
+        return true;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_data)
+        {
+            munmap(const_cast<u8*>(m_data), m_size);
+        }
+    }
+
+#endif
+
+} // namespace Rasterizer
@@ -1,4 +1,6 @@
 #include "platform/platform.hpp"
+#include "platform/Headless/platform_headless.hpp"
+#include "log.hpp"
 
 #ifdef WIN32
 #include "platform/Win32/platform_windows.hpp"
@@ -7,14 +9,22 @@
 namespace Rasterizer
 {
 
-    WindowPtr IWindow::Create(const std::string& title, int width, int height)
+    WindowPtr IWindow::Create(const std::string& title, int width, int height,
+        const SwapchainDesc& swapchain)
     {
 #ifdef WIN32
-        return MakeShared<Windows::Window>(title, width, height);
+        return MakeShared<Windows::Window>(title, width, height, swapchain);
 #else
-        // TODO: error handling
-        return nullptr;
+        (void)swapchain;
+        LOG_WARNING("No windowing backend on this platform, '%s' runs headless", title.c_str());
+        return CreateHeadless(title, width, height);
 #endif
     }
 
-}
\ No newline at end of file
+    WindowPtr IWindow::CreateHeadless(const std::string& title, int width, int height,
+        const HeadlessDesc& headless)
+    {
+        return MakeShared<Headless::Window>(title, width, height, headless);
+    }
+
+}
@@ -0,0 +1,274 @@
+#include "platform/profiler.hpp"
+#include "log.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace Rasterizer
+{
+
+    namespace
+    {
+
+        struct ThreadBuffer
+        {
+            std::mutex mutex {};
+            std::vector<ProfileEvent> events {};
+            std::atomic<u64> counters[c_max_profile_counters] {};
+            std::string name {};
+            u32 thread {0};
+        };
+
+        struct ZoneHistory
+        {
+            f64 ms[c_profile_history] {};
+            u32 last_calls {0};
+        };
+
+        // Everything below is guarded by s_mutex, except what a ThreadBuffer guards itself.
+        std::mutex s_mutex;
+        std::vector<UniquePtr<ThreadBuffer>> s_threads;
+        std::vector<std::string> s_counter_names;
+
+        std::vector<ProfileEvent> s_frame_events;
+        u64 s_frame_end_ns {0};
+        u64 s_frame_counters[c_max_profile_counters] {};
+
+        std::unordered_map<std::string, ZoneHistory> s_zone_history;
+        u64 s_counter_history[c_max_profile_counters][c_profile_history] {};
+        u32 s_history_cursor {0};
+        u32 s_history_frames {0};
+
+        thread_local ThreadBuffer* s_thread_buffer = nullptr;
+
+        ThreadBuffer& GetThreadBuffer()
+        {
+            if (!s_thread_buffer)
+            {
+                std::lock_guard<std::mutex> lock(s_mutex);
+                s_threads.push_back(MakeUnique<ThreadBuffer>());
+                s_thread_buffer = s_threads.back().get();
+                s_thread_buffer->thread = static_cast<u32>(s_threads.size() - 1);
+                s_thread_buffer->name = "thread " + std::to_string(s_thread_buffer->thread);
+            }
+            return *s_thread_buffer;
+        }
+
+        void WriteJsonString(std::ofstream& file, const char* text)
+        {
+            file << '"';
+            for (const char* c = text; *c; ++c)
+            {
+                if (*c == '"' || *c == '\\')
+                {
+                    file << '\\';
+                }
+                file << *c;
+            }
+            file << '"';
+        }
+
+    } // namespace
+
+    void Profiler::SetThreadName(const char* name)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard<std::mutex> lock(s_mutex);
+        buffer.name = name;
+    }
+
+    u64 Profiler::Now()
+    {
+        static const std::chrono::steady_clock::time_point s_origin =
+            std::chrono::steady_clock::now();
+        const auto elapsed = std::chrono::steady_clock::now() - s_origin;
+        return static_cast<u64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    void Profiler::RecordZone(const char* name, u64 begin_ns, u64 end_ns, u32 index)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.events.push_back({name, begin_ns, end_ns, index, buffer.thread});
+    }
+
+    u32 Profiler::RegisterCounter(const char* name)
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        for (u32 i = 0; i < s_counter_names.size(); ++i)
+        {
+            if (s_counter_names[i] == name)
+            {
+                return i;
+            }
+        }
+        if (s_counter_names.size() == c_max_profile_counters)
+        {
+            LOG_WARNING("Profiler counter '%s' dropped, all %u counters are in use", name,
+                c_max_profile_counters);
+            return c_max_profile_counters;
+        }
+        s_counter_names.push_back(name);
+        return static_cast<u32>(s_counter_names.size() - 1);
+    }
+
+    void Profiler::AddCounter(u32 counter, u64 value)
+    {
+        if (counter < c_max_profile_counters)
+        {
+            GetThreadBuffer().counters[counter].fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    void Profiler::EndFrame()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_frame_events.clear();
+        std::fill(std::begin(s_frame_counters), std::end(s_frame_counters), 0);
+        for (const UniquePtr<ThreadBuffer>& buffer : s_threads)
+        {
+            {
+                std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+                s_frame_events.insert(s_frame_events.end(), buffer->events.begin(),
+                    buffer->events.end());
+                buffer->events.clear();
+            }
+            for (u32 i = 0; i < c_max_profile_counters; ++i)
+            {
+                s_frame_counters[i] += buffer->counters[i].exchange(0, std::memory_order_relaxed);
+            }
+        }
+        std::sort(s_frame_events.begin(), s_frame_events.end(),
+            [](const ProfileEvent& a, const ProfileEvent& b) { return a.begin_ns < b.begin_ns; });
+        s_frame_end_ns = Now();
+
+        for (auto& [name, history] : s_zone_history)
+        {
+            history.ms[s_history_cursor] = 0.0;
+            history.last_calls = 0;
+        }
+        for (const ProfileEvent& event : s_frame_events)
+        {
+            ZoneHistory& history = s_zone_history[event.name];
+            history.ms[s_history_cursor] += static_cast<f64>(event.end_ns - event.begin_ns) * 1e-6;
+            ++history.last_calls;
+        }
+        for (u32 i = 0; i < c_max_profile_counters; ++i)
+        {
+            s_counter_history[i][s_history_cursor] = s_frame_counters[i];
+        }
+
+        s_history_cursor = (s_history_cursor + 1) % c_profile_history;
+        s_history_frames = std::min(s_history_frames + 1, c_profile_history);
+    }
+
+    std::vector<ProfileEvent> Profiler::GetFrameEvents()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        return s_frame_events;
+    }
+
+    std::vector<ProfileZoneStats> Profiler::GetZoneStats()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        std::vector<ProfileZoneStats> stats;
+        if (s_history_frames == 0)
+        {
+            return stats;
+        }
+
+        const u32 last = (s_history_cursor + c_profile_history - 1) % c_profile_history;
+        for (const auto& [name, history] : s_zone_history)
+        {
+            // Frames before the zone first showed up count as 0 ms, like frames without it.
+            ProfileZoneStats zone = {name, history.ms[last], 0.0, history.ms[last],
+                history.ms[last], history.last_calls};
+            for (u32 i = 0; i < s_history_frames; ++i)
+            {
+                const f64 ms = history.ms[(last + c_profile_history - i) % c_profile_history];
+                zone.average_ms += ms;
+                zone.min_ms = std::min(zone.min_ms, ms);
+                zone.max_ms = std::max(zone.max_ms, ms);
+            }
+            zone.average_ms /= s_history_frames;
+            stats.push_back(zone);
+        }
+        std::sort(stats.begin(), stats.end(),
+            [](const ProfileZoneStats& a, const ProfileZoneStats& b) { return a.name < b.name; });
+        return stats;
+    }
+
+    std::vector<ProfileCounterStats> Profiler::GetCounterStats()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        std::vector<ProfileCounterStats> stats;
+        if (s_history_frames == 0)
+        {
+            return stats;
+        }
+
+        const u32 last = (s_history_cursor + c_profile_history - 1) % c_profile_history;
+        for (u32 counter = 0; counter < s_counter_names.size(); ++counter)
+        {
+            f64 sum = 0.0;
+            for (u32 i = 0; i < s_history_frames; ++i)
+            {
+                sum += static_cast<f64>(
+                    s_counter_history[counter][(last + c_profile_history - i) % c_profile_history]);
+            }
+            stats.push_back({s_counter_names[counter], s_counter_history[counter][last],
+                sum / s_history_frames});
+        }
+        return stats;
+    }
+
+    bool Profiler::WriteTrace(const std::string& path)
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            LOG_ERROR("Could not open '%s' for writing", path.c_str());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+        file << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const UniquePtr<ThreadBuffer>& buffer : s_threads)
+        {
+            file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                << "\"tid\":" << buffer->thread << ",\"args\":{\"name\":";
+            WriteJsonString(file, buffer->name.c_str());
+            file << "}}";
+            first = false;
+        }
+        for (const ProfileEvent& event : s_frame_events)
+        {
+            file << (first ? "" : ",\n") << "{\"name\":";
+            WriteJsonString(file, event.name);
+            file << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+                << ",\"ts\":" << event.begin_ns / 1000.0
+                << ",\"dur\":" << (event.end_ns - event.begin_ns) / 1000.0;
+            if (event.index != ~0u)
+            {
+                file << ",\"args\":{\"index\":" << event.index << "}";
+            }
+            file << "}";
+            first = false;
+        }
+        for (u32 counter = 0; counter < s_counter_names.size(); ++counter)
+        {
+            file << (first ? "" : ",\n") << "{\"name\":";
+            WriteJsonString(file, s_counter_names[counter].c_str());
+            file << ",\"ph\":\"C\",\"pid\":0,\"ts\":" << s_frame_end_ns / 1000.0
+                << ",\"args\":{\"value\":" << s_frame_counters[counter] << "}}";
+            first = false;
+        }
+        file << "\n]}\n";
+        return static_cast<bool>(file);
+    }
+
+} // namespace Rasterizer
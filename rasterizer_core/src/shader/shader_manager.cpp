@@ -0,0 +1,212 @@
+#include "shader/shader_manager.hpp"
+#include "log.hpp"
+
+#include <chrono>
+#include <filesystem>
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+namespace Rasterizer
+{
+
+    // Watcher timeout, bounding how long destruction waits for the loader thread.
+    static constexpr u32 c_watch_timeout_ms = 50;
+    // Quiet time after the last change before reloading, so a module still being linked or
+    // copied is not picked up halfway.
+    static constexpr auto c_reload_delay = std::chrono::milliseconds(100);
+
+    static u32 GetProcessId()
+    {
+#ifdef WIN32
+        return static_cast<u32>(GetCurrentProcessId());
+#else
+        return static_cast<u32>(getpid());
+#endif
+    }
+
+    ShaderManager::Version::~Version()
+    {
+        // Windows keeps loaded modules locked.
+        module.reset();
+        std::error_code error;
+        std::filesystem::remove(copy_path, error);
+    }
+
+    ShaderManagerPtr ShaderManager::Create(const std::string& module_path)
+    {
+        namespace fs = std::filesystem;
+        ShaderManagerPtr manager = MakeUnique<ShaderManager>();
+        std::error_code error;
+        const fs::path path = fs::absolute(module_path, error);
+        const fs::path temp = fs::temp_directory_path(error);
+        manager->m_module_path = path.string();
+        manager->m_module_name = path.filename().string();
+        manager->m_copy_prefix = (temp / path.stem()).string() + "." +
+            std::to_string(GetProcessId()) + ".";
+
+        UniquePtr<Version> version = manager->Load();
+        if (!version)
+        {
+            return nullptr;
+        }
+        manager->m_current.store(version.release());
+        manager->m_watcher = DirectoryWatcher::Create(path.parent_path().string());
+        if (!manager->m_watcher)
+        {
+            return nullptr;
+        }
+        manager->m_running.store(true);
+        manager->m_thread = std::thread(&ShaderManager::Run, manager.get());
+        return manager;
+    }
+
+    ShaderManager::~ShaderManager()
+    {
+        m_running.store(false);
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        UniquePtr<Version> current(m_current.load());
+    }
+
+    u32 ShaderManager::RegisterReader()
+    {
+        const u32 reader = m_reader_count.fetch_add(1);
+        if (reader >= c_max_shader_readers)
+        {
+            LOG_ERROR("ShaderManager supports at most %u readers", c_max_shader_readers);
+            return ~0u;
+        }
+        return reader;
+    }
+
+    const ShaderLibrary& ShaderManager::Acquire(u32 reader)
+    {
+        // Announcing the epoch before loading the pointer (both sequentially consistent)
+        // guarantees the loader either sees the announcement or swapped before the load.
+        m_readers[reader].epoch.store(m_epoch.load());
+        return m_current.load()->library;
+    }
+
+    void ShaderManager::Release(u32 reader)
+    {
+        m_readers[reader].epoch.store(0);
+    }
+
+    UniquePtr<ShaderManager::Version> ShaderManager::Load()
+    {
+        // Load a private copy: the original stays writable for the next build, and a new
+        // file name makes the loader map a new module instead of returning the old one.
+        const u64 number = m_next_version++;
+        UniquePtr<Version> version = MakeUnique<Version>();
+        version->copy_path = m_copy_prefix + std::to_string(number) +
+            std::filesystem::path(m_module_path).extension().string();
+        std::error_code error;
+        std::filesystem::copy_file(m_module_path, version->copy_path,
+            std::filesystem::copy_options::overwrite_existing, error);
+        if (error)
+        {
+            LOG_ERROR("Could not copy shader module '%s': %s", m_module_path.c_str(),
+                error.message().c_str());
+            return nullptr;
+        }
+
+        version->module = DynamicLibrary::Open(version->copy_path);
+        if (!version->module)
+        {
+            return nullptr;
+        }
+        const auto get_vertex =
+            version->module->GetFunction<GetVertexShaderAPIFn>("GetVertexShaderAPI");
+        const auto get_fragment =
+            version->module->GetFunction<GetFragmentShaderAPIFn>("GetFragmentShaderAPI");
+        const VertexShaderAPI* vertex = get_vertex ? get_vertex() : nullptr;
+        const FragmentShaderAPI* fragment = get_fragment ? get_fragment() : nullptr;
+        if (!vertex || !fragment)
+        {
+            LOG_ERROR("Shader module '%s' does not export GetVertexShaderAPI and "
+                "GetFragmentShaderAPI", m_module_path.c_str());
+            return nullptr;
+        }
+        // What Pipeline::Configure needs before it can look at the shaders at all; a module
+        // failing here would leave every pipeline unconfigured.
+        if (!vertex->VS_Main || !vertex->reflection || !fragment->reflection ||
+            !(fragment->FS_Main || fragment->FS_MainPacket) ||
+            (fragment->FS_MainPacket && fragment->simd_width != 4 && fragment->simd_width != 8))
+        {
+            LOG_ERROR("Shader module '%s' has missing entry points or reflection",
+                m_module_path.c_str());
+            return nullptr;
+        }
+        version->library = {*vertex, *fragment, number};
+        return version;
+    }
+
+    void ShaderManager::Run()
+    {
+        using Clock = std::chrono::steady_clock;
+        std::vector<std::string> changed;
+        bool pending = false;
+        Clock::time_point last_change {};
+        while (m_running.load(std::memory_order_relaxed))
+        {
+            changed.clear();
+            if (m_watcher->Wait(c_watch_timeout_ms, changed))
+            {
+                for (const std::string& name : changed)
+                {
+                    if (name.empty() || name == m_module_name)
+                    {
+                        pending = true;
+                        last_change = Clock::now();
+                    }
+                }
+            }
+
+            if (pending && Clock::now() - last_change >= c_reload_delay)
+            {
+                // A failed load keeps the current version; the next write retries.
+                pending = false;
+                if (UniquePtr<Version> version = Load())
+                {
+                    const u64 number = version->library.version;
+                    UniquePtr<Version> previous(m_current.exchange(version.release()));
+                    previous->retire_epoch = m_epoch.fetch_add(1) + 1;
+                    m_retired.push_back(std::move(previous));
+                    m_reloads.fetch_add(1, std::memory_order_relaxed);
+                    LOG_INFO("Reloaded shader module '%s' (version %llu)",
+                        m_module_path.c_str(), static_cast<unsigned long long>(number));
+                }
+            }
+            Reclaim();
+        }
+    }
+
+    void ShaderManager::Reclaim()
+    {
+        if (m_retired.empty())
+        {
+            return;
+        }
+        // A version retired in epoch E may still be used by readers that announced an epoch
+        // before E; readers holding nothing announce 0.
+        u64 oldest = ~0ull;
+        const u32 reader_count = std::min(m_reader_count.load(), c_max_shader_readers);
+        for (u32 i = 0; i < reader_count; ++i)
+        {
+            const u64 epoch = m_readers[i].epoch.load();
+            if (epoch != 0)
+            {
+                oldest = std::min(oldest, epoch);
+            }
+        }
+        std::erase_if(m_retired, [oldest](const UniquePtr<Version>& version)
+            {
+                return version->retire_epoch <= oldest;
+            });
+    }
+
+} // namespace Rasterizer
@@ -1,17 +1,229 @@
 #include "rasterizer.hpp"
+#ifdef RASTERIZER_INLINE_SHADERS
+#include "basic_shader.hpp"
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 
 using namespace Rasterizer;
 
-int main()
+// Unit cube with one color per face, 4 vertices and 2 counter-clockwise triangles per face.
+static Mesh CreateCubeMesh()
+{
+    struct Vertex
+    {
+        Vec3 position;
+        Vec3 color;
+    };
+
+    const Vec3 corners[8] = {
+        {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+        {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1},
+    };
+    const u32 faces[6][4] = {
+        {4, 5, 6, 7}, {1, 0, 3, 2}, {5, 1, 2, 6}, {0, 4, 7, 3}, {7, 6, 2, 3}, {0, 1, 5, 4},
+    };
+    const Vec3 colors[6] = {
+        {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0}, {1, 0, 1}, {0, 1, 1},
+    };
+
+    Mesh mesh;
+    mesh.vertices.layout.stride = sizeof(Vertex);
+    mesh.vertices.layout.attributes = {
+        {"POSITION", Format::Vec3, offsetof(Vertex, position)},
+        {"COLOR", Format::Vec3, offsetof(Vertex, color)},
+    };
+
+    std::vector<Vertex> vertices;
+    for (u32 face = 0; face < 6; ++face)
+    {
+        const u32 base = static_cast<u32>(vertices.size());
+        for (u32 corner = 0; corner < 4; ++corner)
+        {
+            vertices.push_back({corners[faces[face][corner]], colors[face]});
+        }
+        mesh.indices.indices.insert(mesh.indices.indices.end(),
+            {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+
+    mesh.vertices.vertex_count = vertices.size();
+    mesh.vertices.data.resize(vertices.size() * sizeof(Vertex));
+    std::memcpy(mesh.vertices.data.data(), vertices.data(), mesh.vertices.data.size());
+    return mesh;
+}
+
+struct PresentContext
 {
+    IWindow* window;
+    const Pipeline* pipeline;
+};
 
-    WindowPtr window = IWindow::Create("Rasterizer", 800, 600);
+// Presents only the regions the pipeline redrew differently from the previous frame.
+static void PresentJob(void* data, u32, u32)
+{
+    const PresentContext& context = *static_cast<const PresentContext*>(data);
+    context.window->Draw(context.pipeline->GetDamage());
+}
 
+static void PrintProfile()
+{
+    for (const ProfileZoneStats& zone : Profiler::GetZoneStats())
+    {
+        LOG_INFO("%-20s avg %7.3f ms  min %7.3f  max %7.3f  (%u calls last frame)",
+            zone.name.c_str(), zone.average_ms, zone.min_ms, zone.max_ms, zone.last_calls);
+    }
+    for (const ProfileCounterStats& counter : Profiler::GetCounterStats())
+    {
+        LOG_INFO("%-20s avg %12.1f  last %llu", counter.name.c_str(), counter.average,
+            static_cast<unsigned long long>(counter.last));
+    }
+}
+
+// Usage: runtime [--headless <frame count> [dump pattern, e.g. frame_%04u.png]]
+//                [--profile <trace.json>] [--shader-module <path>]
+// The shader module is reloaded whenever it is rebuilt while the runtime is running, unless
+// the shaders are compiled in (RASTERIZER_INLINE_SHADERS).
+int main(int argc, char** argv)
+{
+    HeadlessDesc headless;
+    bool run_headless = false;
+    const char* trace_path = nullptr;
+    const char* module_path = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+        {
+            run_headless = true;
+            headless.frame_count = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                headless.dump_path = argv[++i];
+                const size_t length = headless.dump_path.size();
+                const bool raw = length >= 4 &&
+                    headless.dump_path.compare(length - 4, 4, ".raw") == 0;
+                headless.dump_format = raw ? ImageFormat::Raw : ImageFormat::PNG;
+            }
+        }
+        else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+        {
+            trace_path = argv[++i];
+            Profiler::SetEnabled(true);
+        }
+        else if (std::strcmp(argv[i], "--shader-module") == 0 && i + 1 < argc)
+        {
+            module_path = argv[++i];
+        }
+    }
+
+    WindowPtr window = run_headless ?
+        IWindow::CreateHeadless("Rasterizer", 800, 600, headless) :
+        IWindow::Create("Rasterizer", 800, 600, {3, PresentMode::Mailbox});
+
+    // The pipeline renders straight into the window's surface, presenting needs no copy.
+    const Surface surface = window->GetSurface();
+    const u32 width = surface.width;
+    const u32 height = surface.height;
+    RenderTarget target(surface.pixels, width, height, surface.pitch);
+    DepthTarget depth(width, height);
+
+#ifdef RASTERIZER_INLINE_SHADERS
+    if (module_path)
+    {
+        LOG_WARNING("Ignoring --shader-module, the shaders are compiled in");
+    }
+    JobSystemPtr jobs = JobSystem::Create();
+    Pipeline pipeline(jobs);
+    if (!pipeline.Configure(BasicShader::c_vertex_api, BasicShader::c_fragment_api, {&target},
+        &depth, {}, &SelectInlineRasterizer<BasicShader::FragmentShader>))
+    {
+        return 1;
+    }
+    UniformBuffer uniforms(pipeline.GetUniformLayout().GetSize());
+    UniformSlot mvp_slot = pipeline.GetUniformLayout().Find("MVP");
+#else
+    ShaderManagerPtr shaders = ShaderManager::Create(module_path ? module_path :
+        SHADER_MODULE_PATH);
+    if (!shaders)
+    {
+        return 1;
+    }
+    const u32 shader_reader = shaders->RegisterReader();
+
+    JobSystemPtr jobs = JobSystem::Create();
+    Pipeline pipeline(jobs);
+    u64 shader_version = ~0ull;
+    UniformBuffer uniforms(0);
+    UniformSlot mvp_slot;
+#endif
+
+    // Only the tiles the cube covers now or covered in the frame the back buffer holds are
+    // cleared and drawn; the background is kept.
+    IncrementalDesc incremental;
+    incremental.clear_color = 0xFF202020;
+    pipeline.SetIncremental(&incremental);
+    PresentContext present = {window.get(), &pipeline};
+
+    const Mesh cube = CreateCubeMesh();
+    const Mat4 projection = Mat4::Perspective(c_pi / 3.0f,
+        static_cast<f32>(width) / static_cast<f32>(height), 0.1f, 100.0f);
+
+    const auto start = std::chrono::steady_clock::now();
+    u32 frame = 0;
     while (window->IsOpen())
     {
         window->PollEvents();
-        window->Draw();
+        // Render into whichever swapchain buffer is current; the previous one may still be
+        // on its way to the screen.
+        const Surface back_buffer = window->GetSurface();
+        target.SetData(back_buffer.pixels);
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const f32 time = std::chrono::duration<f32>(elapsed).count();
+        const Mat4 model = Mat4::RotationY(time) * Mat4::RotationX(time * 0.5f);
+
+#ifndef RASTERIZER_INLINE_SHADERS
+        // Keeps the module loaded until Flush(), a reload meanwhile only takes effect next frame.
+        const ShaderLibrary& library = shaders->Acquire(shader_reader);
+        if (library.version != shader_version)
+        {
+            shader_version = library.version;
+            // A reloaded module may reuse the addresses of the old reflection.
+            pipeline.InvalidateInputLayouts();
+            pipeline.Configure(library.vertex, library.fragment, {&target}, &depth);
+            // The reloaded shaders may have moved or grown their uniforms.
+            uniforms = UniformBuffer(pipeline.GetUniformLayout().GetSize());
+            mvp_slot = pipeline.GetUniformLayout().Find("MVP");
+        }
+#endif
+        uniforms.Set(mvp_slot, projection * Mat4::Translation({0.0f, 0.0f, -5.0f}) * model);
+
+        pipeline.DrawMesh(cube, uniforms);
+        pipeline.Submit(back_buffer.age);
+
+        // Present is just another job, released once every tile of the frame is done.
+        JobCounter presented(1);
+        jobs->RunAfter(pipeline.GetCompletion(), {&PresentJob, &present, 0, "present",
+            &presented});
+        jobs->Wait(presented);
+        pipeline.Flush();
+#ifndef RASTERIZER_INLINE_SHADERS
+        shaders->Release(shader_reader);
+#endif
+
+        Profiler::EndFrame();
+        if (trace_path && ++frame % c_profile_history == 0)
+        {
+            PrintProfile();
+        }
     }
 
+    if (trace_path)
+    {
+        PrintProfile();
+        Profiler::WriteTrace(trace_path);
+    }
     return 0;
 }
@@ -0,0 +1,147 @@
+#pragma once
+#include "shader/shader_api.hpp"
+#include "math/math.hpp"
+
+#include <cstddef>
+
+/*
+ * Basic vertex-colored shader pair: POSITION/COLOR in, MVP uniform, color out. Header-only so
+ * a host can compile it in and hand BasicShader::FragmentShader to SelectInlineRasterizer;
+ * the shader module exports the same shaders for hot-reloading.
+ */
+
+namespace Rasterizer
+{
+    namespace BasicShader
+    {
+
+        struct Uniforms
+        {
+            Mat4 mvp;
+        };
+
+        struct VertexInput
+        {
+            Vec3 position;
+            Vec3 color;
+        };
+
+        struct VertexOutput
+        {
+            Vec4 position;
+            Vec3 color;
+        };
+
+        struct FragmentInput
+        {
+            Vec3 color;
+        };
+
+        struct FragmentOutput
+        {
+            Vec4 color;
+        };
+
+        inline constexpr ShaderParam c_uniforms[] = {
+            {"MVP", Format::Mat4, offsetof(Uniforms, mvp)},
+        };
+
+        inline constexpr ShaderParam c_vs_inputs[] = {
+            {"POSITION", Format::Vec3, offsetof(VertexInput, position)},
+            {"COLOR", Format::Vec3, offsetof(VertexInput, color)},
+        };
+
+        inline constexpr ShaderParam c_vs_outputs[] = {
+            {"posClip", Format::Vec4, offsetof(VertexOutput, position)},
+            {"color", Format::Vec3, offsetof(VertexOutput, color)},
+        };
+
+        inline constexpr ShaderParam c_fs_inputs[] = {
+            {"color", Format::Vec3, offsetof(FragmentInput, color)},
+        };
+
+        inline constexpr ShaderParam c_fs_outputs[] = {
+            {"outColor0", Format::Vec4, offsetof(FragmentOutput, color)},
+        };
+
+        inline constexpr ShaderReflection c_vs_reflection = {
+            c_vs_inputs, 2, sizeof(VertexInput),
+            c_vs_outputs, 2, sizeof(VertexOutput),
+            c_uniforms, 1, sizeof(Uniforms),
+        };
+
+        inline constexpr ShaderReflection c_fs_reflection = {
+            c_fs_inputs, 1, sizeof(FragmentInput),
+            c_fs_outputs, 1, sizeof(FragmentOutput),
+            nullptr, 0, 0,
+        };
+
+        inline void ShadeVertex(const VertexInput& in, const Uniforms& u, VertexOutput& out)
+        {
+            out.position = u.mvp * Vec4 {in.position.x, in.position.y, in.position.z, 1.0f};
+            out.color = in.color;
+        }
+
+        inline void VS_Main(const void* vertex_input, void* vertex_output, const void* uniforms)
+        {
+            ShadeVertex(*static_cast<const VertexInput*>(vertex_input),
+                *static_cast<const Uniforms*>(uniforms),
+                *static_cast<VertexOutput*>(vertex_output));
+        }
+
+        inline void VS_MainBatch(const void* vertex_inputs, u32 input_stride, u32 count,
+            void* vertex_outputs, const void* uniforms)
+        {
+            const u8* in = static_cast<const u8*>(vertex_inputs);
+            VertexOutput* out = static_cast<VertexOutput*>(vertex_outputs);
+            const Uniforms& u = *static_cast<const Uniforms*>(uniforms);
+
+            for (u32 i = 0; i < count; ++i)
+            {
+                ShadeVertex(*reinterpret_cast<const VertexInput*>(in + i * input_stride), u,
+                    out[i]);
+            }
+        }
+
+        inline void FS_Main(const void* fragment_input, void* fragment_output, const void*)
+        {
+            const FragmentInput& in = *static_cast<const FragmentInput*>(fragment_input);
+            FragmentOutput& out = *static_cast<FragmentOutput*>(fragment_output);
+
+            out.color = {in.color.x, in.color.y, in.color.z, 1.0f};
+        }
+
+        /**
+         * @brief The packet entry point, as a type for InlineFragmentStage.
+         */
+        struct FragmentShader
+        {
+            static constexpr u32 simd_width = SHADER_SIMD_WIDTH;
+
+            static void FS_MainPacket(const f32* fragment_inputs, f32* fragment_outputs, u32,
+                const void*)
+            {
+                constexpr u32 lanes = simd_width;
+                const f32* color = fragment_inputs +
+                    offsetof(FragmentInput, color) / sizeof(f32) * lanes;
+                f32* out = fragment_outputs + offsetof(FragmentOutput, color) / sizeof(f32) * lanes;
+
+                for (u32 i = 0; i < 3 * lanes; ++i)
+                {
+                    out[i] = color[i];
+                }
+                for (u32 lane = 0; lane < lanes; ++lane)
+                {
+                    out[3 * lanes + lane] = 1.0f;
+                }
+            }
+        };
+
+        inline constexpr VertexShaderAPI c_vertex_api = {VS_Main, &c_vs_reflection,
+            VS_MainBatch};
+        inline constexpr FragmentShaderAPI c_fragment_api = {FS_Main, &c_fs_reflection,
+            FragmentShader::FS_MainPacket, SHADER_SIMD_WIDTH};
+
+    } // namespace BasicShader
+
+} // namespace Rasterizer
@@ -1,3 +1,8 @@
 #pragma once
+#include "shader/shader_api.hpp"
 
-extern "C" __declspec(dllexport) void helloShader();
+SHADER_EXPORT void helloShader();
+
+// Basic vertex-colored shader pair: POSITION/COLOR in, MVP uniform, color out.
+SHADER_EXPORT const Rasterizer::VertexShaderAPI* GetVertexShaderAPI();
+SHADER_EXPORT const Rasterizer::FragmentShaderAPI* GetFragmentShaderAPI();
@@ -0,0 +1,14 @@
+#include "shader_module.hpp"
+#include "basic_shader.hpp"
+
+using namespace Rasterizer;
+
+SHADER_EXPORT const VertexShaderAPI* GetVertexShaderAPI()
+{
+    return &BasicShader::c_vertex_api;
+}
+
+SHADER_EXPORT const FragmentShaderAPI* GetFragmentShaderAPI()
+{
+    return &BasicShader::c_fragment_api;
+}
@@ -1,5 +1,7 @@
+#include "shader_module.hpp"
+
 #include <iostream>
 
-extern "C" __declspec(dllexport) void helloShader() {
+SHADER_EXPORT void helloShader() {
     std::cout << "Hello Shader!" << std::endl;
 }
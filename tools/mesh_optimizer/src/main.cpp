@@ -0,0 +1,119 @@
+#include "obj_loader.hpp"
+#include "mesh/mesh_file.hpp"
+#include "mesh/mesh_optimizer.hpp"
+#include "log.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Rasterizer;
+
+// Matches the pipeline's vertex shader batch: vertices are shaded once per batch of triangles.
+constexpr u32 c_batch_triangles = 128;
+
+// Vertices the pipeline shades per triangle when it dedupes within each batch.
+static f64 VerticesShadedPerTriangle(const Mesh& mesh)
+{
+    const u32* indices = mesh.indices.GetData();
+    const u32 triangle_count = mesh.GetTriangleCount();
+    std::vector<u32> marker(mesh.vertices.vertex_count, ~0u);
+    u64 shaded = 0;
+    for (u32 t = 0; t < triangle_count; ++t)
+    {
+        const u32 batch = t / c_batch_triangles;
+        for (u32 c = 0; c < 3; ++c)
+        {
+            const u32 index = indices[t * 3 + c];
+            if (index < marker.size() && marker[index] != batch)
+            {
+                marker[index] = batch;
+                ++shaded;
+            }
+        }
+    }
+    return triangle_count ? static_cast<f64>(shaded) / triangle_count : 0.0;
+}
+
+static bool EndsWith(const std::string& text, const char* suffix)
+{
+    const size_t length = std::strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+// Usage: mesh_optimizer <input.obj|input.rmesh> <output.rmesh> [--meshlet-vertices <n>]
+//        [--meshlet-triangles <n>] [--no-cache-opt] [--soa]
+int main(int argc, char** argv)
+{
+    std::vector<std::string> paths;
+    u32 meshlet_vertices = c_meshlet_max_vertices;
+    u32 meshlet_triangles = c_meshlet_max_triangles;
+    bool optimize_cache = true;
+    bool deinterleave = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        auto next_u32 = [&]() { return static_cast<u32>(std::strtoul(argv[++i], nullptr, 10)); };
+        if (std::strcmp(argv[i], "--meshlet-vertices") == 0 && i + 1 < argc)
+        {
+            meshlet_vertices = next_u32();
+        }
+        else if (std::strcmp(argv[i], "--meshlet-triangles") == 0 && i + 1 < argc)
+        {
+            meshlet_triangles = next_u32();
+        }
+        else if (std::strcmp(argv[i], "--no-cache-opt") == 0)
+        {
+            optimize_cache = false;
+        }
+        else if (std::strcmp(argv[i], "--soa") == 0)
+        {
+            deinterleave = true;
+        }
+        else if (argv[i][0] != '-')
+        {
+            paths.push_back(argv[i]);
+        }
+        else
+        {
+            LOG_ERROR("Unknown argument '%s'", argv[i]);
+            return 2;
+        }
+    }
+    if (paths.size() != 2)
+    {
+        LOG_ERROR("Usage: mesh_optimizer <input.obj|input.rmesh> <output.rmesh> "
+            "[--meshlet-vertices <n>] [--meshlet-triangles <n>] [--no-cache-opt] [--soa]");
+        return 2;
+    }
+
+    Mesh mesh;
+    const bool loaded = EndsWith(paths[0], ".rmesh") ? LoadMeshFile(paths[0], mesh) :
+        LoadObjMesh(paths[0], mesh);
+    if (!loaded)
+    {
+        return 2;
+    }
+    LOG_INFO("%s: %zu vertices, %u triangles, %.3f vertices shaded per triangle",
+        paths[0].c_str(), mesh.vertices.vertex_count, mesh.GetTriangleCount(),
+        VerticesShadedPerTriangle(mesh));
+
+    if (optimize_cache)
+    {
+        // Copies out of the mapping first when the input is a mesh file.
+        OptimizeVertexFetch(mesh);
+        OptimizeVertexCache(mesh.indices.indices, mesh.vertices.vertex_count);
+        OptimizeVertexFetch(mesh);
+    }
+    if (deinterleave)
+    {
+        mesh.vertices = DeinterleaveVertices(mesh.vertices);
+    }
+    if (!BuildMeshlets(mesh, meshlet_vertices, meshlet_triangles) ||
+        !SaveMeshFile(paths[1], mesh))
+    {
+        return 2;
+    }
+    LOG_INFO("%s: %zu vertices, %u triangles, %.3f vertices shaded per triangle, %zu meshlets",
+        paths[1].c_str(), mesh.vertices.vertex_count, mesh.GetTriangleCount(),
+        VerticesShadedPerTriangle(mesh), mesh.meshlets.size());
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "obj_loader.hpp"
+#include "log.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+using namespace Rasterizer;
+
+// Zero-based position/texcoord/normal indices of one face corner, -1 when absent.
+struct ObjCorner
+{
+    i64 position;
+    i64 texcoord;
+    i64 normal;
+
+    bool operator==(const ObjCorner& other) const
+    {
+        return position == other.position && texcoord == other.texcoord &&
+            normal == other.normal;
+    }
+};
+
+struct ObjCornerHash
+{
+    size_t operator()(const ObjCorner& corner) const
+    {
+        u64 hash = static_cast<u64>(corner.position) * 0x9E3779B97F4A7C15ull;
+        hash ^= static_cast<u64>(corner.texcoord) + 0x9E3779B97F4A7C15ull + (hash << 6);
+        hash ^= static_cast<u64>(corner.normal) + 0x9E3779B97F4A7C15ull + (hash << 6);
+        return static_cast<size_t>(hash);
+    }
+};
+
+// Resolves a one-based (or negative, relative to the end) OBJ index; -1 if out of range.
+static i64 ResolveIndex(const char* text, size_t count)
+{
+    const i64 index = std::strtoll(text, nullptr, 10);
+    const i64 resolved = index < 0 ? static_cast<i64>(count) + index : index - 1;
+    return resolved >= 0 && resolved < static_cast<i64>(count) ? resolved : -1;
+}
+
+bool LoadObjMesh(const std::string& path, Mesh& mesh)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        LOG_ERROR("Could not open '%s'", path.c_str());
+        return false;
+    }
+
+    std::vector<Vec3> positions;
+    std::vector<Vec2> texcoords;
+    std::vector<Vec3> normals;
+    std::vector<ObjCorner> corners;
+    std::vector<ObjCorner> face;
+    std::string line;
+    for (u32 line_number = 1; std::getline(file, line); ++line_number)
+    {
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+        if (keyword == "v")
+        {
+            Vec3 p = {};
+            stream >> p.x >> p.y >> p.z;
+            positions.push_back(p);
+        }
+        else if (keyword == "vt")
+        {
+            Vec2 t = {};
+            stream >> t.x >> t.y;
+            texcoords.push_back(t);
+        }
+        else if (keyword == "vn")
+        {
+            Vec3 n = {};
+            stream >> n.x >> n.y >> n.z;
+            normals.push_back(n);
+        }
+        else if (keyword == "f")
+        {
+            face.clear();
+            std::string token;
+            while (stream >> token)
+            {
+                // v, v/vt, v//vn or v/vt/vn
+                ObjCorner corner = {ResolveIndex(token.c_str(), positions.size()), -1, -1};
+                const size_t first_slash = token.find('/');
+                if (first_slash != std::string::npos)
+                {
+                    const size_t second_slash = token.find('/', first_slash + 1);
+                    if (second_slash != first_slash + 1)
+                    {
+                        corner.texcoord = ResolveIndex(token.c_str() + first_slash + 1,
+                            texcoords.size());
+                    }
+                    if (second_slash != std::string::npos)
+                    {
+                        corner.normal = ResolveIndex(token.c_str() + second_slash + 1,
+                            normals.size());
+                    }
+                }
+                if (corner.position < 0)
+                {
+                    LOG_ERROR("%s:%u: face refers to a missing vertex", path.c_str(),
+                        line_number);
+                    return false;
+                }
+                face.push_back(corner);
+            }
+            for (size_t i = 2; i < face.size(); ++i)
+            {
+                corners.push_back(face[0]);
+                corners.push_back(face[i - 1]);
+                corners.push_back(face[i]);
+            }
+        }
+    }
+    if (corners.empty())
+    {
+        LOG_ERROR("'%s' has no faces", path.c_str());
+        return false;
+    }
+
+    bool has_texcoords = !texcoords.empty();
+    bool has_normals = !normals.empty();
+    for (const ObjCorner& corner : corners)
+    {
+        has_texcoords = has_texcoords && corner.texcoord >= 0;
+        has_normals = has_normals && corner.normal >= 0;
+    }
+
+    Mesh loaded;
+    VertexLayout& layout = loaded.vertices.layout;
+    layout.attributes.push_back({"POSITION", Format::Vec3, 0});
+    layout.stride = sizeof(Vec3);
+    if (has_normals)
+    {
+        layout.attributes.push_back({"NORMAL", Format::Vec3, layout.stride});
+        layout.stride += sizeof(Vec3);
+    }
+    if (has_texcoords)
+    {
+        layout.attributes.push_back({"TEXCOORD", Format::Vec2, layout.stride});
+        layout.stride += sizeof(Vec2);
+    }
+
+    std::unordered_map<ObjCorner, u32, ObjCornerHash> vertex_ids;
+    std::vector<u8>& data = loaded.vertices.data;
+    loaded.indices.indices.reserve(corners.size());
+    for (ObjCorner corner : corners)
+    {
+        corner.texcoord = has_texcoords ? corner.texcoord : -1;
+        corner.normal = has_normals ? corner.normal : -1;
+        const auto [it, inserted] =
+            vertex_ids.try_emplace(corner, static_cast<u32>(vertex_ids.size()));
+        if (inserted)
+        {
+            const size_t offset = data.size();
+            data.resize(offset + layout.stride);
+            std::memcpy(data.data() + offset, &positions[corner.position], sizeof(Vec3));
+            if (has_normals)
+            {
+                std::memcpy(data.data() + offset + layout.attributes[1].offset,
+                    &normals[corner.normal], sizeof(Vec3));
+            }
+            if (has_texcoords)
+            {
+                std::memcpy(data.data() + offset + layout.attributes.back().offset,
+                    &texcoords[corner.texcoord], sizeof(Vec2));
+            }
+        }
+        loaded.indices.indices.push_back(it->second);
+    }
+    loaded.vertices.vertex_count = vertex_ids.size();
+    mesh = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "mesh/mesh.hpp"
+
+/**
+ * @brief Loads the triangles of a Wavefront OBJ file into an indexed mesh. Polygons are fan
+ * triangulated and identical position/texcoord/normal corners share one vertex. The layout is
+ * POSITION (Vec3), plus NORMAL (Vec3) and TEXCOORD (Vec2) when the file has them.
+ * @return false (with an error logged) if the file is missing or malformed.
+ */
+bool LoadObjMesh(const std::string& path, Rasterizer::Mesh& mesh);